@@ -0,0 +1,201 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <Arduino.h>
+#include "sample_ring.h"
+
+/*
+ * Timer-driven pulse sensor acquisition
+ * =====================================
+ * Hardware timer1 fires at a fixed rate and the ISR reads the ADC straight
+ * into the lock-free sample ring. loop() drains the ring in batches, so the
+ * sample spacing no longer depends on how long the web server or MQTT
+ * client held the CPU.
+ *
+ * Oversampling: with HR_OVERSAMPLE = R > 1 the ADC is read R times per
+ * output sample and a 3-stage CIC decimator in the ISR reduces it back to
+ * the processing rate. Integrators run on every read, combs once per
+ * output, so the ISR stays a handful of adds. The CIC has nulls at every
+ * multiple of the output rate (50 Hz mains included) and adds ~1.5 bits of
+ * resolution. Ring values are always in ADC x 8 units (13 bits), with or
+ * without oversampling.
+ *
+ * It is off by default. Each read is a SAR conversion taken with
+ * interrupts blocked and a call into flash (below), and frequent ADC reads
+ * disturb the WiFi radio; at R = 8 that is 400 a second. Check the ISR
+ * cost on the device in /metrics (hr_isr_cycles_max, cycles at 80 MHz)
+ * before turning it on.
+ *
+ * Flash: the timer keeps firing while SPI flash is being erased or written,
+ * and then the flash cache is off and any code run from flash crashes the
+ * chip. Everything the ISR calls is in IRAM (the ring push is forced inline)
+ * except analogRead(), whose SDK ADC routine lives in flash and has no
+ * IRAM-safe equivalent. So the firmware's own flash work (the LittleFS
+ * telemetry log) runs between acquisitionPause() and acquisitionResume(),
+ * which stop timer1 and pick the tick count back up from the clock; the
+ * samples in between are lost and show up as a tick gap. WiFi runs with
+ * persistent(false) and the WiFi cache lives in RTC memory, so the SDK has
+ * no flash writes of its own to make while sampling.
+ */
+
+#ifndef HR_OVERSAMPLE
+#define HR_OVERSAMPLE 1            // ADC reads per output sample (power of two, 1 = off)
+#endif
+
+#if HR_OVERSAMPLE < 1 || (HR_OVERSAMPLE & (HR_OVERSAMPLE - 1)) != 0
+#error "HR_OVERSAMPLE must be a power of two"
+#endif
+
+const int acqSampleFractionBits = 3;  // Ring values are ADC << 3
+
+constexpr int acqLog2(uint32_t v) {
+  return v <= 1 ? 0 : 1 + acqLog2(v >> 1);
+}
+
+// CIC gain is R^3; drop all but acqSampleFractionBits of it
+const int acqCicShift = 3 * acqLog2(HR_OVERSAMPLE) - acqSampleFractionBits;
+
+// timer1 runs from the 80 MHz APB clock; TIM_DIV16 gives 5 ticks per us
+const uint32_t acqTimerTicksPerUs = 5;
+
+SampleRing acqRing;
+uint32_t acqReadIntervalUs = 0;           // ADC read period set by acquisitionBegin()
+uint32_t acqTickZeroUs = 0;               // micros() instant output tick 0 stands for
+
+// ISR instrumentation (read from loop(), written from the ISR)
+volatile uint32_t acqTick = 0;            // Output samples produced
+volatile uint32_t acqReads = 0;           // ADC reads (timer interrupts taken)
+volatile uint32_t acqIsrCyclesLast = 0;   // CPU cycles spent in the last ISR
+volatile uint32_t acqIsrCyclesMax = 0;    // Worst-case ISR cost seen
+volatile uint32_t acqIsrCyclesTotal = 0;  // Sum of ISR cycles (wraps)
+
+uint8_t acqPin = A0;
+
+// Pauses for flash work (acquisitionPause())
+uint8_t acqPauseDepth = 0;
+uint32_t acqPausedAtUs = 0;
+uint32_t acqPauses = 0;
+uint32_t acqPausedUsMax = 0;              // Longest pause seen
+
+// CIC decimator state (ISR only). Wrapping int32 arithmetic is exact for CIC.
+int32_t cicIntegrator[3];
+int32_t cicCombDelay[3];
+uint32_t cicPhase = 0;
+uint32_t cicWarmup = 0;                   // Outputs discarded while the combs fill
+
+/**
+ * Reset the CIC state; called before the timer starts
+ */
+void cicReset() {
+  for (int i = 0; i < 3; i++) {
+    cicIntegrator[i] = 0;
+    cicCombDelay[i] = 0;
+  }
+  cicPhase = 0;
+  cicWarmup = 0;
+}
+
+/**
+ * Timer1 ISR: one ADC read per tick. Every HR_OVERSAMPLE reads one
+ * decimated sample is pushed into the ring. In IRAM; analogRead() is the
+ * one call into flash (see the header).
+ */
+void IRAM_ATTR onSampleTimer() {
+  uint32_t start = ESP.getCycleCount();
+  int32_t raw = analogRead(acqPin);
+  acqReads = acqReads + 1;
+
+#if HR_OVERSAMPLE > 1
+  cicIntegrator[0] += raw;
+  cicIntegrator[1] += cicIntegrator[0];
+  cicIntegrator[2] += cicIntegrator[1];
+  if (++cicPhase == HR_OVERSAMPLE) {
+    cicPhase = 0;
+    int32_t v = cicIntegrator[2];
+    for (int i = 0; i < 3; i++) {
+      int32_t delayed = cicCombDelay[i];
+      cicCombDelay[i] = v;
+      v -= delayed;
+    }
+    if (cicWarmup < 2) {
+      cicWarmup++;            // First outputs only see part of the impulse response
+    } else {
+      uint32_t tick = acqTick;
+      sampleRingPush(acqRing, tick, (uint16_t)(v >> acqCicShift));
+      acqTick = tick + 1;
+    }
+  }
+#else
+  uint32_t tick = acqTick;
+  sampleRingPush(acqRing, tick, (uint16_t)(raw << acqSampleFractionBits));
+  acqTick = tick + 1;
+#endif
+
+  uint32_t cycles = ESP.getCycleCount() - start;
+  acqIsrCyclesLast = cycles;
+  acqIsrCyclesTotal = acqIsrCyclesTotal + cycles;
+  if (cycles > acqIsrCyclesMax) acqIsrCyclesMax = cycles;
+}
+
+/**
+ * Time from starting the timer to the instant the first kept output stands
+ * for: it comes out of the ADC read that completes the CIC warm-up, and the
+ * filter centres it (R-1)*3/2 reads earlier
+ */
+uint32_t acqFirstOutputUs() {
+  uint32_t firstRead = HR_OVERSAMPLE > 1 ? 3 * HR_OVERSAMPLE : 1;
+  return firstRead * acqReadIntervalUs - 3 * (HR_OVERSAMPLE - 1) * acqReadIntervalUs / 2;
+}
+
+/**
+ * Start fixed-rate sampling of the given analog pin
+ * @param pin Analog input to sample
+ * @param intervalMs Output sample period in milliseconds; the ADC itself is
+ *                   read HR_OVERSAMPLE times per period
+ */
+void acquisitionBegin(uint8_t pin, uint32_t intervalMs) {
+  acqPin = pin;
+  acqReadIntervalUs = intervalMs * 1000 / HR_OVERSAMPLE;
+  cicReset();
+  timer1_isr_init();
+  timer1_attachInterrupt(onSampleTimer);
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+  timer1_write(acqTimerTicksPerUs * acqReadIntervalUs);
+
+  acqTickZeroUs = micros() + acqFirstOutputUs();
+}
+
+/**
+ * Stop sampling before touching flash (see the header). Nests.
+ */
+void acquisitionPause() {
+  if (acqPauseDepth++) return;
+  timer1_disable();
+  acqPausedAtUs = micros();
+}
+
+/**
+ * Restart sampling after acquisitionPause(). The decimator starts over and
+ * the next sample gets the tick of the instant it stands for, so sample
+ * times stay on the original grid (to within half a period) and the
+ * samples missed meanwhile are a gap in the ticks. The tick is found by
+ * how far that instant is past the grid time of the current tick: a short
+ * difference of wrapping 32-bit us values, so it holds across the
+ * micros() wrap (~71.6 min).
+ */
+void acquisitionResume() {
+  if (acqPauseDepth == 0 || --acqPauseDepth) return;
+  uint32_t now = micros();
+  uint32_t paused = now - acqPausedAtUs;
+  acqPauses++;
+  if (paused > acqPausedUsMax) acqPausedUsMax = paused;
+
+  uint32_t outputUs = acqReadIntervalUs * HR_OVERSAMPLE;
+  int32_t ahead = (int32_t)(now + acqFirstOutputUs() - (acqTickZeroUs + acqTick * outputUs));
+  cicReset();
+  if (ahead > (int32_t)(outputUs / 2)) acqTick = acqTick + ((uint32_t)ahead + outputUs / 2) / outputUs;
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+  timer1_write(acqTimerTicksPerUs * acqReadIntervalUs);
+}
+
+#endif // ACQUISITION_H
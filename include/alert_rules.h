@@ -0,0 +1,155 @@
+#ifndef ALERT_RULES_H
+#define ALERT_RULES_H
+
+#include <Arduino.h>
+#include "heart_rate.h"
+#include "telegram_notify.h"
+
+/*
+ * Heart rate alert rules
+ * ======================
+ * Each rule watches one condition and reports transitions, not states:
+ * "raised" once the condition has held for ALERT_HOLD_MS, "cleared" once it
+ * has been false for ALERT_HOLD_MS. A rule that clears cannot raise again
+ * for ALERT_COOLDOWN_MS, so a flapping signal produces one alert and one
+ * all-clear instead of a stream of both. Messages are queued on the
+ * Telegram notifier, which also merges alerts raised together.
+ */
+
+#ifndef ALERT_BPM_HIGH
+#define ALERT_BPM_HIGH 120
+#endif
+
+#ifndef ALERT_BPM_LOW
+#define ALERT_BPM_LOW 45
+#endif
+
+#ifndef ALERT_NO_BEAT_SECONDS
+#define ALERT_NO_BEAT_SECONDS 10
+#endif
+
+#ifndef ALERT_HOLD_MS
+#define ALERT_HOLD_MS 5000
+#endif
+
+#ifndef ALERT_COOLDOWN_MS
+#define ALERT_COOLDOWN_MS 60000
+#endif
+
+const unsigned long alertCheckIntervalMs = 250;   // Period of the alerts task
+const int alertClipMargin = 4;          // ADC counts from either rail that count as clipped
+
+struct AlertRule {
+  const char* name;
+  bool active;                   // Raised and not yet cleared
+  bool condition;                // Last evaluated condition
+  unsigned long changedMs;       // When condition last flipped
+  unsigned long clearedMs;       // When the rule last cleared
+  uint32_t raised;               // Times raised since boot
+};
+
+enum AlertEvent {
+  ALERT_NONE,
+  ALERT_RAISED,
+  ALERT_CLEARED
+};
+
+AlertRule alertBpmHigh = {"bpm-high", false, false, 0, 0, 0};
+AlertRule alertBpmLow = {"bpm-low", false, false, 0, 0, 0};
+AlertRule alertNoBeat = {"no-beat", false, false, 0, 0, 0};
+AlertRule alertSignalLost = {"signal-lost", false, false, 0, 0, 0};
+
+// Sample tick of the last beat (0 = sampling start), updated when beatCount moves
+uint32_t alertBeatCount = 0;
+uint32_t alertBeatTick = 0;
+
+/**
+ * Feed a rule its current condition; debounces and applies the cooldown
+ */
+AlertEvent alertUpdate(AlertRule& rule, bool condition, unsigned long now) {
+  if (condition != rule.condition) {
+    rule.condition = condition;
+    rule.changedMs = now;
+  }
+  if (now - rule.changedMs < ALERT_HOLD_MS) return ALERT_NONE;
+
+  if (condition && !rule.active) {
+    if (rule.raised > 0 && now - rule.clearedMs < ALERT_COOLDOWN_MS) return ALERT_NONE;
+    rule.active = true;
+    rule.raised++;
+    return ALERT_RAISED;
+  }
+  if (!condition && rule.active) {
+    rule.active = false;
+    rule.clearedMs = now;
+    return ALERT_CLEARED;
+  }
+  return ALERT_NONE;
+}
+
+/**
+ * Queue a message for a rule transition
+ * @param detail What was measured, shown when the rule is raised
+ */
+void alertNotify(const AlertRule& rule, AlertEvent event, const char* detail) {
+  char text[96];
+  if (event == ALERT_RAISED) {
+    snprintf(text, sizeof(text), "⚠️ %s: %s", rule.name, detail);
+  } else {
+    snprintf(text, sizeof(text), "✅ %s cleared (%d BPM)", rule.name, beatsPerMinute);
+  }
+  Serial.print("[Alert] ");
+  Serial.println(text);
+  telegramEnqueue(text);
+}
+
+/**
+ * Evaluate every rule against the detector state. Run every
+ * alertCheckIntervalMs.
+ */
+void alertsCheck() {
+  unsigned long now = millis();
+
+  // Signal: no pulsatile component, or the ADC pinned to a rail (finger off)
+  bool clipped = signalValue <= alertClipMargin || signalValue >= 1023 - alertClipMargin;
+  bool signalLost = clipped || envelopeValue < minPulseAmplitude;
+
+  // Detector time since the last beat (or since sampling began), counted in
+  // sample ticks: the us timestamps wrap after ~71 minutes. A new beat is
+  // at most one check old, so its us difference is still exact.
+  if (beatCount != alertBeatCount) {
+    alertBeatCount = beatCount;
+    uint32_t nowUs = lastSampleTick * sampleIntervalUs;
+    alertBeatTick = lastSampleTick;
+    if (beatCount > 0) alertBeatTick -= (nowUs - lastBeatTimeUs) / sampleIntervalUs;
+  }
+  uint32_t sinceBeatTicks = lastSampleTick - alertBeatTick;
+  uint32_t sinceBeatS = sinceBeatTicks / (1000 / sampleIntervalMs);
+  bool noBeat = sinceBeatS >= ALERT_NO_BEAT_SECONDS;
+
+  // BPM rules only mean something while beats are being found
+  int bpm = beatsPerMinute;
+  bool tracking = pulseDetected && !signalLost && !noBeat;
+
+  char detail[48];
+  AlertEvent event;
+  if ((event = alertUpdate(alertBpmHigh, tracking && bpm > ALERT_BPM_HIGH, now)) != ALERT_NONE) {
+    snprintf(detail, sizeof(detail), "%d BPM (limit %d)", bpm, ALERT_BPM_HIGH);
+    alertNotify(alertBpmHigh, event, detail);
+  }
+  if ((event = alertUpdate(alertBpmLow, tracking && bpm < ALERT_BPM_LOW, now)) != ALERT_NONE) {
+    snprintf(detail, sizeof(detail), "%d BPM (limit %d)", bpm, ALERT_BPM_LOW);
+    alertNotify(alertBpmLow, event, detail);
+  }
+  if ((event = alertUpdate(alertNoBeat, noBeat && !signalLost, now)) != ALERT_NONE) {
+    snprintf(detail, sizeof(detail), "%u s since the last beat", (unsigned)sinceBeatS);
+    alertNotify(alertNoBeat, event, detail);
+  }
+  if ((event = alertUpdate(alertSignalLost, signalLost, now)) != ALERT_NONE) {
+    snprintf(detail, sizeof(detail), clipped ? "sensor reading clipped (%d)" : "no pulse in signal (%d)",
+             signalValue);
+    alertNotify(alertSignalLost, event, detail);
+  }
+}
+
+#endif // ALERT_RULES_H
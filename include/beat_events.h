@@ -0,0 +1,109 @@
+#ifndef BEAT_EVENTS_H
+#define BEAT_EVENTS_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Beat event queue
+ * ================
+ * Every beat the detector accepts is stored as a BeatEvent in a
+ * power-of-two ring indexed by its sequence number (beatCount at the beat,
+ * from 1). The detector only ever overwrites the oldest entry, so it never
+ * waits for anyone; each consumer keeps its own BeatCursor and reads the
+ * entries in place:
+ *
+ *   BeatCursor cursor = beatCursorAt(beatEvents);   // from the next beat
+ *   while (const BeatEvent* e = beatEventNext(beatEvents, cursor)) ...
+ *
+ * A consumer that falls more than BEAT_EVENT_QUEUE beats behind skips to
+ * the oldest stored one and cursor.missed counts the beats it lost; a gap
+ * in seq shows the same to anyone the events are forwarded to. Entries are
+ * only written by readHeartRate(), which runs in the same task loop as
+ * every consumer, so a returned pointer stays valid until the detector
+ * runs again.
+ */
+
+#ifndef BEAT_EVENT_QUEUE
+#define BEAT_EVENT_QUEUE 32        // Beats kept (16 s at 120 BPM); power of two
+#endif
+
+#if (BEAT_EVENT_QUEUE & (BEAT_EVENT_QUEUE - 1)) != 0
+#error "BEAT_EVENT_QUEUE must be a power of two"
+#endif
+
+const uint8_t beatEventAccepted = 0x01;  // IBI passed the range and outlier checks
+const uint8_t beatEventQuality = 0x02;   // Rate including this beat was of adequate quality (SQI_MIN)
+
+struct BeatEvent {
+  uint32_t seq;
+  uint32_t timeUs;               // Detector time of the peak, interpolated (wraps after ~71 min)
+  uint32_t ibiUs;                // Interval since the previous beat, 0 for the first
+  int16_t amplitude;             // Band-passed peak height, ADC x 8
+  uint8_t flags;
+  uint8_t reserved;
+};
+
+struct BeatEventQueue {
+  BeatEvent events[BEAT_EVENT_QUEUE];
+  uint32_t nextSeq;              // Sequence number the next push will get
+};
+
+struct BeatCursor {
+  uint32_t next;                 // Sequence number wanted next
+  uint32_t missed;               // Beats overwritten before they were read
+};
+
+BeatEventQueue beatEvents;
+
+void beatEventsReset(BeatEventQueue& q) {
+  memset(&q, 0, sizeof(q));
+  q.nextSeq = 1;
+}
+
+/**
+ * Store a beat; overwrites the oldest when the queue is full
+ */
+inline void beatEventPush(BeatEventQueue& q, uint32_t timeUs, uint32_t ibiUs, int32_t amplitude,
+                          uint8_t flags) {
+  BeatEvent& e = q.events[q.nextSeq & (BEAT_EVENT_QUEUE - 1)];
+  e.seq = q.nextSeq++;
+  e.timeUs = timeUs;
+  e.ibiUs = ibiUs;
+  e.amplitude = (int16_t)(amplitude > INT16_MAX ? INT16_MAX : (amplitude < INT16_MIN ? INT16_MIN : amplitude));
+  e.flags = flags;
+}
+
+/**
+ * Oldest sequence number still in the queue
+ */
+inline uint32_t beatEventOldest(const BeatEventQueue& q) {
+  return q.nextSeq > BEAT_EVENT_QUEUE ? q.nextSeq - BEAT_EVENT_QUEUE : 1;
+}
+
+/**
+ * A cursor that will see only beats from now on
+ */
+inline BeatCursor beatCursorAt(const BeatEventQueue& q) {
+  BeatCursor c = {q.nextSeq, 0};
+  return c;
+}
+
+/**
+ * The cursor's next event, or nullptr when it has read them all. Skips
+ * (and counts) events already overwritten; a cursor from before a reset
+ * restarts at the oldest stored event.
+ */
+inline const BeatEvent* beatEventNext(const BeatEventQueue& q, BeatCursor& c) {
+  if (c.next == q.nextSeq) return nullptr;
+  uint32_t oldest = beatEventOldest(q);
+  if (c.next - oldest >= q.nextSeq - oldest) {
+    // Behind the oldest (lost to overwrites), or ahead of the queue (reset)
+    if ((int32_t)(c.next - oldest) < 0) c.missed += oldest - c.next;
+    c.next = oldest;
+    if (c.next == q.nextSeq) return nullptr;
+  }
+  return &q.events[c.next++ & (BEAT_EVENT_QUEUE - 1)];
+}
+
+#endif // BEAT_EVENTS_H
@@ -0,0 +1,219 @@
+#ifndef BEAT_STATS_H
+#define BEAT_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Incremental beat statistics
+ * ===========================
+ * Constant-time per beat: every accepted inter-beat interval (IBI) updates
+ * running sums over a sliding window instead of re-summing an array.
+ *
+ *   mean IBI / BPM   running sum of IBIs
+ *   SDNN             running sum of squared IBIs (exact 64-bit integers,
+ *                    so no cancellation in sumSq - sum^2/n)
+ *   RMSSD            running sum of squared successive differences
+ *   pNN50            running count of successive differences > 50 ms
+ *
+ * Outlier rejection: a candidate IBI is compared to the median of the last
+ * HR_MEDIAN_WINDOW accepted IBIs and dropped if it deviates by more than
+ * HR_OUTLIER_PERCENT. That catches ectopic beats (short then long) and
+ * missed beats (roughly double). If HR_OUTLIER_RUN candidates in a row are
+ * rejected, the rhythm has genuinely changed and the median is re-seeded.
+ *
+ * Window sizes are template parameters so detectors with different
+ * windows can run side by side; BeatStats is the HR_STATS_WINDOW /
+ * HR_MEDIAN_WINDOW instance the firmware uses (override with -D in
+ * platformio.ini).
+ */
+
+#ifndef HR_STATS_WINDOW
+#define HR_STATS_WINDOW 16         // IBIs in the mean/SDNN/RMSSD/pNN50 window
+#endif
+
+#ifndef HR_MEDIAN_WINDOW
+#define HR_MEDIAN_WINDOW 5         // IBIs in the outlier reference median
+#endif
+
+#ifndef HR_OUTLIER_PERCENT
+#define HR_OUTLIER_PERCENT 25      // Max deviation from the median, percent
+#endif
+
+#ifndef HR_OUTLIER_RUN
+#define HR_OUTLIER_RUN 4           // Consecutive rejects that re-seed the median
+#endif
+
+const uint32_t ibiMinUs = 300000;   // 200 BPM
+const uint32_t ibiMaxUs = 2000000;  // 30 BPM
+const uint32_t nn50Us = 50000;
+
+template <int Window, int Median>
+struct BeatStatsWindow {
+  static_assert(Window >= 2 && Window <= 255 && Median >= 1 && Median <= 255,
+                "stats window must be 2..255 and median window 1..255");
+  static constexpr int window = Window;
+  static constexpr int medianWindow = Median;
+
+  // Sliding window of accepted IBIs, microseconds
+  uint32_t ibi[Window];
+  uint8_t head;                 // Next slot to write
+  uint8_t count;                // Valid IBIs in the window
+  uint64_t sum;
+  uint64_t sumSq;
+  uint64_t sumSqDiff;           // Successive differences inside the window
+  uint16_t nn50;                // Of those, how many exceed 50 ms
+
+  // Reference for outlier rejection: last accepted IBIs, kept sorted
+  uint32_t median[Median];
+  uint32_t medianAge[Median];   // Insertion order, to evict the oldest
+  uint8_t medianCount;
+  uint32_t medianSerial;
+  uint8_t rejectRun;
+
+  uint32_t accepted;
+  uint32_t rejected;
+};
+
+typedef BeatStatsWindow<HR_STATS_WINDOW, HR_MEDIAN_WINDOW> BeatStats;
+
+/**
+ * Clear the window and counters
+ */
+template <int W, int M>
+void beatStatsReset(BeatStatsWindow<W, M>& s) {
+  memset(&s, 0, sizeof(s));
+}
+
+/**
+ * Push an IBI into the sorted median window, evicting the oldest entry
+ * when full. O(median window), a compile-time constant.
+ */
+template <int W, int M>
+void beatStatsMedianPush(BeatStatsWindow<W, M>& s, uint32_t ibiUs) {
+  if (s.medianCount == M) {
+    uint8_t oldest = 0;
+    for (uint8_t i = 1; i < s.medianCount; i++) {
+      if (s.medianAge[i] < s.medianAge[oldest]) oldest = i;
+    }
+    for (uint8_t i = oldest; i + 1 < s.medianCount; i++) {
+      s.median[i] = s.median[i + 1];
+      s.medianAge[i] = s.medianAge[i + 1];
+    }
+    s.medianCount--;
+  }
+  uint8_t pos = s.medianCount;
+  while (pos > 0 && s.median[pos - 1] > ibiUs) {
+    s.median[pos] = s.median[pos - 1];
+    s.medianAge[pos] = s.medianAge[pos - 1];
+    pos--;
+  }
+  s.median[pos] = ibiUs;
+  s.medianAge[pos] = s.medianSerial++;
+  s.medianCount++;
+}
+
+inline uint32_t absDiff(uint32_t a, uint32_t b) {
+  return a > b ? a - b : b - a;
+}
+
+/**
+ * Offer a new inter-beat interval
+ * @return true if it passed the physiological range and outlier checks
+ *         and was added to the statistics
+ */
+template <int W, int M>
+bool beatStatsAdd(BeatStatsWindow<W, M>& s, uint32_t ibiUs) {
+  if (ibiUs < ibiMinUs || ibiUs > ibiMaxUs) {
+    s.rejected++;
+    return false;
+  }
+
+  // Adaptive deviation check against the running median
+  if (s.medianCount >= (M + 1) / 2) {
+    uint32_t ref = s.median[s.medianCount / 2];
+    if (absDiff(ibiUs, ref) * 100 > ref * HR_OUTLIER_PERCENT) {
+      if (s.rejectRun + 1 < HR_OUTLIER_RUN) {
+        s.rejectRun++;
+        s.rejected++;
+        return false;
+      }
+      // Sustained change of rhythm: restart the reference from here
+      s.medianCount = 0;
+    }
+  }
+  s.rejectRun = 0;
+  beatStatsMedianPush(s, ibiUs);
+
+  // Evict the oldest IBI and its difference to the next one
+  if (s.count == W) {
+    uint32_t oldest = s.ibi[s.head];
+    uint32_t next = s.ibi[(s.head + 1) % W];
+    uint64_t d = absDiff(next, oldest);
+    s.sum -= oldest;
+    s.sumSq -= (uint64_t)oldest * oldest;
+    s.sumSqDiff -= d * d;
+    if (d > nn50Us) s.nn50--;
+    s.count--;
+  }
+
+  // Add the new IBI and its difference to the previous one
+  if (s.count > 0) {
+    uint32_t prev = s.ibi[(s.head + W - 1) % W];
+    uint64_t d = absDiff(ibiUs, prev);
+    s.sumSqDiff += d * d;
+    if (d > nn50Us) s.nn50++;
+  }
+  s.ibi[s.head] = ibiUs;
+  s.head = (s.head + 1) % W;
+  s.sum += ibiUs;
+  s.sumSq += (uint64_t)ibiUs * ibiUs;
+  s.count++;
+  s.accepted++;
+  return true;
+}
+
+// ========================= DERIVED METRICS =========================
+
+template <int W, int M>
+inline uint32_t beatStatsMeanUs(const BeatStatsWindow<W, M>& s) {
+  return s.count ? (uint32_t)(s.sum / s.count) : 0;
+}
+
+template <int W, int M>
+inline int beatStatsBpm(const BeatStatsWindow<W, M>& s) {
+  uint32_t mean = beatStatsMeanUs(s);
+  return mean ? (int)((60000000UL + mean / 2) / mean) : 0;
+}
+
+/**
+ * Population standard deviation of the windowed IBIs, in ms
+ */
+template <int W, int M>
+inline float beatStatsSdnnMs(const BeatStatsWindow<W, M>& s) {
+  if (s.count < 2) return 0;
+  uint64_t n = s.count;
+  uint64_t scaledVar = n * s.sumSq - s.sum * s.sum;   // n^2 * variance, exact
+  return sqrtf((float)scaledVar) / (float)n / 1000.0f;
+}
+
+/**
+ * Root mean square of successive IBI differences in the window, in ms
+ */
+template <int W, int M>
+inline float beatStatsRmssdMs(const BeatStatsWindow<W, M>& s) {
+  if (s.count < 2) return 0;
+  return sqrtf((float)(s.sumSqDiff / (s.count - 1))) / 1000.0f;
+}
+
+/**
+ * Percentage of successive differences above 50 ms
+ */
+template <int W, int M>
+inline float beatStatsPnn50(const BeatStatsWindow<W, M>& s) {
+  if (s.count < 2) return 0;
+  return 100.0f * s.nn50 / (s.count - 1);
+}
+
+#endif // BEAT_STATS_H
@@ -0,0 +1,205 @@
+#ifndef BPM_HISTORY_H
+#define BPM_HISTORY_H
+
+#include <stdint.h>
+#include <string.h>
+#include "text_buffer.h"
+
+/*
+ * Heart rate history
+ * ==================
+ * Three fixed rings of the reported heart rate, each at a coarser
+ * resolution and over a longer span:
+ *
+ *   second   the BPM of every second (0: no adequate reading)
+ *   minute   min, mean and max of the seconds with a reading, and the
+ *            share of seconds that had one (coverage, percent)
+ *   hour     the same over the hour's seconds
+ *
+ * Each second is added once and folded into running minute and hour
+ * aggregates (a sum, a count, min and max) as it arrives; when a minute or
+ * hour ends its aggregate is stored and cleared. Nothing is ever rescanned,
+ * so an insert costs the same however much history is kept, and the rings
+ * are sized at compile time (HISTORY_SECONDS etc., 4 bytes per minute or
+ * hour bucket).
+ *
+ * Time is seconds of detector time (sample ticks), so the history stays
+ * exact while SNTP corrects the clock; /history converts to Unix time.
+ *
+ * historyJson() writes one resolution between two times:
+ *   {"res":"second","step":1,"from":T,"bpm":[72,73,0,...]}
+ *   {"res":"minute","step":60,"from":T,"rows":[[min,mean,max,coverage],...]}
+ * `from` is the start of the first entry, each next one `step` seconds
+ * later; the current minute and hour are included as they stand. When the
+ * buffer cannot hold the whole range, `next` is where to continue.
+ */
+
+#ifndef HISTORY_SECONDS
+#define HISTORY_SECONDS 600        // Per-second BPM: 10 min
+#endif
+
+#ifndef HISTORY_MINUTES
+#define HISTORY_MINUTES 240        // Per-minute aggregates: 4 h
+#endif
+
+#ifndef HISTORY_HOURS
+#define HISTORY_HOURS 168          // Per-hour aggregates: 7 days
+#endif
+
+enum HistoryRes { HISTORY_SECOND, HISTORY_MINUTE, HISTORY_HOUR };
+
+struct HistoryBucket {
+  uint8_t min;
+  uint8_t mean;
+  uint8_t max;
+  uint8_t coverage;              // Percent of seconds with a reading
+};
+
+struct HistoryAccum {
+  uint32_t sum;
+  uint16_t readings;
+  uint16_t seconds;
+  uint8_t min;
+  uint8_t max;
+};
+
+struct BpmHistory {
+  uint8_t second[HISTORY_SECONDS];
+  HistoryBucket minute[HISTORY_MINUTES];
+  HistoryBucket hour[HISTORY_HOURS];
+  HistoryAccum minuteAccum;
+  HistoryAccum hourAccum;
+  bool started;
+  uint32_t firstSecond;          // First second recorded since reset
+  uint32_t now;                  // Second being filled; everything before is stored
+  uint8_t pending;               // Latest reading within it
+};
+
+BpmHistory bpmHistory;
+
+void historyReset(BpmHistory& h) {
+  memset(&h, 0, sizeof(h));
+}
+
+inline void historyAccumAdd(HistoryAccum& a, uint8_t bpm) {
+  a.seconds++;
+  if (bpm == 0) return;
+  if (a.readings == 0 || bpm < a.min) a.min = bpm;
+  if (a.readings == 0 || bpm > a.max) a.max = bpm;
+  a.sum += bpm;
+  a.readings++;
+}
+
+inline HistoryBucket historyAccumBucket(const HistoryAccum& a) {
+  HistoryBucket b = HistoryBucket();
+  if (a.seconds) b.coverage = (uint8_t)((a.readings * 100U + a.seconds / 2) / a.seconds);
+  if (a.readings == 0) return b;
+  b.min = a.min;
+  b.max = a.max;
+  b.mean = (uint8_t)((a.sum + a.readings / 2) / a.readings);
+  return b;
+}
+
+/**
+ * Store the second being filled and roll it into the minute and hour
+ */
+void historyCommit(BpmHistory& h) {
+  uint32_t s = h.now;
+  h.second[s % HISTORY_SECONDS] = h.pending;
+  historyAccumAdd(h.minuteAccum, h.pending);
+  historyAccumAdd(h.hourAccum, h.pending);
+  if ((s + 1) % 60 == 0) {
+    h.minute[(s / 60) % HISTORY_MINUTES] = historyAccumBucket(h.minuteAccum);
+    memset(&h.minuteAccum, 0, sizeof(h.minuteAccum));
+  }
+  if ((s + 1) % 3600 == 0) {
+    h.hour[(s / 3600) % HISTORY_HOURS] = historyAccumBucket(h.hourAccum);
+    memset(&h.hourAccum, 0, sizeof(h.hourAccum));
+  }
+  h.now = s + 1;
+  h.pending = 0;
+}
+
+/**
+ * Record the reading for a second; the last one given for a second counts.
+ * Call as often as convenient: seconds skipped are stored as "no reading".
+ * @param bpm 0 if there is no adequate reading
+ */
+void historyAdd(BpmHistory& h, uint32_t second, int bpm) {
+  if (!h.started) {
+    h.started = true;
+    h.firstSecond = h.now = second;
+  }
+  if ((int32_t)(second - h.now) < 0) return;
+  while (h.now != second) historyCommit(h);
+  h.pending = (uint8_t)(bpm < 0 ? 0 : (bpm > 255 ? 255 : bpm));
+}
+
+inline uint32_t historyStep(HistoryRes res) {
+  return res == HISTORY_HOUR ? 3600 : (res == HISTORY_MINUTE ? 60 : 1);
+}
+
+inline uint32_t historySlots(HistoryRes res) {
+  return res == HISTORY_HOUR ? HISTORY_HOURS : (res == HISTORY_MINUTE ? HISTORY_MINUTES : HISTORY_SECONDS);
+}
+
+inline const char* historyResName(HistoryRes res) {
+  return res == HISTORY_HOUR ? "hour" : (res == HISTORY_MINUTE ? "minute" : "second");
+}
+
+bool historyParseRes(const char* name, HistoryRes* res) {
+  for (int r = HISTORY_SECOND; r <= HISTORY_HOUR; r++) {
+    if (!strcmp(name, historyResName((HistoryRes)r))) {
+      *res = (HistoryRes)r;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Bucket `index` (in units of the resolution's step); the newest
+ * minute and hour come from the running aggregate
+ */
+HistoryBucket historyBucket(const BpmHistory& h, HistoryRes res, uint32_t index) {
+  if (res == HISTORY_MINUTE) {
+    return index == h.now / 60 ? historyAccumBucket(h.minuteAccum) : h.minute[index % HISTORY_MINUTES];
+  }
+  return index == h.now / 3600 ? historyAccumBucket(h.hourAccum) : h.hour[index % HISTORY_HOURS];
+}
+
+/**
+ * Write the entries of one resolution that overlap [fromS, toS] as JSON
+ * (format above). Times are detector seconds plus offsetS, which lets the
+ * caller work in Unix time; entries no longer (or not yet) stored are
+ * left out.
+ */
+void historyJson(TextBuffer& b, const BpmHistory& h, HistoryRes res, int64_t fromS, int64_t toS,
+                 int64_t offsetS) {
+  const size_t rowMax = 20;      // "[255,255,255,100],"
+  const size_t tailMax = 32;     // ],"next":4294967295000}
+  uint32_t step = historyStep(res);
+  // Newest entry: the last whole second, or the running minute or hour
+  int64_t newest = res == HISTORY_SECOND ? (int64_t)h.now - 1 : (int64_t)(h.now / step);
+  int64_t oldest = max<int64_t>((int64_t)(h.firstSecond / step), newest - historySlots(res) + 1);
+  int64_t first = max<int64_t>(oldest, (fromS - offsetS) >= 0 ? (fromS - offsetS) / step : 0);
+  int64_t last = min<int64_t>(newest, (toS - offsetS) >= 0 ? (toS - offsetS) / step : -1);
+
+  textPrintf(b, "{\"res\":\"%s\",\"step\":%u,\"from\":%lld,\"%s\":[", historyResName(res),
+             (unsigned)step, (long long)(first * step + offsetS), res == HISTORY_SECOND ? "bpm" : "rows");
+  int64_t i = first;
+  for (; h.started && i <= last; i++) {
+    if (b.capacity - b.length < rowMax + tailMax) break;
+    if (res == HISTORY_SECOND) {
+      textPrintf(b, "%s%u", i > first ? "," : "", h.second[i % HISTORY_SECONDS]);
+    } else {
+      HistoryBucket k = historyBucket(h, res, (uint32_t)i);
+      textPrintf(b, "%s[%u,%u,%u,%u]", i > first ? "," : "", k.min, k.mean, k.max, k.coverage);
+    }
+  }
+  textAppend(b, "]");
+  if (h.started && i <= last) textPrintf(b, ",\"next\":%lld", (long long)(i * step + offsetS));
+  textAppend(b, "}");
+}
+
+#endif // BPM_HISTORY_H
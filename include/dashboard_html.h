@@ -0,0 +1,259 @@
+// Generated by tools/embed_web.py from web/index.html - do not edit.
+#ifndef DASHBOARD_HTML_H
+#define DASHBOARD_HTML_H
+
+#include <Arduino.h>
+
+// Strong validator for If-None-Match; changes whenever the page does
+#define DASHBOARD_ETAG "\"a5fa0312ce3e0c44\""
+
+#define DASHBOARD_GZ_LENGTH 3881  // 14602 bytes uncompressed
+
+const size_t dashboardHtmlGzLen = DASHBOARD_GZ_LENGTH;
+const uint8_t dashboardHtmlGz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xdd, 0x5b, 0xeb, 0x72, 0xdb, 0xc6,
+  0x15, 0xfe, 0xef, 0xa7, 0xd8, 0x28, 0x13, 0x13, 0x8c, 0x08, 0x88, 0xa4, 0x24, 0x8a, 0x16, 0x45,
+  0xba, 0x89, 0xed, 0x24, 0xea, 0x38, 0xb6, 0x26, 0xf2, 0x65, 0x3a, 0x1e, 0xb7, 0x59, 0x02, 0x0b,
+  0x02, 0x31, 0x88, 0x65, 0x01, 0x90, 0x94, 0x92, 0xe8, 0x0d, 0x3a, 0xd3, 0xce, 0xf4, 0x5f, 0x67,
+  0x3a, 0x6d, 0x67, 0xfa, 0x10, 0x7d, 0x9e, 0xbc, 0x40, 0xfb, 0x08, 0x3d, 0x67, 0x17, 0xd7, 0xc5,
+  0x02, 0xa4, 0x9d, 0xf4, 0x4f, 0x69, 0x5b, 0x02, 0xb0, 0x67, 0xcf, 0x9e, 0xeb, 0x77, 0xce, 0x2e,
+  0xe8, 0x8b, 0x8f, 0x1e, 0x3f, 0x7f, 0xf4, 0xe2, 0x37, 0x57, 0x4f, 0x88, 0x97, 0x2c, 0x83, 0xd9,
+  0xbd, 0x0b, 0xfc, 0x45, 0x02, 0x1a, 0x2e, 0xa6, 0x07, 0x2c, 0x3c, 0xc0, 0x07, 0x8c, 0x3a, 0xb3,
+  0x7b, 0x04, 0x3e, 0x17, 0x4b, 0x96, 0x50, 0x62, 0x7b, 0x34, 0x8a, 0x59, 0x32, 0x3d, 0x78, 0xf9,
+  0xe2, 0x0b, 0x73, 0x7c, 0x50, 0x1e, 0x0a, 0xe9, 0x92, 0x4d, 0x0f, 0x36, 0x3e, 0xdb, 0xae, 0x78,
+  0x94, 0x1c, 0x10, 0x9b, 0x87, 0x09, 0x0b, 0x81, 0x74, 0xeb, 0x3b, 0x89, 0x37, 0x75, 0xd8, 0xc6,
+  0xb7, 0x99, 0x29, 0x6e, 0x7a, 0xc4, 0x0f, 0xfd, 0xc4, 0xa7, 0x81, 0x19, 0xdb, 0x34, 0x60, 0xd3,
+  0x81, 0xd5, 0xcf, 0x58, 0x25, 0x7e, 0x12, 0xb0, 0xd9, 0x4f, 0x7f, 0xfd, 0xe7, 0xbf, 0xff, 0xf5,
+  0x47, 0xf2, 0x15, 0xa3, 0x51, 0x42, 0xbe, 0xa1, 0x09, 0x23, 0x5f, 0x73, 0x98, 0xc1, 0xa3, 0x8b,
+  0x23, 0x49, 0x20, 0x89, 0xe3, 0xe4, 0x36, 0xbb, 0xc6, 0xcf, 0xa7, 0xe4, 0x07, 0xb2, 0xa4, 0xd1,
+  0xc2, 0x0f, 0xcf, 0x49, 0x7f, 0x42, 0x56, 0xd4, 0x71, 0xfc, 0x70, 0x21, 0xae, 0xe7, 0xfc, 0xc6,
+  0x8c, 0xfd, 0xef, 0xc5, 0xed, 0x9c, 0x47, 0x0e, 0x8b, 0x4c, 0x78, 0x34, 0x21, 0x77, 0xf9, 0xe4,
+  0xfc, 0x62, 0xce, 0x9d, 0x5b, 0x60, 0x94, 0xdf, 0xe3, 0xc7, 0x05, 0x5d, 0x4c, 0x97, 0x2e, 0xfd,
+  0xe0, 0xf6, 0x9c, 0x74, 0xae, 0xd9, 0x82, 0x33, 0xf2, 0xf2, 0xb2, 0xd3, 0x23, 0x2f, 0xa8, 0xc7,
+  0x97, 0xb4, 0x47, 0xbe, 0x64, 0x21, 0xdb, 0xc0, 0xef, 0x57, 0x2c, 0x72, 0x68, 0x08, 0x17, 0x31,
+  0x0d, 0x63, 0x33, 0x66, 0x91, 0xef, 0x4e, 0xaa, 0xac, 0xe6, 0xd4, 0x7e, 0xb7, 0x88, 0xf8, 0x3a,
+  0x74, 0xce, 0x49, 0xe0, 0x87, 0xa0, 0xa1, 0xb9, 0x88, 0xa8, 0xe3, 0x83, 0xa9, 0x8c, 0xc1, 0xf1,
+  0xa9, 0xc3, 0x16, 0x3d, 0xf2, 0xf1, 0x68, 0x74, 0xc6, 0x18, 0x25, 0xfd, 0x4f, 0xe0, 0xfa, 0x6c,
+  0x74, 0x32, 0xa7, 0x43, 0x32, 0xe8, 0xf7, 0x3f, 0xe9, 0x4e, 0x2a, 0xac, 0x6c, 0x1e, 0xf0, 0xe8,
+  0x9c, 0x7c, 0x7c, 0x7c, 0x7c, 0xac, 0x2c, 0xb2, 0xf4, 0x43, 0xd3, 0x63, 0xfe, 0xc2, 0x4b, 0xce,
+  0x71, 0xe2, 0xc6, 0xab, 0x4e, 0x74, 0xfc, 0x78, 0x15, 0x50, 0x50, 0xc5, 0x0d, 0xd8, 0x4d, 0x75,
+  0x88, 0x06, 0xfe, 0x22, 0x34, 0xfd, 0x84, 0x2d, 0xe3, 0x73, 0x62, 0x83, 0x50, 0x2c, 0xaa, 0x12,
+  0x7c, 0xb7, 0x8e, 0x13, 0xdf, 0xbd, 0x35, 0x53, 0xf7, 0xd6, 0x89, 0x34, 0x26, 0xb5, 0x90, 0x98,
+  0x82, 0xb2, 0x91, 0x6a, 0xd8, 0xb2, 0x35, 0xa2, 0xc5, 0x9c, 0x1a, 0xc3, 0xd3, 0xd3, 0x1e, 0x29,
+  0x7e, 0xf4, 0xad, 0x07, 0xa7, 0x8a, 0xd6, 0xa9, 0xfb, 0xd0, 0x66, 0x6b, 0x90, 0x71, 0xd8, 0x5f,
+  0xdd, 0xa8, 0x26, 0x46, 0x67, 0x7b, 0xd4, 0xe1, 0x5b, 0xf0, 0xbd, 0x20, 0x20, 0x27, 0xf8, 0x43,
+  0x2c, 0xd0, 0xef, 0x89, 0x3f, 0xd6, 0x40, 0x61, 0x9b, 0x47, 0x0b, 0x92, 0x56, 0x87, 0x96, 0xf4,
+  0x46, 0xc6, 0x2d, 0x0c, 0x9e, 0xd6, 0x46, 0xd3, 0x91, 0x07, 0xfd, 0x4f, 0xaa, 0xcf, 0x13, 0x76,
+  0x93, 0x98, 0xc2, 0x9c, 0x7a, 0x43, 0xa2, 0xea, 0x4e, 0xc4, 0x57, 0xa6, 0xeb, 0x07, 0x30, 0x08,
+  0x71, 0x19, 0xac, 0x23, 0x63, 0x00, 0xfc, 0xbb, 0xed, 0xc6, 0xc4, 0x9c, 0x14, 0x96, 0x94, 0xb1,
+  0x0e, 0x81, 0x9c, 0x24, 0x7c, 0x79, 0x4e, 0x8e, 0x85, 0x25, 0x8a, 0x19, 0x96, 0x48, 0x15, 0xa0,
+  0x13, 0xd1, 0x0b, 0xd1, 0xcf, 0xc0, 0x5a, 0x63, 0xa4, 0x11, 0x0f, 0xb6, 0x69, 0x7c, 0x9c, 0xf5,
+  0x21, 0x3f, 0xb2, 0x50, 0x1a, 0xda, 0xc7, 0xec, 0x14, 0xee, 0x15, 0xd6, 0x03, 0x95, 0x75, 0xbc,
+  0x9e, 0x67, 0xdc, 0xb3, 0xa9, 0x67, 0xee, 0xd8, 0x1e, 0x3b, 0x93, 0xf2, 0x6a, 0x83, 0xd1, 0x4a,
+  0x9f, 0x63, 0xa8, 0x43, 0x04, 0x54, 0xcc, 0x4e, 0x7c, 0x1e, 0x96, 0xd2, 0x16, 0x75, 0xc0, 0x7c,
+  0xbd, 0x53, 0x48, 0xb5, 0x09, 0x29, 0x17, 0x19, 0xd7, 0x03, 0x80, 0x86, 0xfe, 0x92, 0x22, 0xe7,
+  0x73, 0x22, 0x66, 0xcf, 0x19, 0x4d, 0xc8, 0xc0, 0x1a, 0xc6, 0x84, 0xd1, 0x98, 0x99, 0xa0, 0x18,
+  0x5f, 0x27, 0x80, 0x41, 0x2e, 0xc2, 0x10, 0x6b, 0xc8, 0x0d, 0x3f, 0xc4, 0xf4, 0x34, 0xe7, 0x01,
+  0xb7, 0xdf, 0x55, 0x49, 0x32, 0x87, 0x09, 0xef, 0xc9, 0x40, 0x33, 0xfa, 0xe4, 0x04, 0x24, 0x1f,
+  0x67, 0x51, 0x36, 0x3c, 0x1e, 0xf4, 0xc8, 0xd9, 0xa8, 0x47, 0x46, 0x7d, 0x0c, 0xe2, 0xe3, 0x6e,
+  0xbb, 0x4f, 0x7f, 0xf5, 0x8e, 0xdd, 0xba, 0x11, 0x00, 0x68, 0x5c, 0x12, 0x58, 0x51, 0x19, 0xc1,
+  0x00, 0x41, 0x00, 0x9e, 0x27, 0x11, 0xa0, 0x8b, 0xcb, 0x23, 0xf0, 0x8c, 0x00, 0x50, 0x03, 0x82,
+  0xb9, 0xc4, 0x16, 0x3f, 0x83, 0x13, 0x3d, 0xa1, 0x55, 0x27, 0x1d, 0x8e, 0xf7, 0xe4, 0x79, 0x32,
+  0xdc, 0x9b, 0xe7, 0xd9, 0x3e, 0x72, 0xea, 0x02, 0x63, 0xbe, 0x5a, 0xee, 0x17, 0x16, 0x48, 0xb8,
+  0xa1, 0xc1, 0x9a, 0xb5, 0x84, 0xc6, 0xe9, 0xa8, 0x16, 0x1a, 0x95, 0xd0, 0x1f, 0x63, 0xe8, 0x6b,
+  0x21, 0x95, 0x9d, 0x9d, 0xd8, 0xc7, 0xb6, 0x8a, 0xaa, 0xa9, 0x34, 0x03, 0x29, 0x4d, 0x3d, 0xdb,
+  0x4b, 0xa0, 0x83, 0x98, 0xd3, 0x10, 0x0c, 0x43, 0x6d, 0x2c, 0x08, 0x85, 0x02, 0x3a, 0x67, 0x41,
+  0x8b, 0x42, 0x83, 0x71, 0x4d, 0x21, 0x35, 0xfd, 0x9a, 0xb5, 0x1d, 0xf5, 0x15, 0x99, 0x03, 0x96,
+  0x40, 0x1c, 0x9b, 0xf1, 0x8a, 0xda, 0x02, 0xf9, 0x86, 0x65, 0x68, 0xd3, 0x39, 0x27, 0x4e, 0x68,
+  0xb2, 0x8e, 0x55, 0xf9, 0xf6, 0xc8, 0x98, 0x1c, 0x5c, 0x31, 0x41, 0x04, 0x2a, 0xec, 0x84, 0xf4,
+  0x46, 0x13, 0x9c, 0x68, 0x07, 0x1b, 0x95, 0xcc, 0x9d, 0x76, 0x5a, 0x75, 0xda, 0x9d, 0xaa, 0x96,
+  0xe5, 0xb0, 0x04, 0x03, 0x2f, 0x5c, 0x80, 0x82, 0xe5, 0xba, 0xf4, 0xf1, 0xf1, 0xc9, 0x83, 0xb1,
+  0x33, 0xcf, 0x41, 0x72, 0xeb, 0x21, 0x68, 0x68, 0x18, 0x40, 0x95, 0x0b, 0x81, 0x03, 0x73, 0x54,
+  0x06, 0xc3, 0x33, 0xca, 0x46, 0xfd, 0xdd, 0x0c, 0x58, 0x14, 0xf1, 0x48, 0x9d, 0x9c, 0x85, 0x62,
+  0xd3, 0xe4, 0x82, 0xcb, 0x6a, 0x1d, 0x00, 0xba, 0x6d, 0xe9, 0xa6, 0x96, 0x13, 0x99, 0x11, 0x86,
+  0x9a, 0xc8, 0xf5, 0x72, 0xcb, 0xd5, 0xdc, 0x52, 0x11, 0xc3, 0x76, 0xfb, 0xee, 0xa0, 0xd5, 0x6f,
+  0x83, 0x1a, 0x87, 0x15, 0x8f, 0x7d, 0x89, 0xc3, 0x11, 0x0b, 0x00, 0x91, 0x37, 0x0a, 0xd8, 0xf2,
+  0x0d, 0x8b, 0xdc, 0x00, 0x53, 0xc6, 0xf3, 0x1d, 0x87, 0x85, 0xed, 0xe1, 0x57, 0xd2, 0xcf, 0xa6,
+  0xe1, 0x86, 0x42, 0x24, 0xea, 0x03, 0x51, 0x13, 0x81, 0x69, 0x95, 0x46, 0x00, 0xd5, 0xab, 0x5f,
+  0x1d, 0x69, 0x5f, 0xde, 0x4a, 0x22, 0x16, 0xa2, 0x97, 0xbd, 0x1c, 0x48, 0x9a, 0x0a, 0x1d, 0x7a,
+  0xb6, 0x39, 0x63, 0x16, 0x91, 0xef, 0x54, 0xc5, 0xc1, 0x27, 0x26, 0x74, 0x5f, 0x30, 0x9e, 0x30,
+  0x68, 0xb2, 0x82, 0xf5, 0x32, 0x44, 0xd3, 0xba, 0x11, 0xfe, 0x53, 0x68, 0xe9, 0x4a, 0xc6, 0xb5,
+  0x2e, 0xe2, 0xcd, 0x84, 0xaf, 0xd2, 0x9e, 0x60, 0x67, 0x4e, 0x8b, 0x7e, 0x4f, 0x31, 0x66, 0xc5,
+  0xf9, 0xee, 0xd8, 0x7d, 0xe0, 0xd2, 0x86, 0x9c, 0xae, 0x4b, 0xb0, 0x33, 0x2e, 0x52, 0x82, 0x80,
+  0xb9, 0x60, 0x3c, 0xc4, 0xc9, 0x98, 0x07, 0xbe, 0x93, 0xc7, 0xfa, 0x6e, 0x81, 0x33, 0xe4, 0x2f,
+  0xb7, 0x36, 0x27, 0xfb, 0xb5, 0x36, 0x4a, 0xda, 0xe5, 0x98, 0x5b, 0xc6, 0x18, 0x44, 0xc2, 0x1a,
+  0xb2, 0x0a, 0x88, 0x2f, 0x95, 0xb4, 0xf5, 0x6a, 0xc5, 0x22, 0x1b, 0x1a, 0x0a, 0xbd, 0xe7, 0x5d,
+  0xce, 0x93, 0x7a, 0xc3, 0x5b, 0x73, 0x8e, 0x1e, 0xcd, 0xe7, 0x0e, 0xd8, 0xe1, 0x6c, 0x42, 0x5a,
+  0x51, 0x90, 0xec, 0xea, 0xb9, 0x43, 0x59, 0x48, 0xa1, 0xe1, 0x71, 0x79, 0xab, 0x7b, 0x07, 0xee,
+  0xd0, 0x1d, 0x35, 0xb9, 0xb7, 0xbf, 0xc3, 0xbd, 0xe3, 0xb6, 0x00, 0x6c, 0xc7, 0xf2, 0xa1, 0x3a,
+  0x98, 0xe9, 0x7f, 0x7a, 0x36, 0xea, 0x8f, 0xdc, 0xf6, 0x9e, 0x69, 0xc9, 0x1c, 0x9f, 0x12, 0xa3,
+  0xdc, 0x9d, 0x63, 0x1e, 0x76, 0x15, 0x4d, 0x2b, 0x9b, 0x8f, 0x5c, 0xab, 0xa1, 0x92, 0xb1, 0x95,
+  0x56, 0xb3, 0x24, 0xe2, 0x48, 0x47, 0x57, 0xee, 0x3d, 0x4a, 0xb4, 0x27, 0x63, 0x0d, 0x6d, 0x06,
+  0x00, 0xcd, 0x89, 0x5d, 0x6f, 0x89, 0x2e, 0x8e, 0xd2, 0x9d, 0xed, 0xc5, 0x91, 0xdc, 0x80, 0x5f,
+  0xe0, 0xa6, 0x34, 0xdd, 0xf4, 0x3a, 0xfe, 0x86, 0xd8, 0x01, 0x8d, 0xe3, 0xe9, 0x41, 0xae, 0xd9,
+  0x41, 0xb1, 0x09, 0x2e, 0x8f, 0xcb, 0x9d, 0x42, 0x69, 0x50, 0x25, 0x10, 0x3d, 0xfc, 0x41, 0xdb,
+  0x76, 0x1b, 0x88, 0x9b, 0xa7, 0x67, 0xbb, 0x80, 0x83, 0xd9, 0x37, 0x0c, 0x36, 0xf3, 0x89, 0xbf,
+  0x64, 0x44, 0xa0, 0x24, 0x59, 0xca, 0xf9, 0x60, 0x6a, 0x85, 0x85, 0x72, 0xdb, 0x24, 0x76, 0xb1,
+  0x39, 0x68, 0x91, 0x5e, 0xd0, 0x1d, 0x10, 0xdf, 0x49, 0x2f, 0x2f, 0x6d, 0x24, 0x97, 0xca, 0x7c,
+  0xc0, 0xb2, 0xa5, 0xd6, 0xb3, 0x65, 0xd1, 0xdc, 0xf7, 0x72, 0x61, 0xb8, 0x7d, 0x25, 0xee, 0x66,
+  0xa6, 0xb9, 0xc3, 0x5a, 0x79, 0x83, 0x77, 0x30, 0xfb, 0xfc, 0xea, 0xeb, 0x0f, 0x10, 0x30, 0x6d,
+  0xbf, 0xf2, 0x3e, 0x45, 0x4a, 0x20, 0x9f, 0x1e, 0xcc, 0x1e, 0xe7, 0xed, 0x8b, 0x70, 0x81, 0x65,
+  0x59, 0xfb, 0xf0, 0x2c, 0x8a, 0x9a, 0xaa, 0x73, 0x5a, 0x62, 0x71, 0x09, 0x1c, 0x7e, 0x24, 0x6e,
+  0x0f, 0x66, 0x17, 0x47, 0x72, 0xe0, 0xfd, 0x44, 0x2f, 0x95, 0x6e, 0x51, 0x3b, 0x5b, 0x16, 0x13,
+  0xe3, 0x3f, 0x6f, 0x35, 0x91, 0x73, 0x2d, 0x3e, 0xcc, 0x6b, 0x9e, 0x42, 0xa3, 0xa5, 0x2b, 0x39,
+  0x3b, 0x86, 0xcd, 0x3c, 0x0d, 0xae, 0x51, 0xc2, 0x45, 0xe2, 0x35, 0xb8, 0x5c, 0xcb, 0x24, 0xf5,
+  0xfb, 0xb5, 0x60, 0xa0, 0x8b, 0x93, 0x1d, 0x89, 0xf6, 0x81, 0x02, 0xc3, 0xd3, 0xe4, 0xe5, 0xca,
+  0x81, 0x8c, 0xfe, 0x00, 0x61, 0xe5, 0x44, 0x67, 0xb7, 0xb4, 0xfb, 0xb8, 0x44, 0xa9, 0x46, 0x1a,
+  0xe7, 0xcc, 0xfe, 0xf3, 0xb7, 0x3f, 0xff, 0x83, 0x3c, 0xca, 0x7b, 0xe8, 0x84, 0x9f, 0xe3, 0x09,
+  0x5f, 0xc4, 0x21, 0xa2, 0x85, 0xf1, 0x63, 0xdf, 0x91, 0x5a, 0xc8, 0x87, 0xb3, 0x06, 0x9b, 0x01,
+  0x9f, 0x3f, 0xfc, 0x89, 0x3c, 0x16, 0xc7, 0x8d, 0xe4, 0xf2, 0xaa, 0xca, 0x44, 0x9e, 0x42, 0x5e,
+  0x5e, 0xb5, 0x31, 0xda, 0x47, 0x1d, 0x59, 0xdc, 0x55, 0x2d, 0x56, 0xb3, 0x27, 0xd7, 0x57, 0xe3,
+  0xe1, 0x68, 0xa4, 0x85, 0xd2, 0x95, 0x76, 0x89, 0xf4, 0x32, 0x3d, 0xd0, 0xb4, 0x23, 0x7f, 0x95,
+  0x14, 0x74, 0xb0, 0x43, 0x23, 0xe8, 0x43, 0xc0, 0x0b, 0x32, 0x2d, 0x37, 0xee, 0x38, 0xe0, 0xc7,
+  0x85, 0xb1, 0xa6, 0x90, 0x56, 0xeb, 0x52, 0x73, 0x9d, 0x5f, 0xb8, 0xeb, 0x50, 0x6e, 0xa6, 0xd7,
+  0xc2, 0x9b, 0x2f, 0x00, 0xa2, 0x0d, 0xb5, 0x42, 0x82, 0x6f, 0xe2, 0x84, 0x84, 0x7c, 0x0b, 0x6c,
+  0x42, 0xb6, 0x25, 0x8f, 0x81, 0xd0, 0xa8, 0x9d, 0x35, 0x22, 0x0d, 0x22, 0x3c, 0x84, 0x3f, 0xd2,
+  0xf1, 0xad, 0x95, 0xf0, 0xa7, 0x1c, 0xb7, 0xf5, 0x2f, 0xe4, 0x53, 0x80, 0x1e, 0x75, 0x96, 0xc3,
+  0xed, 0xf5, 0x92, 0x85, 0x89, 0xb5, 0x60, 0xc9, 0x93, 0x80, 0xe1, 0xe5, 0xe7, 0xb7, 0x97, 0x8e,
+  0xd1, 0x29, 0x02, 0xb3, 0xd3, 0xb5, 0xb0, 0xb1, 0x7a, 0x24, 0x8f, 0x13, 0x51, 0x11, 0xc9, 0xcd,
+  0x82, 0x16, 0xd9, 0x4f, 0x8c, 0x0e, 0xe9, 0x74, 0xdf, 0xf4, 0xdf, 0xb6, 0x76, 0x02, 0xb9, 0x8e,
+  0xb1, 0xc7, 0xb7, 0xd7, 0x09, 0x4a, 0x9f, 0xc1, 0x72, 0x8f, 0xc8, 0x9c, 0xcd, 0x6e, 0x04, 0x56,
+  0xea, 0xf5, 0x97, 0x63, 0xa9, 0x94, 0x20, 0x47, 0xa3, 0xec, 0x92, 0xb0, 0xa3, 0xa8, 0x7a, 0x74,
+  0x44, 0xa4, 0x42, 0x04, 0x9d, 0x95, 0x76, 0xf8, 0xfb, 0x19, 0x23, 0x13, 0xb6, 0x66, 0x8a, 0x6c,
+  0x80, 0xcc, 0x48, 0x9f, 0x3c, 0x2c, 0x6e, 0xcf, 0x49, 0xc7, 0x34, 0x3b, 0x7b, 0x9a, 0xba, 0x0a,
+  0x5a, 0xb5, 0x35, 0x4a, 0xf6, 0xa9, 0x29, 0x74, 0x0d, 0xf6, 0x24, 0x9d, 0x7a, 0x61, 0xe9, 0x10,
+  0x1e, 0x06, 0xb7, 0xb0, 0x15, 0x65, 0x21, 0x11, 0x47, 0x55, 0xb2, 0x24, 0x31, 0xa7, 0x47, 0x18,
+  0x56, 0xff, 0xce, 0x33, 0x2e, 0x9f, 0xbb, 0xd8, 0x60, 0x76, 0x2a, 0x6c, 0x7d, 0x97, 0x18, 0x69,
+  0x21, 0x9b, 0x4e, 0xa7, 0xa4, 0x93, 0x6f, 0x9a, 0x3b, 0xaa, 0x5b, 0xf0, 0x53, 0x71, 0x8a, 0x22,
+  0xb9, 0x4e, 0xb0, 0xc9, 0x0e, 0x0e, 0x22, 0x7d, 0x9f, 0x51, 0xe8, 0x53, 0x60, 0x7e, 0x2a, 0x46,
+  0x21, 0x41, 0x75, 0xf6, 0x9d, 0x54, 0xe6, 0x3d, 0x85, 0xaa, 0xaa, 0xfe, 0x21, 0xf2, 0x88, 0x53,
+  0x00, 0x55, 0x96, 0xea, 0xc1, 0x4d, 0x0e, 0x09, 0x59, 0x48, 0x54, 0xa9, 0xdb, 0x90, 0x01, 0x3f,
+  0x65, 0x2c, 0xd8, 0x2f, 0xb3, 0x84, 0x81, 0x05, 0xa8, 0x35, 0xa0, 0x87, 0x6c, 0x9d, 0x5b, 0xb2,
+  0x26, 0xef, 0xd0, 0xd4, 0xc4, 0x11, 0x03, 0x96, 0x68, 0x78, 0xad, 0xfc, 0xe0, 0x16, 0xcd, 0x11,
+  0xf2, 0x90, 0x29, 0x66, 0x88, 0x59, 0x82, 0x52, 0xf3, 0x75, 0x62, 0x80, 0x1c, 0xd3, 0x99, 0xc6,
+  0x39, 0x8d, 0xec, 0xf6, 0x38, 0x09, 0x56, 0x8d, 0x8e, 0x07, 0xae, 0xdd, 0xfd, 0xa1, 0xe7, 0x51,
+  0x5e, 0xe3, 0x9e, 0xf2, 0xb8, 0x6e, 0xa8, 0xaa, 0x57, 0x5c, 0x0a, 0x16, 0xdd, 0x37, 0x85, 0x53,
+  0xc4, 0x51, 0x63, 0xad, 0x58, 0x90, 0x04, 0xb0, 0x22, 0xf9, 0xe9, 0x2f, 0x7f, 0x87, 0xd6, 0xb7,
+  0xf3, 0xbe, 0x5c, 0xf7, 0x09, 0x42, 0x8d, 0xee, 0x00, 0x10, 0x5f, 0xd0, 0x20, 0xc0, 0x9d, 0x24,
+  0x44, 0x7b, 0x44, 0xe6, 0x11, 0xdf, 0xc6, 0x2c, 0x8a, 0xc9, 0xd6, 0x4f, 0x3c, 0x34, 0xeb, 0x93,
+  0x0d, 0xac, 0x75, 0xcd, 0xd7, 0x91, 0x0d, 0xd0, 0x0b, 0x04, 0x02, 0x2f, 0x12, 0x8f, 0x11, 0x59,
+  0x85, 0x89, 0x47, 0xe3, 0x32, 0xb3, 0x90, 0x13, 0x37, 0x62, 0x0c, 0x32, 0x24, 0x62, 0x74, 0x49,
+  0xe2, 0x80, 0xc3, 0x16, 0x7e, 0xc5, 0x83, 0x40, 0xcc, 0x01, 0x38, 0xc5, 0x3d, 0x25, 0x18, 0x80,
+  0x40, 0x7f, 0xb8, 0xe2, 0x7e, 0x08, 0xdb, 0x2a, 0x1e, 0x02, 0x1b, 0x0a, 0x61, 0x01, 0x71, 0xe5,
+  0xd4, 0x9d, 0xe2, 0xb2, 0xc4, 0xf6, 0xa0, 0x9a, 0xd1, 0x9a, 0x2f, 0xae, 0x22, 0xbe, 0xf4, 0x01,
+  0x32, 0x40, 0x7e, 0xe3, 0x4d, 0x2d, 0x86, 0xc4, 0x3c, 0xa3, 0x73, 0x04, 0xd9, 0x85, 0x46, 0x07,
+  0xb1, 0x8d, 0x08, 0xa3, 0x2d, 0x12, 0x0e, 0x30, 0xba, 0xdd, 0x5e, 0xe3, 0x14, 0x09, 0xa7, 0xef,
+  0x3d, 0x2b, 0x77, 0x70, 0x7d, 0x56, 0x65, 0xd2, 0xdb, 0xea, 0xad, 0xa4, 0x37, 0xde, 0x80, 0xa0,
+  0x59, 0xa5, 0xcb, 0x8a, 0xdc, 0xdb, 0x86, 0xfc, 0x90, 0xe9, 0x9a, 0x97, 0x92, 0x29, 0x6c, 0x89,
+  0xa3, 0x98, 0x5d, 0x86, 0x09, 0xd6, 0xcc, 0x6e, 0x1d, 0xaf, 0xc0, 0x31, 0x9f, 0x89, 0x34, 0x62,
+  0x69, 0x8e, 0xf3, 0x14, 0xf3, 0x6d, 0x8f, 0x86, 0x0b, 0x56, 0xa3, 0x47, 0x7c, 0xcf, 0xb9, 0x7f,
+  0x04, 0x08, 0x9f, 0x81, 0xd5, 0xfd, 0xfb, 0x95, 0x7a, 0xd6, 0xad, 0x60, 0x8a, 0x06, 0x27, 0x35,
+  0xb5, 0x3c, 0x17, 0x55, 0xaa, 0xda, 0xcd, 0x0b, 0xba, 0x92, 0xb7, 0x8a, 0x91, 0x6c, 0x8a, 0x56,
+  0x96, 0x87, 0xab, 0x8d, 0x36, 0xe1, 0x80, 0x17, 0x82, 0xc4, 0x28, 0xa7, 0x95, 0x78, 0x72, 0xde,
+  0xe9, 0xc9, 0x8b, 0x06, 0x31, 0xd5, 0xbc, 0x57, 0xa5, 0x69, 0xcd, 0x22, 0xec, 0xe4, 0x30, 0xc8,
+  0x11, 0xd7, 0x44, 0x63, 0xb5, 0x0e, 0x82, 0x89, 0x06, 0x5f, 0x12, 0xb0, 0xd3, 0x15, 0xd0, 0x89,
+  0x2e, 0x4b, 0x45, 0x16, 0xb0, 0x79, 0xce, 0xa3, 0x4b, 0x22, 0x96, 0xac, 0xa3, 0x50, 0x39, 0x75,
+  0x29, 0x52, 0x41, 0x3d, 0xa2, 0x2d, 0xd6, 0x06, 0x78, 0xbd, 0xc4, 0x17, 0x95, 0xb0, 0x83, 0x30,
+  0xf2, 0x09, 0xe2, 0xad, 0xd3, 0x0e, 0x18, 0x84, 0x20, 0x79, 0x1e, 0x32, 0x00, 0xa1, 0x70, 0x61,
+  0x06, 0xfe, 0x06, 0x00, 0xae, 0xe8, 0xf7, 0x27, 0xe5, 0x94, 0x5f, 0xad, 0x63, 0x8f, 0xc5, 0xc2,
+  0x6d, 0x90, 0xb8, 0xa1, 0x43, 0xd8, 0x86, 0x45, 0xb7, 0x22, 0xa0, 0x1a, 0x74, 0xbe, 0x16, 0x68,
+  0xa0, 0x55, 0xf9, 0xa3, 0xad, 0x1f, 0x3a, 0xd0, 0x87, 0x96, 0x70, 0xa6, 0xa1, 0x87, 0x28, 0x99,
+  0xae, 0xee, 0x42, 0x9d, 0xb9, 0xee, 0xb4, 0x0d, 0xa2, 0xc0, 0x25, 0xd9, 0x23, 0x97, 0xd6, 0x84,
+  0xfc, 0x65, 0x78, 0x57, 0x6b, 0x09, 0xe5, 0x04, 0x8b, 0x3a, 0x8e, 0xa0, 0x7e, 0xea, 0xc7, 0x00,
+  0xdc, 0x2c, 0x92, 0xc8, 0xcb, 0x30, 0xa8, 0xda, 0x52, 0x54, 0xda, 0x68, 0x4a, 0x7e, 0x7d, 0xfd,
+  0xfc, 0x99, 0x25, 0x22, 0xdf, 0x60, 0x16, 0xd4, 0x6d, 0xda, 0x9a, 0x2c, 0x62, 0x96, 0x25, 0xf1,
+  0x40, 0x5c, 0x96, 0x51, 0x81, 0x59, 0x0d, 0xf9, 0xb2, 0xa7, 0xdc, 0xe8, 0x26, 0x10, 0x5b, 0x96,
+  0xde, 0x72, 0xfa, 0xea, 0x19, 0x40, 0xfd, 0x96, 0x39, 0x47, 0x9a, 0x8a, 0xf5, 0xee, 0xec, 0x49,
+  0xa3, 0xeb, 0xd1, 0xd3, 0xe7, 0xd7, 0x4f, 0x1e, 0x93, 0x25, 0xa3, 0x61, 0x5c, 0x8e, 0xa7, 0x88,
+  0xb9, 0xeb, 0x18, 0x37, 0x8b, 0x5e, 0x5e, 0x37, 0xc0, 0x4a, 0x0b, 0x8b, 0x9c, 0xf6, 0x8f, 0xf5,
+  0x9c, 0x38, 0x90, 0x46, 0x5b, 0xc0, 0xfe, 0xb2, 0x0b, 0x81, 0x4f, 0x1a, 0xb0, 0x58, 0x53, 0x88,
+  0x8f, 0xbf, 0xb6, 0xa1, 0x16, 0xdb, 0x52, 0xdd, 0xe0, 0x87, 0x73, 0x7b, 0x2d, 0x5d, 0x04, 0x20,
+  0x57, 0xe2, 0x65, 0x49, 0x59, 0xbb, 0xad, 0x71, 0x77, 0xb7, 0x2b, 0x9d, 0x4a, 0x18, 0x04, 0xcd,
+  0x35, 0xf5, 0x83, 0x98, 0xd0, 0x88, 0x09, 0x3d, 0x45, 0xef, 0xbd, 0x62, 0x91, 0x99, 0xda, 0x40,
+  0xec, 0xf7, 0x63, 0x99, 0x66, 0x2b, 0xba, 0x60, 0x28, 0x3e, 0x0b, 0xdc, 0x32, 0x37, 0x3f, 0xc6,
+  0x2a, 0x09, 0xd2, 0xfa, 0x76, 0x8f, 0xd8, 0xd4, 0x06, 0x24, 0x9f, 0x07, 0x90, 0x80, 0x31, 0x64,
+  0x7c, 0x43, 0xd9, 0xbc, 0x84, 0x5d, 0x7a, 0x2d, 0xeb, 0xb2, 0x7a, 0x85, 0x5b, 0xf8, 0x4e, 0xb7,
+  0x66, 0x9f, 0x4a, 0xf9, 0xfa, 0x2e, 0xe6, 0xa1, 0x5a, 0xbe, 0x0a, 0x22, 0x71, 0x24, 0xad, 0x8d,
+  0x89, 0xf6, 0x9e, 0x25, 0xf6, 0x9d, 0x5a, 0x1f, 0x84, 0xbc, 0x2c, 0x1c, 0x99, 0xbc, 0x1f, 0xb3,
+  0xec, 0x30, 0x40, 0xcf, 0xd0, 0x5f, 0xd5, 0xd9, 0xdd, 0x69, 0xd4, 0x51, 0xaa, 0x8b, 0x52, 0x4b,
+  0xd0, 0x8c, 0x6a, 0x15, 0xd9, 0x89, 0xa5, 0x78, 0x9a, 0x4a, 0xae, 0xae, 0xbe, 0x84, 0x7e, 0x88,
+  0x2f, 0xc9, 0x11, 0x1e, 0x9b, 0x9d, 0x43, 0xc3, 0x6a, 0x7b, 0xb2, 0x1d, 0x92, 0x80, 0x15, 0xcb,
+  0x40, 0x10, 0x91, 0x4f, 0x97, 0xab, 0x00, 0x60, 0x95, 0xba, 0xf8, 0xc6, 0x01, 0xa2, 0xb0, 0xcc,
+  0xcc, 0x5e, 0x47, 0x31, 0x88, 0x46, 0x31, 0x04, 0x1c, 0x16, 0x24, 0xd4, 0x64, 0xa1, 0xcd, 0x1d,
+  0x48, 0x1a, 0xf1, 0x8d, 0x03, 0x62, 0xc0, 0x3e, 0x55, 0x36, 0xc1, 0xf0, 0xd7, 0x0e, 0xd6, 0x0e,
+  0x13, 0x0b, 0xfe, 0xce, 0x83, 0xb4, 0xe7, 0xd1, 0xad, 0xe5, 0x15, 0x3a, 0x4b, 0x60, 0xc2, 0xd1,
+  0xd7, 0x02, 0x79, 0xc1, 0x54, 0xc3, 0x53, 0xe5, 0x54, 0x02, 0x47, 0xaf, 0x53, 0x79, 0xa6, 0xe4,
+  0xcd, 0xdb, 0xfa, 0xe8, 0x23, 0x29, 0x50, 0xe5, 0x3c, 0xa3, 0x1e, 0x84, 0x0e, 0x43, 0x21, 0x5f,
+  0x03, 0xbd, 0x31, 0x5f, 0xbb, 0x2e, 0xd6, 0x35, 0xdd, 0xbe, 0x63, 0x7e, 0x9b, 0x88, 0x85, 0x10,
+  0x93, 0x5f, 0x42, 0x4f, 0x38, 0xfe, 0x2c, 0x8a, 0xe8, 0x6d, 0x36, 0x45, 0x77, 0x86, 0x81, 0xdf,
+  0x50, 0x2b, 0x0e, 0x3a, 0xe8, 0x2b, 0xb8, 0xd5, 0x93, 0x8b, 0x4e, 0x06, 0xd9, 0x5b, 0x81, 0xd8,
+  0x3a, 0x93, 0x0b, 0xa8, 0x84, 0xe4, 0xc7, 0x1f, 0xe5, 0x9a, 0x6f, 0xfa, 0x6f, 0x45, 0x7b, 0x33,
+  0xc8, 0xea, 0xad, 0x52, 0xb9, 0x8b, 0x05, 0x5d, 0x3f, 0x8a, 0x93, 0x6b, 0xf6, 0x7b, 0x58, 0x14,
+  0xd7, 0xc6, 0x30, 0x44, 0x49, 0x8f, 0x87, 0xc6, 0x49, 0x4f, 0x6c, 0xce, 0xb4, 0x62, 0xda, 0xb0,
+  0x7f, 0x4c, 0x94, 0x29, 0x83, 0x91, 0x31, 0x6e, 0x99, 0x22, 0x81, 0x40, 0xb1, 0x7a, 0xa6, 0x89,
+  0xe4, 0x27, 0x1a, 0xaf, 0x7a, 0xce, 0xc9, 0x26, 0x04, 0xa7, 0x0e, 0x86, 0x13, 0xed, 0xe8, 0x26,
+  0xed, 0x16, 0x33, 0x71, 0x2e, 0x85, 0x34, 0x83, 0xbe, 0x56, 0x1c, 0xfc, 0x48, 0x61, 0x2c, 0x2c,
+  0xf8, 0x86, 0xb8, 0xd6, 0xd0, 0xe0, 0xae, 0xc1, 0x10, 0x47, 0x59, 0xb8, 0xf2, 0x04, 0x7e, 0x5d,
+  0x48, 0xbd, 0xe1, 0xf2, 0xf0, 0xb0, 0xdb, 0x00, 0x0e, 0x38, 0xe1, 0xfb, 0xef, 0x31, 0x7e, 0xa0,
+  0xaa, 0x79, 0xbe, 0x9b, 0xc8, 0xcb, 0x79, 0x53, 0xf6, 0x37, 0xb0, 0x11, 0x6f, 0xb2, 0x70, 0x0b,
+  0x2d, 0xbc, 0x09, 0xda, 0x1f, 0x1e, 0xbe, 0x9d, 0x34, 0x52, 0xc2, 0x82, 0x3f, 0x42, 0x1d, 0x9b,
+  0x93, 0xfb, 0xa4, 0x7f, 0x73, 0xe6, 0x76, 0xc9, 0xc5, 0x85, 0x5c, 0xbc, 0x79, 0x8a, 0x94, 0xed,
+  0x70, 0x4a, 0xce, 0xf4, 0x34, 0x77, 0xf8, 0x2e, 0x1f, 0x50, 0x38, 0x65, 0x3a, 0xee, 0x77, 0xf5,
+  0x74, 0xd2, 0xf4, 0xc0, 0xc7, 0x00, 0x21, 0x66, 0xb3, 0x19, 0x86, 0xdc, 0x6f, 0x89, 0x89, 0x77,
+  0xf7, 0xc9, 0xa0, 0x6d, 0xd2, 0x0e, 0xf3, 0xdf, 0xb5, 0xb4, 0x3c, 0x69, 0x4c, 0xff, 0x20, 0x5f,
+  0x32, 0xcb, 0x3c, 0x78, 0x33, 0x78, 0x2b, 0x56, 0x14, 0x71, 0x0f, 0x16, 0x0f, 0x01, 0x34, 0xcf,
+  0x8b, 0xf0, 0x3e, 0x94, 0xbe, 0xeb, 0x65, 0x71, 0x78, 0xb7, 0xdf, 0xce, 0xd9, 0x89, 0xe8, 0x56,
+  0xa4, 0xb9, 0x3e, 0xc1, 0xd3, 0x37, 0x03, 0x2d, 0x27, 0x0b, 0xc5, 0xdb, 0x89, 0x8e, 0x3e, 0x93,
+  0x92, 0x1b, 0x98, 0x2e, 0xf9, 0xe0, 0x64, 0x81, 0xf3, 0xb0, 0xb5, 0xea, 0x0c, 0x9d, 0xda, 0x04,
+  0x49, 0x24, 0x5e, 0x27, 0x16, 0x73, 0xec, 0x00, 0xbf, 0x9d, 0xf9, 0x1a, 0x1f, 0x6a, 0xc9, 0xe5,
+  0xb7, 0x00, 0x54, 0xfa, 0xaf, 0xc4, 0x53, 0x65, 0x42, 0x72, 0x03, 0xa3, 0xd0, 0x33, 0x7d, 0x03,
+  0xb5, 0xdd, 0xc0, 0x6f, 0x03, 0xf5, 0x2a, 0x6b, 0xf6, 0xaa, 0x2c, 0x35, 0x80, 0x54, 0x82, 0xd7,
+  0x02, 0x96, 0x86, 0xfa, 0x9e, 0x5f, 0xaa, 0x1f, 0x40, 0x9d, 0x25, 0x5f, 0xd3, 0xc4, 0xb3, 0x96,
+  0x7e, 0x68, 0x58, 0x96, 0x55, 0x62, 0xa1, 0xb5, 0x97, 0xe7, 0xe7, 0x13, 0xe8, 0xcd, 0x3e, 0x13,
+  0xe2, 0x15, 0x0d, 0xcb, 0x53, 0x80, 0x81, 0x09, 0xcb, 0xf6, 0x6a, 0xc1, 0x89, 0xea, 0xe3, 0x99,
+  0xfb, 0x3b, 0x76, 0x8d, 0xe7, 0x33, 0x78, 0xdc, 0x90, 0xbe, 0xf2, 0xef, 0xd4, 0x09, 0xf1, 0xbb,
+  0x44, 0xaf, 0x53, 0x47, 0x0c, 0xeb, 0xc3, 0x73, 0xb6, 0xf0, 0xc3, 0x2b, 0x58, 0x52, 0x6d, 0xad,
+  0xca, 0x16, 0x02, 0x80, 0x79, 0x02, 0x65, 0xd3, 0x30, 0x36, 0x3d, 0xe2, 0xb7, 0x6e, 0x88, 0x31,
+  0x44, 0x7c, 0xf2, 0x69, 0x35, 0x02, 0x8e, 0xa4, 0xbd, 0xd3, 0x62, 0x67, 0x6a, 0x93, 0x4d, 0x4e,
+  0xbf, 0x2d, 0xbc, 0x9f, 0x46, 0x83, 0x49, 0x4e, 0xe0, 0x9f, 0xb1, 0x11, 0xa6, 0xe8, 0x02, 0x67,
+  0x43, 0x1d, 0x1f, 0x77, 0x61, 0x01, 0xb4, 0xdd, 0x44, 0xdb, 0x68, 0xfa, 0xa2, 0xb1, 0x04, 0xb8,
+  0x46, 0x6d, 0x97, 0x7c, 0xc3, 0x5e, 0x70, 0xe3, 0xa6, 0x47, 0x6e, 0xbb, 0x13, 0x79, 0x2e, 0x99,
+  0xd9, 0x28, 0x7f, 0xdc, 0xda, 0xd3, 0x17, 0xa6, 0xdf, 0xf7, 0xc8, 0x4f, 0xf4, 0x7a, 0xda, 0xc4,
+  0xcc, 0xba, 0x40, 0xb4, 0xcd, 0xc3, 0x18, 0x9a, 0x06, 0x36, 0xed, 0x40, 0xf6, 0x17, 0xb5, 0x7d,
+  0x47, 0x67, 0x48, 0xb1, 0x44, 0x7f, 0x2e, 0x4a, 0x6e, 0x73, 0x83, 0x28, 0x4b, 0x72, 0x73, 0x8b,
+  0x98, 0xd6, 0xd6, 0x48, 0x1e, 0x5b, 0xd5, 0xbb, 0x05, 0x3d, 0x2c, 0x8a, 0x6d, 0xa3, 0x98, 0xa4,
+  0x4f, 0x99, 0x32, 0x9d, 0x20, 0xb3, 0x00, 0xff, 0xba, 0x2d, 0x4d, 0x4d, 0x43, 0xe4, 0x01, 0x55,
+  0x39, 0x0e, 0x41, 0x58, 0x68, 0x13, 0x53, 0x8e, 0x12, 0x1e, 0xbb, 0x56, 0x1c, 0x40, 0xf7, 0x69,
+  0x98, 0x45, 0x84, 0x75, 0x9b, 0xd9, 0xe6, 0x3d, 0x93, 0x64, 0x81, 0xc8, 0xdb, 0x50, 0xee, 0x72,
+  0x34, 0xfd, 0x25, 0xba, 0x57, 0xe4, 0xf4, 0xde, 0xdd, 0x2b, 0x1e, 0xf6, 0xe0, 0x17, 0xbb, 0x44,
+  0x6b, 0x8a, 0xa7, 0x3f, 0xd8, 0x36, 0x01, 0xf6, 0xac, 0xb1, 0x53, 0x93, 0x1d, 0x6d, 0xda, 0x5b,
+  0x42, 0xfd, 0xe6, 0xd0, 0x95, 0x46, 0x2c, 0xe0, 0xd4, 0x01, 0x80, 0x67, 0x71, 0xd8, 0x49, 0xca,
+  0xac, 0xc4, 0x16, 0x8a, 0xcc, 0x03, 0x1a, 0xbe, 0x9b, 0x88, 0xbd, 0x0d, 0x6e, 0xfe, 0x22, 0xbe,
+  0x5e, 0x78, 0xe4, 0x5b, 0xb4, 0xc1, 0xb7, 0xf2, 0x4c, 0x11, 0x36, 0x9a, 0xc0, 0x24, 0x5e, 0x81,
+  0xf0, 0xe2, 0xab, 0x61, 0x1d, 0x00, 0x31, 0x1e, 0x38, 0xb0, 0x11, 0x52, 0x5a, 0x57, 0xf1, 0x6e,
+  0x39, 0xef, 0x5d, 0x2b, 0xdf, 0x15, 0xc4, 0xae, 0x42, 0x0c, 0xbf, 0xd2, 0x75, 0x51, 0xf9, 0xe8,
+  0x33, 0x3c, 0x80, 0x54, 0x4f, 0x69, 0xf4, 0x45, 0xed, 0x05, 0xd2, 0x7f, 0x70, 0x55, 0x2b, 0xbd,
+  0x06, 0xff, 0x3f, 0x2f, 0x6b, 0x52, 0x1d, 0xdc, 0x50, 0xc3, 0x46, 0x39, 0x16, 0x2f, 0x2c, 0x72,
+  0x37, 0x58, 0xf2, 0xbb, 0xd6, 0x00, 0xa3, 0x10, 0x9c, 0x1b, 0xd1, 0xbe, 0xd6, 0x6b, 0x62, 0x36,
+  0xf5, 0x43, 0x0b, 0x62, 0x36, 0xbf, 0x0b, 0xa0, 0x7c, 0xba, 0x57, 0x45, 0x2c, 0x66, 0x1c, 0xd6,
+  0x66, 0x68, 0x6a, 0xdc, 0x98, 0x9d, 0x9c, 0x50, 0xe7, 0x17, 0xac, 0x71, 0x18, 0x8e, 0x18, 0x62,
+  0xf8, 0xee, 0x4b, 0xfb, 0x2a, 0xa1, 0x62, 0xc2, 0x3d, 0x8a, 0x20, 0x9a, 0x71, 0x93, 0x15, 0x9c,
+  0x1f, 0x1a, 0x91, 0xa5, 0x71, 0xbd, 0xb6, 0xb3, 0xb4, 0x7a, 0x73, 0x59, 0x2d, 0xbb, 0x46, 0x39,
+  0x2b, 0xcd, 0x8a, 0xe8, 0xa9, 0x43, 0x0f, 0x51, 0xee, 0x7a, 0x6d, 0xae, 0xce, 0xfb, 0x1f, 0x14,
+  0xe7, 0xac, 0x93, 0xe9, 0xea, 0x2b, 0x74, 0x6a, 0x91, 0x6e, 0xbd, 0x14, 0x17, 0x15, 0xba, 0x52,
+  0xb8, 0xef, 0x35, 0xdb, 0xb4, 0xfe, 0x92, 0xee, 0x17, 0xaa, 0xe0, 0x7a, 0x14, 0xca, 0x4a, 0x78,
+  0x0a, 0xc4, 0x0f, 0x01, 0x3d, 0xa7, 0xf2, 0x2d, 0x0a, 0x56, 0x72, 0xa3, 0x04, 0x75, 0x53, 0x09,
+  0x76, 0xe4, 0x21, 0xe9, 0x74, 0xf0, 0xc5, 0xf3, 0x7d, 0x44, 0x70, 0x51, 0xef, 0x73, 0xa2, 0xee,
+  0xcf, 0x3a, 0x09, 0xf2, 0x9a, 0x6b, 0x7c, 0x15, 0x8f, 0xcb, 0x81, 0x91, 0x16, 0x54, 0x0f, 0x4f,
+  0x3a, 0xf3, 0x4a, 0x5a, 0x8a, 0x87, 0x86, 0x52, 0x5a, 0x86, 0x70, 0x4f, 0x54, 0x51, 0xb1, 0x97,
+  0x59, 0x87, 0x0e, 0x73, 0xc1, 0x7f, 0x0e, 0x68, 0x99, 0x3e, 0x3e, 0x87, 0x0b, 0x51, 0xab, 0x0e,
+  0x89, 0x58, 0x24, 0x0d, 0xc5, 0xe6, 0xa2, 0x9b, 0xda, 0xb9, 0xb9, 0x9d, 0xd0, 0xad, 0xd7, 0xad,
+  0xf8, 0xe8, 0x97, 0xa8, 0xd8, 0x5f, 0x49, 0x87, 0xbe, 0x5f, 0xd1, 0x2e, 0x9f, 0xfb, 0x17, 0xef,
+  0x86, 0x6b, 0x07, 0xff, 0xb5, 0xd7, 0x03, 0xd8, 0x1e, 0xf4, 0xc8, 0x69, 0x3b, 0x91, 0x50, 0x4e,
+  0x50, 0x95, 0xc9, 0xca, 0x55, 0xfe, 0x52, 0xfe, 0x67, 0x40, 0x82, 0x5d, 0xc0, 0xbd, 0x4a, 0x84,
+  0xca, 0x43, 0xc8, 0x49, 0xf5, 0x61, 0xcd, 0x5a, 0x95, 0xf7, 0x04, 0xc5, 0xe3, 0xfa, 0x5b, 0xee,
+  0x8b, 0xa3, 0xec, 0x0b, 0x36, 0x17, 0x47, 0xf2, 0x1b, 0x95, 0x17, 0x47, 0xf2, 0x7f, 0x3e, 0xfe,
+  0x17, 0xdb, 0xe6, 0x53, 0xa6, 0x0a, 0x39, 0x00, 0x00,
+};
+
+#endif // DASHBOARD_HTML_H
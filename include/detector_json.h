@@ -0,0 +1,49 @@
+#ifndef DETECTOR_JSON_H
+#define DETECTOR_JSON_H
+
+#include <Arduino.h>
+#include "acquisition.h"
+#include "heart_rate.h"
+#include "text_buffer.h"
+
+/*
+ * Detector state as JSON
+ * ======================
+ * The acquisition and detector members of the /data object, written into a
+ * TextBuffer without any allocation. Kept apart from the web server so the
+ * native build can format it in its allocation check.
+ */
+
+/**
+ * Append the detector members (no enclosing braces, trailing comma)
+ */
+void detectorJson(TextBuffer& b) {
+  textPrintf(b, "\"bpm\":%d,\"signal\":%d,\"detected\":%s,",
+             pulseDetected ? beatsPerMinute : 0, signalValue, pulseDetected ? "true" : "false");
+  textPrintf(b, "\"hrv\":{\"meanIbiMs\":%.1f,\"sdnnMs\":%.1f,\"rmssdMs\":%.1f,\"pnn50\":%.1f,"
+             "\"window\":%u,\"accepted\":%u,\"rejected\":%u},",
+             beatStatsMeanUs(beatStats) / 1000.0f, beatStatsSdnnMs(beatStats),
+             beatStatsRmssdMs(beatStats), beatStatsPnn50(beatStats), (unsigned)beatStats.count,
+             (unsigned)beatStats.accepted, (unsigned)beatStats.rejected);
+  textPrintf(b, "\"acq\":{\"samples\":%u,\"reads\":%u,\"overruns\":%u,\"ringLevel\":%u,"
+             "\"isrCyclesLast\":%u,\"isrCyclesMax\":%u},",
+             (unsigned)acqTick, (unsigned)acqReads, (unsigned)acqRing.overruns,
+             (unsigned)sampleRingLevel(acqRing), (unsigned)acqIsrCyclesLast, (unsigned)acqIsrCyclesMax);
+  textPrintf(b, "\"detector\":{\"filtered\":%d,\"envelope\":%d,\"cyclesPerSample\":%u},",
+             (int)filteredValue, (int)envelopeValue, (unsigned)detectorCyclesPerSample);
+  textPrintf(b, "\"spectral\":{\"bpm\":%.1f,\"confidence\":%u,\"harmonic\":%s},"
+             "\"fused\":{\"bpm\":%d,\"source\":\"%s\",\"agree\":%s},",
+             spectralEstimator.bpmX10 / 10.0f, (unsigned)spectralEstimator.confidence,
+             spectralEstimator.harmonic ? "true" : "false", fusedBpm, hrSourceName(hrSource),
+             hrEstimatesAgree ? "true" : "false");
+  textPrintf(b, "\"quality\":{\"index\":%d,\"adequate\":%s,\"perfusion\":%d,\"perfusionIndex\":%.2f,"
+             "\"correlation\":%d,\"beatCorrelation\":%d,\"clipping\":%d,\"consistency\":%d},",
+             signalQualityIndex, signalQualityAdequate() ? "true" : "false", signalQuality.perfusion,
+             signalQuality.perfusionIndex / 100.0f, signalQuality.correlation, signalQuality.beatCorrelation,
+             signalQuality.clipping, signalQuality.consistency);
+  textPrintf(b, "\"timing\":{\"sampleUs\":%u,\"readUs\":%u,\"interpolated\":%s,\"ibiUs\":%u},",
+             (unsigned)sampleIntervalUs, (unsigned)acqReadIntervalUs,
+             HR_PEAK_INTERPOLATION ? "true" : "false", (unsigned)beatIntervalUs);
+}
+
+#endif // DETECTOR_JSON_H
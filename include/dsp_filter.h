@@ -0,0 +1,114 @@
+#ifndef DSP_FILTER_H
+#define DSP_FILTER_H
+
+#include <stdint.h>
+
+/*
+ * Fixed-point biquad filters
+ * ==========================
+ * Second-order IIR sections with Q14 coefficients (range +/-2, enough for
+ * the a1 term of low-cutoff sections) and 32-bit integer state, so the
+ * per-sample cost is five integer multiplies and no float on the ESP8266.
+ *
+ * Direct Form I with first-order error feedback: the bits dropped by the
+ * final >> 14 are carried into the next sample. Without it, the 0.5 Hz
+ * high-pass section (poles at ~0.96 at 50 Hz) accumulates a visible DC
+ * error from truncation.
+ *
+ * Headroom: inputs are expected within +/-8192 (10-bit ADC minus midscale,
+ * scaled by 8), so each coefficient*state product stays below 2^28 and the
+ * five-term sum fits an int32.
+ */
+
+const int biquadShift = 14;
+const int32_t biquadOne = 1 << biquadShift;
+
+/**
+ * Coefficients are computed at compile time and shared by every channel
+ * stepping the same design; only BiquadState is per channel.
+ */
+struct BiquadCoeffs {
+  int16_t b0, b1, b2;   // Feed-forward coefficients, Q14
+  int16_t a1, a2;       // Feedback coefficients, Q14 (a0 normalised to 1)
+};
+
+struct BiquadState {
+  int32_t x1, x2;       // Previous inputs
+  int32_t y1, y2;       // Previous outputs
+  int32_t err;          // Truncation remainder fed back into the next sample
+};
+
+enum BiquadType { BIQUAD_LOWPASS, BIQUAD_HIGHPASS };
+
+// constexpr stand-ins for the libm calls the design needs
+
+constexpr double dspPi = 3.14159265358979323846;
+
+/**
+ * sin(x) by Taylor series after reducing x to [-pi, pi]
+ */
+constexpr double dspSin(double x) {
+  while (x > dspPi) x -= 2 * dspPi;
+  while (x < -dspPi) x += 2 * dspPi;
+  double term = x, sum = x;
+  for (int n = 1; n < 14; n++) {
+    term *= -x * x / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double dspCos(double x) {
+  return dspSin(x + dspPi / 2);
+}
+
+constexpr int16_t biquadQ14(double v) {
+  return (int16_t)(v >= 0 ? (long)(v * biquadOne + 0.5) : -(long)(-v * biquadOne + 0.5));
+}
+
+/**
+ * Design a Butterworth (Q = 1/sqrt(2)) low- or high-pass section using the
+ * RBJ cookbook formulas. constexpr, so a fixed design costs nothing at run
+ * time.
+ * @param cutoffHz Corner frequency
+ * @param sampleHz Rate the section will be stepped at
+ */
+constexpr BiquadCoeffs biquadDesign(BiquadType type, double cutoffHz, double sampleHz) {
+  double w0 = 2.0 * dspPi * cutoffHz / sampleHz;
+  double cosw = dspCos(w0);
+  double alpha = dspSin(w0) / (2.0 * 0.70710678118654752440);
+  double a0 = 1.0 + alpha;
+  double b0 = type == BIQUAD_LOWPASS ? (1.0 - cosw) / 2.0 : (1.0 + cosw) / 2.0;
+  double b1 = type == BIQUAD_LOWPASS ? 1.0 - cosw : -(1.0 + cosw);
+  return BiquadCoeffs{biquadQ14(b0 / a0), biquadQ14(b1 / a0), biquadQ14(b0 / a0),
+                      biquadQ14(-2.0 * cosw / a0), biquadQ14((1.0 - alpha) / a0)};
+}
+
+/**
+ * Preload the state as if the input had been constant at x forever, so a
+ * filter started on a DC-offset signal doesn't ring on its first sample
+ */
+inline void biquadPrime(const BiquadCoeffs& c, BiquadState& s, int32_t x) {
+  int32_t dcGain = ((int32_t)c.b0 + c.b1 + c.b2) * biquadOne /
+                   (biquadOne + c.a1 + c.a2);
+  s.x1 = s.x2 = x;
+  s.y1 = s.y2 = (x * dcGain) >> biquadShift;
+  s.err = 0;
+}
+
+/**
+ * Filter one sample
+ */
+inline int32_t biquadStep(const BiquadCoeffs& c, BiquadState& s, int32_t x) {
+  int32_t acc = (int32_t)c.b0 * x + (int32_t)c.b1 * s.x1 + (int32_t)c.b2 * s.x2
+              - (int32_t)c.a1 * s.y1 - (int32_t)c.a2 * s.y2 + s.err;
+  int32_t y = acc >> biquadShift;
+  s.err = acc & (biquadOne - 1);
+  s.x2 = s.x1;
+  s.x1 = x;
+  s.y2 = s.y1;
+  s.y1 = y;
+  return y;
+}
+
+#endif // DSP_FILTER_H
@@ -0,0 +1,210 @@
+#ifndef HEART_RATE_H
+#define HEART_RATE_H
+
+#include <Arduino.h>
+#include "sample_ring.h"
+#include "heart_rate_detector.h"
+#include "spectral_hr.h"
+#include "signal_quality.h"
+#include "wave_history.h"
+#include "bpm_history.h"
+#include "beat_events.h"
+
+/*
+ * Pulse sensor beat detector
+ * ==========================
+ * The firmware's single-sensor instance of HeartRateDetector
+ * (heart_rate_detector.h). It only consumes samples from a SampleRing, so
+ * the same code runs on the ESP8266 (fed by the timer1 ISR) and on the
+ * host (fed by the replay engine in src/host).
+ *
+ * The names below alias channel 0 of the instance, so the web server,
+ * MQTT, alerts and the replay tool read the detector as before.
+ *
+ * The filtered signal also feeds a spectral estimator (spectral_hr.h).
+ * readHeartRate() reports the beat-based BPM while beats keep arriving,
+ * and falls back to a confident spectral estimate once they stop (more
+ * than 2.5 mean intervals, and at least 3 s, since the last beat), rather
+ * than holding the last value. hrSource says which one is being reported.
+ *
+ * signalQualityIndex (0-100, signal_quality.h) rates the reported value:
+ * for beats, the mean of perfusion, beat shape and rhythm capped by
+ * clipping; for the spectrum, the weaker of clipping and spectral
+ * confidence; 0 with no reading. Publishers use it to hold back readings
+ * not worth sending.
+ *
+ * Each second's reading, when adequate, also goes into bpmHistory
+ * (bpm_history.h) for /history, and every beat into beatEvents
+ * (beat_events.h), which is how consumers see individual beats.
+ */
+
+// ========================= DETECTOR CONFIGURATION =========================
+const int sampleIntervalMs = 20;   // Sample every 20ms (50Hz)
+const uint32_t sampleIntervalUs = sampleIntervalMs * 1000UL;
+const int sampleBatch = 16;        // Ring slots drained per pass in readHeartRate()
+
+typedef HeartRateDetector<1000 / sampleIntervalMs> PulseDetector;
+PulseDetector heartRateDetector;
+
+// ========================= DETECTOR STATE =========================
+uint32_t& lastBeatTimeUs = heartRateDetector.beats[0].lastBeatTimeUs;
+uint32_t& beatIntervalUs = heartRateDetector.beats[0].beatIntervalUs;
+unsigned long& beatInterval = heartRateDetector.beats[0].beatInterval;
+uint32_t& beatCount = heartRateDetector.beats[0].beatCount;
+int& beatsPerMinute = heartRateDetector.beats[0].bpm;
+bool& pulseDetected = heartRateDetector.beats[0].pulseDetected;
+BeatStats& beatStats = heartRateDetector.beats[0].stats;
+int& signalValue = heartRateDetector.channel[0].signal;
+int32_t& filteredValue = heartRateDetector.channel[0].filtered;
+int32_t& envelopeValue = heartRateDetector.channel[0].envelope;
+uint32_t& lastSampleTick = heartRateDetector.tick;
+
+// Spectral fallback and the fused rate readHeartRate() reports
+#ifndef SPECTRAL_MIN_CONFIDENCE
+#define SPECTRAL_MIN_CONFIDENCE 500  // Confidence (permille, see spectral_hr.h) to trust it
+#endif
+
+enum HrSource { HR_SOURCE_NONE, HR_SOURCE_BEATS, HR_SOURCE_SPECTRUM };
+
+const uint32_t beatStaleMinUs = 3000000;
+const int bpmAgreePercent = 10;    // Estimates this close (or within 5 BPM) agree
+
+SpectralEstimator<1000 / sampleIntervalMs> spectralEstimator;
+int fusedBpm = 0;
+HrSource hrSource = HR_SOURCE_NONE;
+bool hrEstimatesAgree = false;     // Both estimates valid and close
+
+// Sample tick of the last beat, updated when beatCount moves
+uint32_t fuseBeatCount = 0;
+uint32_t fuseBeatTick = 0;
+
+SignalQuality<1000 / sampleIntervalMs> signalQuality;
+int signalQualityIndex = 0;        // Quality of fusedBpm, 0-100
+
+// Detector cost, measured around each ring drain
+uint32_t detectorCyclesPerSample = 0;
+uint32_t detectorCyclesTotal = 0;  // Wraps; diff it for a per-second budget
+
+// ========================= HEART RATE FUNCTIONS =========================
+
+/**
+ * Clear all detector state, e.g. at boot or between replayed recordings
+ */
+void heartRateReset() {
+  detectorReset(heartRateDetector);
+  spectralReset(spectralEstimator);
+  fusedBpm = 0;
+  hrSource = HR_SOURCE_NONE;
+  hrEstimatesAgree = false;
+  fuseBeatCount = 0;
+  fuseBeatTick = 0;
+  sqiReset(signalQuality);
+  signalQualityIndex = 0;
+  waveHistoryReset(waveHistory);
+  historyReset(bpmHistory);
+  beatEventsReset(beatEvents);
+  detectorCyclesPerSample = 0;
+  detectorCyclesTotal = 0;
+}
+
+inline const char* hrSourceName(HrSource source) {
+  return source == HR_SOURCE_BEATS ? "beats" : (source == HR_SOURCE_SPECTRUM ? "spectrum" : "none");
+}
+
+/**
+ * Spectral estimate in BPM if it is confident enough to report, else 0
+ */
+inline int spectralBpm() {
+  return spectralEstimator.confidence >= SPECTRAL_MIN_CONFIDENCE ? (spectralEstimator.bpmX10 + 5) / 10 : 0;
+}
+
+/**
+ * Pick the rate to report: beats while they are current, else the
+ * spectrum if it is confident, else nothing; then rate its quality
+ */
+void heartRateFuse() {
+  // Age of the last beat in sample ticks, as in alertsCheck(): the us
+  // timestamps wrap after ~71 minutes, but a new beat is fused at once, so
+  // its us difference is still exact
+  if (beatCount != fuseBeatCount) {
+    fuseBeatCount = beatCount;
+    uint32_t nowUs = lastSampleTick * sampleIntervalUs;
+    fuseBeatTick = lastSampleTick - (nowUs - lastBeatTimeUs) / sampleIntervalUs;
+  }
+  uint64_t sinceBeatUs = (uint64_t)(lastSampleTick - fuseBeatTick) * sampleIntervalUs;
+  uint32_t staleUs = max(beatStaleMinUs, beatStatsMeanUs(beatStats) * 5 / 2);
+  bool beatsCurrent = pulseDetected && sinceBeatUs < staleUs;
+  int spectral = spectralBpm();
+
+  if (beatsCurrent) {
+    fusedBpm = beatsPerMinute;
+    hrSource = HR_SOURCE_BEATS;
+  } else if (spectral) {
+    fusedBpm = spectral;
+    hrSource = HR_SOURCE_SPECTRUM;
+  } else {
+    fusedBpm = 0;
+    hrSource = HR_SOURCE_NONE;
+  }
+  int diff = abs(beatsPerMinute - spectral);
+  hrEstimatesAgree = beatsCurrent && spectral &&
+                     (diff <= 5 || diff * 100 <= beatsPerMinute * bpmAgreePercent);
+
+  int32_t quality = 0;
+  if (hrSource == HR_SOURCE_BEATS) {
+    quality = sqiBeatScore(signalQuality);
+  } else if (hrSource == HR_SOURCE_SPECTRUM) {
+    quality = min<int32_t>(signalQuality.clipping, spectralEstimator.confidence);
+  }
+  signalQualityIndex = (quality + 5) / 10;
+}
+
+/**
+ * True if the reported rate is good enough to publish (SQI_MIN)
+ */
+inline bool signalQualityAdequate() {
+  return fusedBpm > 0 && signalQualityIndex >= SQI_MIN;
+}
+
+/**
+ * Drain a sample ring and run every pending sample through the detector,
+ * the spectral estimator and the quality measures. Sample times come from
+ * the producer's tick, not from millis(), so they carry no loop() jitter.
+ * @return fused BPM (see heartRateFuse()), 0 without a valid reading
+ */
+int readHeartRate(SampleRing& ring) {
+  uint32_t batch[sampleBatch];
+  uint16_t count;
+
+  while ((count = sampleRingPop(ring, batch, sampleBatch)) > 0) {
+    uint32_t start = ESP.getCycleCount();
+    for (uint16_t i = 0; i < count; i++) {
+      lastSampleTick = sampleRingTick(batch[i], lastSampleTick);
+      int32_t sample = sampleRingValue(batch[i]);
+      uint32_t accepted = beatStats.accepted;
+      detectorProcessFrame(heartRateDetector, lastSampleTick, &sample);
+      spectralPush(spectralEstimator, filteredValue);
+      sqiPush(signalQuality, heartRateDetector, 0);
+      waveHistoryPush(waveHistory, lastSampleTick, sample);
+      if (beatCount != beatEvents.nextSeq - 1) {
+        // The peak was the sample before this one. Re-fuse so the quality
+        // flag rates the reading that includes this beat, not the last one.
+        heartRateFuse();
+        beatEventPush(beatEvents, lastBeatTimeUs, beatCount > 1 ? beatIntervalUs : 0,
+                      heartRateDetector.channel[0].prevFiltered,
+                      (beatStats.accepted != accepted ? beatEventAccepted : 0) |
+                      (signalQualityAdequate() ? beatEventQuality : 0));
+      }
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    detectorCyclesPerSample = cycles / count;
+    detectorCyclesTotal += cycles;
+  }
+
+  // Return current BPM or 0 if no valid reading
+  heartRateFuse();
+  historyAdd(bpmHistory, lastSampleTick / (1000 / sampleIntervalMs), signalQualityAdequate() ? fusedBpm : 0);
+  return fusedBpm;
+}
+
+#endif // HEART_RATE_H
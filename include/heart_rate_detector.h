@@ -0,0 +1,244 @@
+#ifndef HEART_RATE_DETECTOR_H
+#define HEART_RATE_DETECTOR_H
+
+#include <Arduino.h>
+#include "dsp_filter.h"
+#include "beat_stats.h"
+
+/*
+ * Multi-channel beat detector
+ * ===========================
+ * HeartRateDetector<SampleRateHz, Channels, StatsWindow, MedianWindow>
+ * holds everything the detector needs, for a fixed number of channels:
+ * several sensors behind an analog multiplexer, or one sensor fed to
+ * several differently configured instances side by side. Nothing is global
+ * or function-static, so instances are independent.
+ *
+ * Pipeline per sample and channel, all integer:
+ *   ADC -> 0.5 Hz high-pass -> 4 Hz low-pass (Q14 biquads, dsp_filter.h)
+ *       -> slope sign change (local maximum)
+ *       -> accept if above half the decaying envelope and outside the
+ *          refractory period after the previous beat
+ * The envelope decays exponentially instead of being hard-reset, so there
+ * is no periodic window where beats are missed or doubled.
+ *
+ * Everything that depends on the sample rate (filter coefficients, sample
+ * period, envelope time constant) is a constexpr of the template, so it is
+ * folded into the code instead of loaded from RAM.
+ *
+ * Layout: the state touched on every sample is one DetectorChannel per
+ * channel (68 bytes), kept together in an array ahead of the per-beat state
+ * (IBI window, BPM), which is only touched when a peak is found. A frame
+ * of interleaved samples is processed in a single pass over that array.
+ * HR_DETECTOR_IRAM places the per-frame loop in IRAM so it does not
+ * compete with WiFi code for the 32 KB flash cache.
+ *
+ * Timing: samples arrive in ADC x 8 units (see acquisition.h) stamped with
+ * their tick. Beat times are kept in microseconds and refined below the
+ * sample period by fitting a parabola through the three samples around
+ * each peak (HR_PEAK_INTERPOLATION).
+ */
+
+#ifndef HR_PEAK_INTERPOLATION
+#define HR_PEAK_INTERPOLATION 1
+#endif
+
+#ifndef HR_DETECTOR_IRAM
+#define HR_DETECTOR_IRAM 0
+#endif
+
+#if HR_DETECTOR_IRAM
+#define DETECTOR_HOT IRAM_ATTR
+#else
+#define DETECTOR_HOT
+#endif
+
+// ========================= DETECTOR CONFIGURATION =========================
+const int32_t sampleMidscale = 512 << 3;  // ADC midscale in ring units (ADC x 8)
+constexpr double bandLowHz = 0.5;         // Band-pass corners (30-240 BPM fundamentals)
+constexpr double bandHighHz = 4.0;
+const uint32_t refractoryUs = 250000;     // No second beat within this time of the last
+const uint32_t envelopeTauMs = 1280;      // Envelope decay time constant (rounded to 2^n samples)
+const int32_t minPulseAmplitude = 64;     // Filtered units (ADC counts x 8) below which we see no pulse
+
+/**
+ * floor(log2(n)) for n >= 1
+ */
+constexpr int detectorLog2(uint32_t n) {
+  return n > 1 ? 1 + detectorLog2(n >> 1) : 0;
+}
+
+/**
+ * Per-sample state of one channel
+ */
+struct DetectorChannel {
+  BiquadState highPass;
+  BiquadState lowPass;
+  int32_t filtered;
+  int32_t lastFiltered;
+  int32_t prevFiltered;          // Two samples back, for peak interpolation
+  int32_t lastSlope;
+  int32_t envelope;
+  int signal;                    // Last raw reading, ADC counts
+  bool primed;
+};
+
+/**
+ * Per-beat state of one channel
+ */
+template <int StatsWindow, int MedianWindow>
+struct DetectorBeats {
+  uint32_t lastBeatTimeUs;       // Interpolated time of the last beat (wraps after ~71 min)
+  uint32_t beatCount;            // Beats accepted since reset
+  uint32_t beatIntervalUs;       // Last inter-beat interval, microseconds
+  unsigned long beatInterval;    // Last inter-beat interval, milliseconds
+  int bpm;
+  bool pulseDetected;
+  BeatStatsWindow<StatsWindow, MedianWindow> stats;  // Windowed IBI statistics
+};
+
+template <int SampleRateHz, int Channels = 1, int StatsWindow = HR_STATS_WINDOW,
+          int MedianWindow = HR_MEDIAN_WINDOW>
+struct HeartRateDetector {
+  static_assert(SampleRateHz >= 10 && SampleRateHz <= 1000, "sample rate must be 10..1000 Hz");
+  static_assert(Channels >= 1, "need at least one channel");
+
+  static constexpr int channels = Channels;
+  static constexpr uint32_t sampleIntervalUs = 1000000UL / SampleRateHz;
+  static constexpr BiquadCoeffs highPass = biquadDesign(BIQUAD_HIGHPASS, bandLowHz, SampleRateHz);
+  static constexpr BiquadCoeffs lowPass = biquadDesign(BIQUAD_LOWPASS, bandHighHz, SampleRateHz);
+  static constexpr int envelopeDecayShift = detectorLog2(envelopeTauMs * SampleRateHz / 1000);
+
+  uint32_t tick;                 // Tick of the newest frame
+  DetectorChannel channel[Channels];
+  DetectorBeats<StatsWindow, MedianWindow> beats[Channels];
+};
+
+// Out-of-class definitions, needed when built as C++14
+template <int R, int C, int W, int M>
+constexpr BiquadCoeffs HeartRateDetector<R, C, W, M>::highPass;
+template <int R, int C, int W, int M>
+constexpr BiquadCoeffs HeartRateDetector<R, C, W, M>::lowPass;
+
+/**
+ * Clear all channels
+ */
+template <int R, int C, int W, int M>
+void detectorReset(HeartRateDetector<R, C, W, M>& d) {
+  memset(&d, 0, sizeof(d));
+}
+
+/**
+ * Sub-sample offset of a peak from the vertex of the parabola through
+ * (-1, before), (0, peak), (+1, after), in microseconds. Within half a
+ * sample period by construction; one integer divide per beat.
+ */
+inline int32_t peakOffsetUs(int32_t before, int32_t peak, int32_t after, uint32_t intervalUs) {
+  int32_t curvature = before - 2 * peak + after;   // Negative at a maximum
+  if (curvature >= 0) return 0;
+  return (int32_t)((int64_t)(before - after) * (int32_t)intervalUs / (2 * curvature));
+}
+
+/**
+ * Record a beat at beatTimeUs and feed its interval to the statistics.
+ * Once per beat, so kept out of line and out of IRAM.
+ */
+template <int W, int M>
+__attribute__((noinline)) void detectorAcceptBeat(DetectorBeats<W, M>& b, uint32_t beatTimeUs) {
+  // Calculate time between beats
+  if (b.beatCount > 0) {
+    b.beatIntervalUs = beatTimeUs - b.lastBeatTimeUs;
+    b.beatInterval = (b.beatIntervalUs + 500) / 1000;
+
+    // Range and outlier checks, then O(1) window update
+    if (beatStatsAdd(b.stats, b.beatIntervalUs)) {
+      b.bpm = beatStatsBpm(b.stats);
+      b.pulseDetected = true;
+    }
+  }
+  b.lastBeatTimeUs = beatTimeUs;
+  b.beatCount++;
+}
+
+/**
+ * Band-pass one channel's sample and look for a systolic peak one sample
+ * back
+ * @param sampleTimeUs Time of the sample since the first one
+ * @param sample Reading in ADC x 8 units
+ */
+template <int R, int C, int W, int M>
+inline void detectorStep(HeartRateDetector<R, C, W, M>& d, int ch, uint32_t sampleTimeUs,
+                         int32_t sample) {
+  typedef HeartRateDetector<R, C, W, M> D;
+  DetectorChannel& c = d.channel[ch];
+  c.signal = sample >> 3;
+
+  // Centre on ADC midscale; ADC x 8 already fits the biquad headroom (+/-4096)
+  int32_t x = sample - sampleMidscale;
+  if (!c.primed) {
+    biquadPrime(D::highPass, c.highPass, x);
+    biquadPrime(D::lowPass, c.lowPass, 0);
+    c.primed = true;
+  }
+  int32_t filtered = biquadStep(D::lowPass, c.lowPass, biquadStep(D::highPass, c.highPass, x));
+  c.filtered = filtered;
+
+  // Exponentially decaying envelope of the positive excursions
+  c.envelope -= c.envelope >> D::envelopeDecayShift;
+  if (filtered > c.envelope) c.envelope = filtered;
+
+  // A rising slope turning flat or negative means the previous sample was a peak
+  int32_t slope = filtered - c.lastFiltered;
+  if (c.lastSlope > 0 && slope <= 0 &&
+      c.envelope >= minPulseAmplitude &&
+      c.lastFiltered > (c.envelope >> 1)) {
+    uint32_t peakTimeUs = sampleTimeUs - D::sampleIntervalUs;
+#if HR_PEAK_INTERPOLATION
+    peakTimeUs += peakOffsetUs(c.prevFiltered, c.lastFiltered, filtered, D::sampleIntervalUs);
+#endif
+    DetectorBeats<W, M>& b = d.beats[ch];
+    if (b.beatCount == 0 || peakTimeUs - b.lastBeatTimeUs >= refractoryUs) {
+      detectorAcceptBeat(b, peakTimeUs);
+    }
+  }
+
+  c.lastSlope = slope;
+  c.prevFiltered = c.lastFiltered;
+  c.lastFiltered = filtered;
+}
+
+/**
+ * Process one frame: a sample for every channel, all taken at tick
+ * @param samples Channels readings in ADC x 8 units
+ */
+template <int R, int C, int W, int M>
+DETECTOR_HOT void detectorProcessFrame(HeartRateDetector<R, C, W, M>& d, uint32_t tick,
+                                       const int32_t* samples) {
+  d.tick = tick;
+  uint32_t timeUs = tick * HeartRateDetector<R, C, W, M>::sampleIntervalUs;
+  for (int ch = 0; ch < C; ch++) {
+    detectorStep(d, ch, timeUs, samples[ch]);
+  }
+}
+
+/**
+ * Process frames of interleaved samples (ch0, ch1, ..., ch0, ch1, ...)
+ * taken at consecutive ticks from firstTick
+ */
+template <int R, int C, int W, int M>
+void detectorProcessInterleaved(HeartRateDetector<R, C, W, M>& d, uint32_t firstTick,
+                                const int32_t* samples, uint32_t frames) {
+  for (uint32_t f = 0; f < frames; f++) {
+    detectorProcessFrame(d, firstTick + f, samples + f * C);
+  }
+}
+
+/**
+ * Current BPM of a channel, or 0 without a valid reading
+ */
+template <int R, int C, int W, int M>
+inline int detectorBpm(const HeartRateDetector<R, C, W, M>& d, int ch) {
+  return d.beats[ch].pulseDetected ? d.beats[ch].bpm : 0;
+}
+
+#endif // HEART_RATE_DETECTOR_H
@@ -0,0 +1,567 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "text_buffer.h"
+#include "profiler.h"
+
+/*
+ * Event-driven HTTP server
+ * ========================
+ * ESP8266WebServer served one client at a time inside loop(): it waited
+ * for the whole request, ran the handler and blocked in write() until the
+ * response was out, so one phone on weak WiFi held up the detector and
+ * MQTT for as long as its socket was slow.
+ *
+ * Here every connection has a fixed slot (HttpConn) with its own buffer and
+ * a two-state machine, and httpServerPoll() only does what the sockets
+ * allow right now:
+ *
+ *   READING  take the bytes that have arrived; once the head ("\r\n\r\n")
+ *            is complete, parse it and run the route's handler
+ *   WRITING  send as much of the response as availableForWrite() takes;
+ *            then wait for the next request (keep-alive) or close
+ *
+ * Handlers still run synchronously, but they only format: the body goes
+ * straight into the slot (httpBody(), or from flash for the dashboard) and
+ * trickles out over later polls. There is no shared response buffer, so
+ * slots never wait for each other.
+ *
+ * Limits, per connection:
+ *   - memory: one HTTP_CONN_BUFFER holds the request head, then the
+ *     response; a longer head gets 431, a longer body a 500
+ *   - time: HTTP_REQUEST_MS from a request's first byte to the end of its
+ *     response, after which the connection is dropped (a stalled reader,
+ *     or a slowloris sender); HTTP_KEEPALIVE_MS idle between requests
+ * and for the server: HTTP_MAX_CLIENTS slots (more connections get a 503)
+ * and HTTP_POLL_BUDGET_US per poll; slots not reached in one poll are
+ * serviced first in the next.
+ *
+ * Only GET and HEAD without a body are served. A request that arrives
+ * before the previous response is out (pipelining) is answered with
+ * Connection: close.
+ *
+ * /metrics is too large for a slot; it is streamed synchronously with
+ * chunked encoding (httpStreamBegin()) and the connection closed, as
+ * before: it is for LAN scrapers, not dashboards. /events takes the socket
+ * over (httpDetach()).
+ */
+
+#ifndef HTTP_PORT
+#define HTTP_PORT 80
+#endif
+
+#ifndef HTTP_MAX_CLIENTS
+#define HTTP_MAX_CLIENTS 4         // Concurrent connections
+#endif
+
+#ifndef HTTP_CONN_BUFFER
+#define HTTP_CONN_BUFFER 2304      // Bytes per connection: request head, then the response
+#endif
+
+#ifndef HTTP_REQUEST_MS
+#define HTTP_REQUEST_MS 3000       // First request byte to last response byte
+#endif
+
+#ifndef HTTP_KEEPALIVE_MS
+#define HTTP_KEEPALIVE_MS 5000     // Idle time allowed between requests
+#endif
+
+#ifndef HTTP_KEEPALIVE_MAX
+#define HTTP_KEEPALIVE_MAX 100     // Requests per connection before it is closed
+#endif
+
+#ifndef HTTP_POLL_BUDGET_US
+#define HTTP_POLL_BUDGET_US 2000   // Time one httpServerPoll() may spend
+#endif
+
+#ifndef HTTP_MAX_ROUTES
+#define HTTP_MAX_ROUTES 16
+#endif
+
+const size_t httpHeadReserve = 192;          // Slot bytes kept for a response head
+const size_t httpChunked = (size_t)-1;       // Length of a streamed (chunked) response
+static_assert(HTTP_CONN_BUFFER >= 2 * httpHeadReserve && HTTP_CONN_BUFFER <= 65535,
+              "HTTP_CONN_BUFFER must be 384..65535 bytes");
+
+enum HttpState { HTTP_FREE, HTTP_READING, HTTP_WRITING };
+
+struct HttpConn {
+  WiFiClient client;
+  HttpState state;
+  char buf[HTTP_CONN_BUFFER];
+  uint16_t length;               // READING: bytes received; WRITING: bytes to send
+  uint16_t sent;                 // WRITING: bytes of buf already sent
+  const uint8_t* flashBody;      // WRITING: body sent from flash after buf, or nullptr
+  uint32_t flashLength;
+  uint32_t flashSent;
+  uint32_t startMs;              // First byte of the current request
+  uint32_t idleSinceMs;          // Accepted, or last response finished
+  uint16_t served;               // Requests answered on this connection
+  bool keepAlive;
+  bool head;                     // HEAD request: no body
+  // Parsed request; points into buf until the handler replies
+  const char* path;
+  const char* query;             // After '?', or ""
+  const char* ifNoneMatch;       // Header value, or nullptr
+};
+
+typedef void (*HttpHandler)(HttpConn& c);
+
+struct HttpRoute {
+  const char* path;
+  HttpHandler handler;
+};
+
+WiFiServer httpListener(HTTP_PORT);
+HttpConn httpConns[HTTP_MAX_CLIENTS];
+HttpRoute httpRoutes[HTTP_MAX_ROUTES];
+uint8_t httpRouteCount = 0;
+uint8_t httpNextConn = 0;          // Slot the next poll starts at (round robin)
+HttpConn* httpStreamConn = nullptr;
+
+// Reported by /data and /metrics
+uint32_t httpRequests = 0;         // Requests routed to a handler
+uint32_t httpRejectedBusy = 0;     // Connections turned away with 503: every slot taken
+uint32_t httpRejectedBad = 0;      // 400, 404, 405, 413, 431
+uint32_t httpTimeouts = 0;         // Requests dropped after HTTP_REQUEST_MS
+uint32_t httpStreamed = 0;         // Responses streamed synchronously (/metrics)
+uint32_t httpPollUsLast = 0;
+uint32_t httpPollUsMax = 0;
+
+PROFILE_PROBE(httpRequestProbe, "http_request");
+
+static const char httpBusyResponse[] PROGMEM =
+  "HTTP/1.1 503 Service Unavailable\r\n"
+  "Content-Length: 0\r\n"
+  "Retry-After: 1\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+const char* httpStatusText(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Internal Server Error";
+  }
+}
+
+/**
+ * Register a handler for an exact path
+ * @return false if the route table is full
+ */
+bool httpOn(const char* path, HttpHandler handler) {
+  if (httpRouteCount >= HTTP_MAX_ROUTES) return false;
+  httpRoutes[httpRouteCount++] = HttpRoute{path, handler};
+  return true;
+}
+
+void httpServerBegin() {
+  httpListener.begin();
+  httpListener.setNoDelay(true);
+}
+
+/**
+ * Close the connection and free its slot
+ */
+void httpClose(HttpConn& c) {
+  c.client.stop();
+  c.state = HTTP_FREE;
+}
+
+/**
+ * Free the slot without closing the socket; the handler has kept its own
+ * copy of c.client
+ */
+void httpDetach(HttpConn& c) {
+  c.client = WiFiClient();
+  c.state = HTTP_FREE;
+}
+
+/**
+ * Value of query argument name, copied into out
+ * @return false if the argument is absent or too long
+ */
+bool httpArg(const HttpConn& c, const char* name, char* out, size_t size) {
+  size_t nameLength = strlen(name);
+  const char* p = c.query;
+  while (*p) {
+    const char* end = strchr(p, '&');
+    if (!end) end = p + strlen(p);
+    if ((size_t)(end - p) > nameLength && !strncmp(p, name, nameLength) && p[nameLength] == '=') {
+      size_t length = end - p - nameLength - 1;
+      if (length >= size) return false;
+      memcpy(out, p + nameLength + 1, length);
+      out[length] = '\0';
+      return true;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return false;
+}
+
+/**
+ * Format the response head
+ * @param length Body length, or httpChunked
+ * @param headers Extra header lines, each ending in "\r\n", or nullptr
+ */
+void httpFormatHead(TextBuffer& h, const HttpConn& c, int status, const char* contentType,
+                    size_t length, const char* headers) {
+  textPrintf(h, "HTTP/1.1 %d %s\r\n", status, httpStatusText(status));
+  if (contentType) textPrintf(h, "Content-Type: %s\r\n", contentType);
+  if (length == httpChunked) {
+    textAppend(h, "Transfer-Encoding: chunked\r\n");
+  } else if (status != 304) {
+    textPrintf(h, "Content-Length: %u\r\n", (unsigned)length);
+  }
+  if (headers) textAppend(h, headers);
+  textAppend(h, c.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+}
+
+/**
+ * Write all of data, waiting for the socket as needed (the synchronous
+ * path); gives up when the request's time is up
+ */
+bool httpWriteAll(HttpConn& c, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    if (!c.client.connected() || millis() - c.startMs >= HTTP_REQUEST_MS) return false;
+    size_t room = c.client.availableForWrite();
+    if (room == 0) {
+      yield();
+      continue;
+    }
+    size_t written = c.client.write(data, size < room ? size : room);
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+/**
+ * Where a handler formats its response body: the slot past the space
+ * reserved for the head. Writing it overwrites the request, so read
+ * c.path, c.query and c.ifNoneMatch (and httpArg()) first.
+ */
+inline uint8_t* httpBodyData(HttpConn& c) {
+  return (uint8_t*)c.buf + httpHeadReserve;
+}
+
+const size_t httpBodyCapacity = HTTP_CONN_BUFFER - httpHeadReserve;
+
+inline TextBuffer httpBody(HttpConn& c) {
+  return textOver((char*)httpBodyData(c), httpBodyCapacity);
+}
+
+/**
+ * Respond with the length bytes at httpBodyData(c). The head is written
+ * in front of them and the whole response is sent over the following polls.
+ * @param headers Extra header lines, each ending in "\r\n", or nullptr
+ */
+void httpSend(HttpConn& c, int status, const char* contentType, size_t length,
+              const char* headers = nullptr) {
+  FixedText<httpHeadReserve> head;
+  httpFormatHead(head, c, status, contentType, length, headers);
+  if (head.overflow) {
+    httpClose(c);
+    return;
+  }
+  size_t bodyLength = c.head ? 0 : length;
+  memmove(c.buf + head.length, httpBodyData(c), bodyLength);
+  memcpy(c.buf, head.data, head.length);
+  c.length = (uint16_t)(head.length + bodyLength);
+  c.sent = 0;
+  c.flashBody = nullptr;
+  c.state = HTTP_WRITING;
+}
+
+/**
+ * Respond with a body formatted through httpBody(), or a 500 if it did
+ * not fit
+ */
+void httpSendText(HttpConn& c, const char* contentType, const TextBuffer& body,
+                  const char* headers = nullptr) {
+  if (body.overflow) {
+    TextBuffer b = httpBody(c);
+    textAppend(b, "Response too large");
+    httpSend(c, 500, "text/plain", b.length);
+    return;
+  }
+  httpSend(c, 200, contentType, body.length, headers);
+}
+
+/**
+ * Respond with a short constant text
+ */
+void httpReply(HttpConn& c, int status, const char* contentType, const char* text) {
+  TextBuffer b = httpBody(c);
+  textAppend(b, text);
+  httpSend(c, status, contentType, b.length);
+}
+
+/**
+ * Respond with a body in flash (PROGMEM), sent from there in pieces
+ */
+void httpReplyFlash(HttpConn& c, int status, const char* contentType, const uint8_t* body,
+                    size_t length, const char* headers = nullptr) {
+  TextBuffer head = textOver(c.buf, sizeof(c.buf));
+  httpFormatHead(head, c, status, contentType, length, headers);
+  if (head.overflow) {
+    httpClose(c);
+    return;
+  }
+  c.length = (uint16_t)head.length;
+  c.sent = 0;
+  c.flashBody = c.head || status == 304 ? nullptr : body;
+  c.flashLength = length;
+  c.flashSent = 0;
+  c.state = HTTP_WRITING;
+}
+
+/**
+ * Answer an unservable request and close
+ */
+void httpReject(HttpConn& c, int status) {
+  httpRejectedBad++;
+  c.keepAlive = false;
+  c.head = false;
+  httpReply(c, status, "text/plain", httpStatusText(status));
+}
+
+// ========================= STREAMING =========================
+
+/**
+ * Sink for a TextBuffer: each full buffer becomes one HTTP chunk
+ */
+void httpStreamSink(const char* data, size_t size) {
+  if (!httpStreamConn || size == 0) return;
+  char head[12];
+  int n = snprintf(head, sizeof(head), "%x\r\n", (unsigned)size);
+  httpWriteAll(*httpStreamConn, (const uint8_t*)head, n);
+  httpWriteAll(*httpStreamConn, (const uint8_t*)data, size);
+  httpWriteAll(*httpStreamConn, (const uint8_t*)"\r\n", 2);
+}
+
+/**
+ * Start a chunked response of unknown length, written synchronously;
+ * point a TextBuffer's sink at httpStreamSink, then call httpStreamEnd()
+ */
+void httpStreamBegin(HttpConn& c, int status, const char* contentType) {
+  httpStreamed++;
+  c.keepAlive = false;
+  FixedText<httpHeadReserve> head;
+  httpFormatHead(head, c, status, contentType, httpChunked, nullptr);
+  httpWriteAll(c, (const uint8_t*)head.data, head.length);
+  httpStreamConn = &c;
+}
+
+void httpStreamEnd(HttpConn& c) {
+  httpWriteAll(c, (const uint8_t*)"0\r\n\r\n", 5);
+  httpStreamConn = nullptr;
+  httpClose(c);
+}
+
+// ========================= CONNECTIONS =========================
+
+/**
+ * Parse the request head in buf[0..headLength) and run its handler
+ */
+void httpDispatch(HttpConn& c, size_t headLength) {
+  bool pipelined = c.length > headLength;
+  c.head = false;
+  c.keepAlive = false;
+  c.ifNoneMatch = nullptr;
+
+  // Request line: METHOD SP target SP version
+  char* line = c.buf;
+  char* eol = strstr(line, "\r\n");
+  *eol = '\0';
+  char* target = strchr(line, ' ');
+  char* version = target ? strchr(target + 1, ' ') : nullptr;
+  if (!version) {
+    httpReject(c, 400);
+    return;
+  }
+  *target++ = '\0';
+  *version++ = '\0';
+  c.head = !strcmp(line, "HEAD");
+  if (!c.head && strcmp(line, "GET")) {
+    httpReject(c, 405);
+    return;
+  }
+  bool http11 = !strcmp(version, "HTTP/1.1");
+  c.keepAlive = http11;
+  char* query = strchr(target, '?');
+  if (query) *query++ = '\0';
+  c.path = target;
+  c.query = query ? query : "";
+
+  // Headers: only the few the routes use
+  for (line = eol + 2; line < c.buf + headLength - 2; line = eol + 2) {
+    eol = strstr(line, "\r\n");
+    *eol = '\0';
+    char* value = strchr(line, ':');
+    if (!value) continue;
+    *value++ = '\0';
+    while (*value == ' ') value++;
+    if (!strcasecmp(line, "Connection")) {
+      if (!strcasecmp(value, "close")) c.keepAlive = false;
+      if (!strcasecmp(value, "keep-alive")) c.keepAlive = true;
+    } else if (!strcasecmp(line, "If-None-Match")) {
+      c.ifNoneMatch = value;
+    } else if ((!strcasecmp(line, "Content-Length") && strtoul(value, nullptr, 10) > 0) ||
+               !strcasecmp(line, "Transfer-Encoding")) {
+      httpReject(c, 413);
+      return;
+    }
+  }
+  if (pipelined || c.served + 1 >= HTTP_KEEPALIVE_MAX) c.keepAlive = false;
+
+  for (uint8_t i = 0; i < httpRouteCount; i++) {
+    if (strcmp(c.path, httpRoutes[i].path)) continue;
+    httpRequests++;
+    PROFILE_SCOPE(httpRequestProbe);
+    httpRoutes[i].handler(c);
+    if (c.state == HTTP_READING) httpReply(c, 500, "text/plain", "No response");
+    return;
+  }
+  httpReject(c, 404);
+}
+
+/**
+ * Hand new connections a free slot, or a 503 if there is none
+ */
+void httpAccept() {
+  for (;;) {
+    WiFiClient client = httpListener.accept();
+    if (!client) return;
+    HttpConn* slot = nullptr;
+    for (int i = 0; i < HTTP_MAX_CLIENTS && !slot; i++) {
+      if (httpConns[i].state == HTTP_FREE) slot = &httpConns[i];
+    }
+    if (!slot) {
+      httpRejectedBusy++;
+      if (client.availableForWrite() >= (int)sizeof(httpBusyResponse) - 1) {
+        client.write_P(httpBusyResponse, sizeof(httpBusyResponse) - 1);
+      }
+      client.stop();
+      continue;
+    }
+    slot->client = client;
+    slot->client.setNoDelay(true);
+    slot->state = HTTP_READING;
+    slot->length = 0;
+    slot->served = 0;
+    slot->idleSinceMs = millis();
+  }
+}
+
+/**
+ * Send what the socket takes of the slot, then of the flash body
+ * @return true once everything is out
+ */
+bool httpFlush(HttpConn& c) {
+  while (c.sent < c.length) {
+    size_t room = c.client.availableForWrite();
+    if (room == 0) return false;
+    size_t chunk = c.length - c.sent;
+    size_t written = c.client.write((const uint8_t*)c.buf + c.sent, chunk < room ? chunk : room);
+    if (written == 0) return false;
+    c.sent += written;
+  }
+  while (c.flashBody && c.flashSent < c.flashLength) {
+    size_t room = c.client.availableForWrite();
+    if (room == 0) return false;
+    size_t chunk = c.flashLength - c.flashSent;
+    size_t written = c.client.write_P((PGM_P)c.flashBody + c.flashSent, chunk < room ? chunk : room);
+    if (written == 0) return false;
+    c.flashSent += written;
+  }
+  return true;
+}
+
+/**
+ * Advance one connection as far as its socket allows without waiting
+ */
+void httpService(HttpConn& c) {
+  uint32_t now = millis();
+  if (!c.client.connected()) {
+    httpClose(c);
+    return;
+  }
+
+  if (c.state == HTTP_READING) {
+    int available = c.client.available();
+    if (available <= 0) {
+      if (c.length == 0 ? now - c.idleSinceMs >= HTTP_KEEPALIVE_MS : now - c.startMs >= HTTP_REQUEST_MS) {
+        if (c.length > 0) httpTimeouts++;
+        httpClose(c);
+      }
+      return;
+    }
+    if (c.length == 0) c.startMs = now;
+    size_t room = sizeof(c.buf) - 1 - c.length;
+    int got = c.client.read((uint8_t*)c.buf + c.length, (size_t)available < room ? available : room);
+    if (got > 0) c.length += got;
+    c.buf[c.length] = '\0';
+    char* end = strstr(c.buf, "\r\n\r\n");
+    if (end) {
+      httpDispatch(c, end + 4 - c.buf);
+    } else if (c.length == sizeof(c.buf) - 1) {
+      httpReject(c, 431);
+    }
+    if (c.state != HTTP_WRITING) return;
+  }
+
+  if (now - c.startMs >= HTTP_REQUEST_MS) {
+    httpTimeouts++;
+    httpClose(c);
+    return;
+  }
+  if (!httpFlush(c)) return;
+  if (!c.keepAlive) {
+    httpClose(c);
+    return;
+  }
+  c.state = HTTP_READING;
+  c.length = 0;
+  c.served++;
+  c.idleSinceMs = millis();
+}
+
+/**
+ * Accept, read, dispatch and write for every connection, within
+ * HTTP_POLL_BUDGET_US. Call from loop() (the http task).
+ */
+void httpServerPoll() {
+  uint32_t start = micros();
+  httpAccept();
+  for (int n = 0; n < HTTP_MAX_CLIENTS; n++) {
+    HttpConn& c = httpConns[httpNextConn];
+    httpNextConn = httpNextConn + 1 == HTTP_MAX_CLIENTS ? 0 : httpNextConn + 1;
+    if (c.state != HTTP_FREE) httpService(c);
+    if (micros() - start >= HTTP_POLL_BUDGET_US) break;
+  }
+  httpPollUsLast = micros() - start;
+  if (httpPollUsLast > httpPollUsMax) httpPollUsMax = httpPollUsLast;
+}
+
+/**
+ * Connections currently holding a slot
+ */
+int httpConnections() {
+  int count = 0;
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (httpConns[i].state != HTTP_FREE) count++;
+  }
+  return count;
+}
+
+#endif // HTTP_SERVER_H
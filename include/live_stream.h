@@ -0,0 +1,150 @@
+#ifndef LIVE_STREAM_H
+#define LIVE_STREAM_H
+
+#include <ESP8266WiFi.h>
+
+/*
+ * Server-Sent Events live stream
+ * ==============================
+ * GET /events upgrades the request into a long-lived text/event-stream.
+ * The WiFiClient is copied out of the HTTP server (the connection stays
+ * open as long as one copy holds it) into a fixed slot with its own byte
+ * queue. Publishing appends whole events to every queue; pumping writes
+ * only what each socket can take right now (availableForWrite), so a slow
+ * phone never blocks loop(). When a client's queue is full the new event
+ * is dropped for that client only and counted.
+ */
+
+#ifndef LIVE_MAX_CLIENTS
+#define LIVE_MAX_CLIENTS 3         // Concurrent /events streams
+#endif
+
+#ifndef LIVE_QUEUE_SIZE
+#define LIVE_QUEUE_SIZE 512        // Pending bytes per client
+#endif
+
+const unsigned long liveKeepaliveMs = 15000;  // Comment line to detect dead peers
+
+struct LiveClient {
+  WiFiClient client;
+  bool active;
+  char queue[LIVE_QUEUE_SIZE];
+  uint16_t head;                 // Oldest unsent byte
+  uint16_t length;               // Bytes waiting
+  uint32_t dropped;              // Events discarded for this client
+};
+
+LiveClient liveClients[LIVE_MAX_CLIENTS];
+uint32_t liveEventsPublished = 0;
+uint32_t liveEventsDropped = 0;
+unsigned long liveLastKeepaliveMs = 0;
+
+static const char liveStreamHead[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Connection: keep-alive\r\n"
+  "\r\n"
+  "retry: 2000\n\n";
+
+/**
+ * Number of connected stream clients
+ */
+int liveStreamClients() {
+  int count = 0;
+  for (int i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    if (liveClients[i].active) count++;
+  }
+  return count;
+}
+
+/**
+ * Take over a client that requested /events
+ * @return false if every slot is busy
+ */
+bool liveStreamAccept(WiFiClient& client) {
+  for (int i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    LiveClient& slot = liveClients[i];
+    if (slot.active) continue;
+    slot.client = client;
+    slot.client.setNoDelay(true);
+    slot.client.write_P(liveStreamHead, sizeof(liveStreamHead) - 1);
+    slot.active = true;
+    slot.head = 0;
+    slot.length = 0;
+    slot.dropped = 0;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Append raw bytes to one client's queue, all or nothing
+ */
+bool liveStreamEnqueue(LiveClient& slot, const char* data, uint16_t size) {
+  if (size > LIVE_QUEUE_SIZE - slot.length) return false;
+  uint16_t tail = (slot.head + slot.length) % LIVE_QUEUE_SIZE;
+  for (uint16_t i = 0; i < size; i++) {
+    slot.queue[(tail + i) % LIVE_QUEUE_SIZE] = data[i];
+  }
+  slot.length += size;
+  return true;
+}
+
+/**
+ * Queue one event for every connected client
+ * @param event SSE event name
+ * @param data Single-line payload (JSON)
+ */
+void liveStreamPublish(const char* event, const char* data) {
+  char frame[160];
+  int size = snprintf(frame, sizeof(frame), "event: %s\ndata: %s\n\n", event, data);
+  if (size <= 0 || size >= (int)sizeof(frame)) return;
+
+  liveEventsPublished++;
+  for (int i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    LiveClient& slot = liveClients[i];
+    if (!slot.active) continue;
+    if (!liveStreamEnqueue(slot, frame, (uint16_t)size)) {
+      slot.dropped++;
+      liveEventsDropped++;
+    }
+  }
+}
+
+/**
+ * Flush queued bytes without blocking and reap disconnected clients.
+ * Call once per loop().
+ */
+void liveStreamPump() {
+  unsigned long now = millis();
+  if (now - liveLastKeepaliveMs >= liveKeepaliveMs) {
+    liveLastKeepaliveMs = now;
+    for (int i = 0; i < LIVE_MAX_CLIENTS; i++) {
+      if (liveClients[i].active) liveStreamEnqueue(liveClients[i], ":\n\n", 3);
+    }
+  }
+
+  for (int i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    LiveClient& slot = liveClients[i];
+    if (!slot.active) continue;
+    if (!slot.client.connected()) {
+      slot.client.stop();
+      slot.active = false;
+      continue;
+    }
+    while (slot.length > 0) {
+      int room = slot.client.availableForWrite();
+      if (room <= 0) break;
+      uint16_t chunk = LIVE_QUEUE_SIZE - slot.head;       // Up to the wrap point
+      if (chunk > slot.length) chunk = slot.length;
+      if ((int)chunk > room) chunk = (uint16_t)room;
+      size_t written = slot.client.write((const uint8_t*)slot.queue + slot.head, chunk);
+      if (written == 0) break;
+      slot.head = (slot.head + written) % LIVE_QUEUE_SIZE;
+      slot.length -= written;
+    }
+  }
+}
+
+#endif // LIVE_STREAM_H
@@ -3,60 +3,444 @@
 
 #include <PubSubClient.h>
 #include <ESP8266WiFi.h>
-#include <WiFiClientSecure.h>
+#include "heart_rate.h"
+#include "acquisition.h"
+#include "tls_transport.h"
+
+#ifndef MQTT_BATCH_SECONDS
+#define MQTT_BATCH_SECONDS 10      // Seconds per binary telemetry frame; 0 = one JSON per second
+#endif
+
+#ifndef MQTT_BATCH_WAVE
+#define MQTT_BATCH_WAVE 0          // 1 = also send the raw waveform (~1 KB per 10 s)
+#endif
+
+#ifndef MQTT_REPORT_BY_EXCEPTION
+#define MQTT_REPORT_BY_EXCEPTION 1 // 0 = publish every second's reading regardless of change or quality
+#endif
+
+#ifndef MQTT_RETAIN_TELEMETRY
+#define MQTT_RETAIN_TELEMETRY 0    // 1 = broker keeps the last frame for late subscribers
+#endif
+
+// Worst case per second: one SECOND record and four BEATs (240 BPM), plus
+// ~100 bytes of delta-coded samples when the waveform is included
+#ifndef TELEMETRY_FRAME_SIZE
+#define TELEMETRY_FRAME_SIZE (20 + MQTT_BATCH_SECONDS * 31 + MQTT_BATCH_WAVE * (15 + MQTT_BATCH_SECONDS * 100))
+#endif
+
+#include "telemetry_frame.h"
+#include "telemetry_log.h"
+#include "profiler.h"
+#include "text_buffer.h"
+#include "timebase.h"
+
+#ifndef MQTT_DRAIN_PER_SECOND
+#define MQTT_DRAIN_PER_SECOND 2    // Stored frames replayed per second after reconnecting, read in one go
+#endif
+
+#define MQTT_DEVICE_ID "ESP8266_001"
+#define MQTT_USER_ID "BW8NUP21AWMkI0xrrI2nxBP6Xd92"
 
 // HiveMQ Cloud broker details (update username/password below)
 const char* mqtt_server = "38f07a1ee3754972a26af0f040402fde.s1.eu.hivemq.cloud";
 const int mqtt_port = 8883;
 const char* mqtt_topic = "mrhasan/heart"; // Unique topic for your project
+// Binary frames and their retained description; identity lives in the topic
+const char* mqtt_telemetry_topic = "mrhasan/heart/" MQTT_DEVICE_ID "/telemetry";
+const char* mqtt_meta_topic = "mrhasan/heart/" MQTT_DEVICE_ID "/meta";
 const char *mqtt_username = "Paradox";    // <-- Set your HiveMQ Cloud username
 const char *mqtt_password = "Paradox1";    // <-- Set your HiveMQ Cloud password
 
+// Root CA the broker's certificate must chain to (HiveMQ Cloud: Let's
+// Encrypt, ISRG Root X1). Replace it when using another broker.
+static const char mqttRootCa[] PROGMEM = R"(
+-----BEGIN CERTIFICATE-----
+MIIFazCCA1OgAwIBAgIRAIIQz7DSQONZRGPgu2OCiwAwDQYJKoZIhvcNAQELBQAw
+TzELMAkGA1UEBhMCVVMxKTAnBgNVBAoTIEludGVybmV0IFNlY3VyaXR5IFJlc2Vh
+cmNoIEdyb3VwMRUwEwYDVQQDEwxJU1JHIFJvb3QgWDEwHhcNMTUwNjA0MTEwNDM4
+WhcNMzUwNjA0MTEwNDM4WjBPMQswCQYDVQQGEwJVUzEpMCcGA1UEChMgSW50ZXJu
+ZXQgU2VjdXJpdHkgUmVzZWFyY2ggR3JvdXAxFTATBgNVBAMTDElTUkcgUm9vdCBY
+MTCCAiIwDQYJKoZIhvcNAQEBBQADggIPADCCAgoCggIBAK3oJHP0FDfzm54rVygc
+h77ct984kIxuPOZXoHj3dcKi/vVqbvYATyjb3miGbESTtrFj/RQSa78f0uoxmyF+
+0TM8ukj13Xnfs7j/EvEhmkvBioZxaUpmZmyPfjxwv60pIgbz5MDmgK7iS4+3mX6U
+A5/TR5d8mUgjU+g4rk8Kb4Mu0UlXjIB0ttov0DiNewNwIRt18jA8+o+u3dpjq+sW
+T8KOEUt+zwvo/7V3LvSye0rgTBIlDHCNAymg4VMk7BPZ7hm/ELNKjD+Jo2FR3qyH
+B5T0Y3HsLuJvW5iB4YlcNHlsdu87kGJ55tukmi8mxdAQ4Q7e2RCOFvu396j3x+UC
+B5iPNgiV5+I3lg02dZ77DnKxHZu8A/lJBdiB3QW0KtZB6awBdpUKD9jf1b0SHzUv
+KBds0pjBqAlkd25HN7rOrFleaJ1/ctaJxQZBKT5ZPt0m9STJEadao0xAH0ahmbWn
+OlFuhjuefXKnEgV4We0+UXgVCwOPjdAvBbI+e0ocS3MFEvzG6uBQE3xDk3SzynTn
+jh8BCNAw1FtxNrQHusEwMFxIt4I7mKZ9YIqioymCzLq9gwQbooMDQaHWBfEbwrbw
+qHyGO0aoSCqI3Haadr8faqU9GY/rOPNk3sgrDQoo//fb4hVC1CLQJ13hef4Y53CI
+rU7m2Ys6xt0nUW7/vGT1M0NPAgMBAAGjQjBAMA4GA1UdDwEB/wQEAwIBBjAPBgNV
+HRMBAf8EBTADAQH/MB0GA1UdDgQWBBR5tFnme7bl5AFzgAiIyBpY9umbbjANBgkq
+hkiG9w0BAQsFAAOCAgEAVR9YqbyyqFDQDLHYGmkgJykIrGF1XIpu+ILlaS/V9lZL
+ubhzEFnTIZd+50xx+7LSYK05qAvqFyFWhfFQDlnrzuBZ6brJFe+GnY+EgPbk6ZGQ
+3BebYhtF8GaV0nxvwuo77x/Py9auJ/GpsMiu/X1+mvoiBOv/2X/qkSsisRcOj/KK
+NFtY2PwByVS5uCbMiogziUwthDyC3+6WVwW6LLv3xLfHTjuCvjHIInNzktHCgKQ5
+ORAzI4JMPJ+GslWYHb4phowim57iaztXOoJwTdwJx4nLCgdNbOhdjsnvzqvHu7Ur
+TkXWStAmzOVyyghqpZXjFaH3pO3JLF+l+/+sKAIuvtd7u+Nxe5AW0wdeRlN8NwdC
+jNPElpzVmbUq4JUagEiuTDkHzsxHpFKVK7q4+63SM1N95R1NbdWhscdCb+ZAJzVc
+oyi3B43njTOQ5yOf+1CceWxG1bQVs5ZufpsMljq4Ui0/1lvh+wjChP4kqKOJ2qxq
+4RgqsahDYVvTH9w7jXbyLeiNdd8XM2w9U/t7y0Ff/9yi0GE44Za4rF2LN9d11TPA
+mRGunUHBcnWEvgJBQl9nJEiU0Zsnvgc/ubhPgXRR4Xq37Z0j4r7g1SgEEzwxA57d
+emyPxgcYxn/eR44/KJ4EBs+lVDR3veyJm+kXQ99b21/+jh5Xos1AnX5iItreGCc=
+-----END CERTIFICATE-----
+)";
+
 extern int heartRate;
-extern int signalValue;
 
-WiFiClientSecure espMqttClient;
-PubSubClient mqttClient(espMqttClient);
+TlsTransport mqttTls = {mqtt_server, (uint16_t)mqtt_port, mqttRootCa, "mqtt"};
+PubSubClient mqttClient(mqttTls.client);
 
-void mqttReconnect() {
-  while (!mqttClient.connected()) {
-    String clientId = "ESP8266Client-";
-    clientId += String(random(0xffff), HEX);
-    if (mqttClient.connect(clientId.c_str(), mqtt_username, mqtt_password)) {
-      Serial.println("[MQTT] Connected to HiveMQ Cloud");
-    } else {
-      Serial.print("[MQTT] Failed, rc=");
-      Serial.print(mqttClient.state());
-      Serial.println(" try again in 2 seconds");
-      delay(2000);
-    }
+PROFILE_PROBE(mqttPublishProbe, "mqtt_publish");
+PROFILE_PROBE(tlogAppendProbe, "tlog_append");
+
+uint32_t mqttFirstPublishMs = 0;   // millis() of the first telemetry published since boot, 0 = not yet
+
+/**
+ * Publish one binary frame on the telemetry topic
+ */
+bool mqttPublishFrame(const uint8_t* frame, size_t length, bool retain) {
+  PROFILE_SCOPE(mqttPublishProbe);
+  bool ok = mqttClient.publish(mqtt_telemetry_topic, frame, length, retain);
+  if (ok && !mqttFirstPublishMs) mqttFirstPublishMs = millis();
+  return ok;
+}
+
+// Batched telemetry. PubSubClient publishes at QoS 0 only; the frame
+// sequence number lets the subscriber see lost frames instead.
+TelemetryBatch telemetryBatch;
+uint32_t telemetrySeq = 0;
+uint32_t telemetryWaveCursor = 0;
+BeatCursor telemetryBeats = {1, 0};
+uint32_t telemetryFramesPublished = 0;
+uint32_t telemetryFramesStored = 0;    // Offline frames written to the flash log
+uint32_t telemetryFramesFailed = 0;    // Frames lost: offline and the log failed
+uint32_t telemetryFramesReplayed = 0;  // Stored frames published after reconnecting
+uint32_t telemetryBytesPublished = 0;
+
+// Report by exception (signal_quality.h): which once-a-second readings go
+// out at all. Beats are only recorded while the quality is adequate.
+ReportGate mqttReportGate;
+uint32_t telemetryBeatsSkipped = 0;    // Beats not sent: quality too poor
+
+/**
+ * Whether this second's reading should be published
+ */
+bool mqttReportDue(uint32_t nowMs) {
+#if MQTT_REPORT_BY_EXCEPTION
+  return reportGateCheck(mqttReportGate, nowMs, heartRate, signalQualityIndex) != REPORT_NONE;
+#else
+  return true;
+#endif
+}
+
+/**
+ * BPM to publish: 0 while the quality is too poor to report a value
+ */
+int mqttReportedBpm() {
+  return signalQualityAdequate() || !MQTT_REPORT_BY_EXCEPTION ? heartRate : 0;
+}
+
+/**
+ * Describe the device and frame format once per connection; retained so
+ * subscribers get it whenever they join
+ */
+void mqttPublishMeta() {
+  FixedText<192> meta;
+  textPrintf(meta,
+             "{\"userId\":\"" MQTT_USER_ID "\",\"deviceId\":\"" MQTT_DEVICE_ID "\","
+             "\"dataType\":\"heartRate\",\"format\":\"telemetry/%u\",\"batchSeconds\":%d,"
+             "\"sampleIntervalMs\":%d}",
+             telemetryVersion, MQTT_BATCH_SECONDS, sampleIntervalMs);
+  mqttClient.publish(mqtt_meta_topic, meta.data, true);
+}
+
+// ========================= CONNECTION STATE MACHINE =========================
+//
+// mqttLoopAndPublish() never waits for the broker. While WiFi is down it
+// does nothing; otherwise it makes at most one connect attempt per call,
+// and only once the backoff delay has passed. The delay doubles after each
+// failure (MQTT_BACKOFF_MIN_MS .. MQTT_BACKOFF_MAX_MS) with random jitter
+// so a fleet doesn't reconnect in lockstep after a broker restart.
+//
+// A single connect still blocks: the host lookup, TCP connect and TLS
+// handshake (at most tlsConnectMaxMs, tls_transport.h), then up to
+// MQTT_CONNECT_TIMEOUT_MS for the broker's CONNACK. Samples keep arriving in
+// acqRing from the timer ISR meanwhile, so the ring must hold a whole
+// attempt (checked below). The Telegram connect is the same TLS connect
+// without the CONNACK, so this covers it too.
+
+#ifndef MQTT_BACKOFF_MIN_MS
+#define MQTT_BACKOFF_MIN_MS 1000
+#endif
+
+#ifndef MQTT_BACKOFF_MAX_MS
+#define MQTT_BACKOFF_MAX_MS 60000
+#endif
+
+#ifndef MQTT_CONNECT_TIMEOUT_MS
+#define MQTT_CONNECT_TIMEOUT_MS 1000 // CONNACK wait after the TLS connect (whole seconds)
+#endif
+
+static_assert(SAMPLE_RING_SIZE * sampleIntervalMs >= tlsConnectMaxMs + MQTT_CONNECT_TIMEOUT_MS,
+              "acqRing must buffer samples for a whole blocking MQTT connect");
+
+enum MqttState {
+  MQTT_LINK_WAIT_WIFI,           // No network; nothing to try
+  MQTT_LINK_BACKOFF,             // Waiting out the delay before the next attempt
+  MQTT_LINK_UP
+};
+
+MqttState mqttState = MQTT_LINK_WAIT_WIFI;
+uint32_t mqttBackoffMs = MQTT_BACKOFF_MIN_MS;  // Delay after the next failure
+uint32_t mqttRetryAtMs = 0;                    // millis() of the next allowed attempt
+
+// Connection health, reported by /data
+uint32_t mqttConnectAttempts = 0;
+uint32_t mqttConnectFailures = 0;
+uint32_t mqttDisconnects = 0;
+int mqttLastError = 0;                         // PubSubClient state() of the last failure
+uint32_t mqttLastConnectMs = 0;                // Time the last attempt blocked
+uint32_t mqttMaxConnectMs = 0;
+unsigned long mqttConnectedSinceMs = 0;
+
+/**
+ * Try once to connect; on failure schedule the next attempt with jittered
+ * exponential backoff
+ */
+void mqttAttemptConnect() {
+  FixedText<24> clientId;
+  textPrintf(clientId, "ESP8266Client-%x", (unsigned)random(0xffff));
+
+  mqttConnectAttempts++;
+  unsigned long start = millis();
+  tlsHandshakeBegin(mqttTls);
+  bool ok = mqttClient.connect(clientId.data, mqtt_username, mqtt_password);
+  tlsHandshakeEnd(mqttTls, ok || mqttClient.state() != MQTT_CONNECT_FAILED);  // Refused CONNECT: TLS was up
+  mqttLastConnectMs = millis() - start;
+  if (mqttLastConnectMs > mqttMaxConnectMs) mqttMaxConnectMs = mqttLastConnectMs;
+
+  if (ok) {
+    Serial.printf("[MQTT] Connected to HiveMQ Cloud in %u ms\n", (unsigned)mqttLastConnectMs);
+    mqttState = MQTT_LINK_UP;
+    mqttConnectedSinceMs = millis();
+    mqttBackoffMs = MQTT_BACKOFF_MIN_MS;
+    mqttPublishMeta();
+    return;
   }
+
+  mqttConnectFailures++;
+  mqttLastError = mqttClient.state();
+  // Equal jitter: wait between half and all of the current backoff
+  uint32_t wait = mqttBackoffMs / 2 + (uint32_t)random(mqttBackoffMs / 2 + 1);
+  mqttRetryAtMs = millis() + wait;
+  mqttState = MQTT_LINK_BACKOFF;
+  mqttBackoffMs = mqttBackoffMs >= MQTT_BACKOFF_MAX_MS / 2 ? MQTT_BACKOFF_MAX_MS : mqttBackoffMs * 2;
+  Serial.printf("[MQTT] Failed, rc=%d, retry in %u ms\n", mqttLastError, (unsigned)wait);
+}
+
+/**
+ * Advance the connection state machine by at most one connect attempt
+ * @return true if connected
+ */
+bool mqttService() {
+  if (WiFi.status() != WL_CONNECTED) {
+    if (mqttState == MQTT_LINK_UP) mqttDisconnects++;
+    mqttState = MQTT_LINK_WAIT_WIFI;
+    return false;
+  }
+
+  switch (mqttState) {
+    case MQTT_LINK_UP:
+      if (mqttClient.loop()) return true;
+      mqttDisconnects++;
+      mqttLastError = mqttClient.state();
+      Serial.printf("[MQTT] Connection lost, rc=%d\n", mqttLastError);
+      mqttState = MQTT_LINK_BACKOFF;
+      mqttRetryAtMs = millis();           // First retry right away, then back off
+      return false;
+    case MQTT_LINK_WAIT_WIFI:
+      mqttState = MQTT_LINK_BACKOFF;
+      mqttRetryAtMs = millis();
+      return false;
+    case MQTT_LINK_BACKOFF:
+      // tlsPrepare() may need a pass of its own (MFLN probe) or hold off
+      if ((int32_t)(millis() - mqttRetryAtMs) >= 0 && tlsPrepare(mqttTls)) mqttAttemptConnect();
+      return mqttState == MQTT_LINK_UP;
+  }
+  return false;
 }
 
 void mqttSetup() {
-  espMqttClient.setInsecure(); // For testing only. For production, use a proper root CA cert.
   mqttClient.setServer(mqtt_server, mqtt_port);
+  mqttClient.setSocketTimeout((MQTT_CONNECT_TIMEOUT_MS + 999) / 1000);  // CONNACK wait, seconds; TLS sets its own
+  mqttClient.setBufferSize(TELEMETRY_FRAME_SIZE + 96);  // Frame plus MQTT header and topic
+#if MQTT_BATCH_SECONDS > 0
+  // LittleFS runs from flash with the cache off: no sampling interrupt meanwhile
+  acquisitionPause();
+  bool restored = tlogBegin(telemetryLog);
+  acquisitionResume();
+  if (restored) {
+    Serial.printf("[MQTT] Offline log: %u frames waiting\n", (unsigned)telemetryLog.pending);
+  }
+#endif
 }
 
-void mqttLoopAndPublish() {
-  if (!mqttClient.connected()) {
-    mqttReconnect();
+/**
+ * Detector time of the newest processed sample, in ms since sampling began
+ */
+uint32_t detectorTimeMs() {
+  return lastSampleTick * sampleIntervalMs;
+}
+
+/**
+ * Publish the frame being built and start the next one at baseMs
+ */
+void mqttPublishBatch(uint32_t baseMs) {
+  if (telemetryBatch.records > 0) {
+    size_t length = telemetryFinish(telemetryBatch);
+    if (mqttState == MQTT_LINK_UP && mqttPublishFrame(telemetryBatch.data, length, MQTT_RETAIN_TELEMETRY)) {
+      telemetryFramesPublished++;
+      telemetryBytesPublished += length;
+    } else {
+      PROFILE_SCOPE(tlogAppendProbe);
+      acquisitionPause();
+      bool stored = tlogAppend(telemetryLog, telemetryBatch.data, length);
+      acquisitionResume();
+      if (stored) {
+        telemetryFramesStored++;
+      } else {
+        telemetryFramesFailed++;
+      }
+    }
+    Serial.printf("[MQTT] Frame %u: %u records, %u bytes\n",
+                  (unsigned)telemetrySeq, telemetryBatch.records, (unsigned)length);
+    telemetrySeq++;
+  }
+  telemetryBegin(telemetryBatch, telemetrySeq, baseMs, detectorEpochUs(baseMs * 1000) / 1000);
+}
+
+/**
+ * Republish stored frames, MQTT_DRAIN_PER_SECOND once a second. Live
+ * frames are published directly as they complete, so the backlog only uses
+ * the spare slots and never delays them.
+ *
+ * Reading flash stops sampling (acquisition.h), so each second's frames are
+ * read, and the cursor saved when due, in a single pause. Draining a
+ * backlog therefore costs one short tick gap per second, plus one when it
+ * empties; hr_sampling_pauses_total and hr_sampling_pause_seconds_max show
+ * how many and how long.
+ */
+void mqttDrainBacklog() {
+  static unsigned long lastDrain = 0;
+  if (telemetryLog.pending == 0 || millis() - lastDrain < 1000) return;
+  lastDrain = millis();
+  static uint8_t frames[MQTT_DRAIN_PER_SECOND * TELEMETRY_FRAME_SIZE];
+  uint16_t lengths[MQTT_DRAIN_PER_SECOND];
+  acquisitionPause();
+  uint8_t count = tlogPeekBatch(telemetryLog, frames, sizeof(frames), lengths, MQTT_DRAIN_PER_SECOND);
+  acquisitionResume();
+  size_t offset = 0;
+  for (uint8_t i = 0; i < count && mqttPublishFrame(frames + offset, lengths[i], false); i++) {
+    tlogConsume(telemetryLog, lengths[i]);
+    offset += lengths[i];
+    telemetryFramesReplayed++;
+    telemetryBytesPublished += lengths[i];
+  }
+  if (telemetryLog.pending == 0 && tlogCursorDue(telemetryLog)) {
+    acquisitionPause();
+    tlogSaveCursor(telemetryLog);
+    acquisitionResume();
   }
-  mqttClient.loop();
+}
+
+/**
+ * Record new beats and the once-a-second summaries that pass the report
+ * gate; publish every MQTT_BATCH_SECONDS (if there is anything to send) or
+ * as soon as the frame is full. Beats come from the event queue, so every
+ * one is seen however many land between passes.
+ */
+void mqttBatchTelemetry() {
+  static unsigned long lastSecond = 0;
+  static unsigned long batchStart = 0;
+  uint32_t nowMs = detectorTimeMs();
+  if (telemetryBatch.length == 0) {
+    telemetryBegin(telemetryBatch, telemetrySeq, nowMs, detectorEpochUs(nowMs * 1000) / 1000);
+    batchStart = millis();
+  }
+
+  while (const BeatEvent* e = beatEventNext(beatEvents, telemetryBeats)) {
+    bool accepted = e->flags & beatEventAccepted;
+    // Beat time in the same ms timeline, safe across the 71 min us wrap
+    uint32_t beatMs = nowMs - (lastSampleTick * sampleIntervalUs - e->timeUs) / 1000;
+    if (MQTT_REPORT_BY_EXCEPTION && !(e->flags & beatEventQuality)) {
+      telemetryBeatsSkipped++;
+    } else if (!telemetryAddBeat(telemetryBatch, beatMs, e->ibiUs, accepted)) {
+      mqttPublishBatch(nowMs);
+      telemetryAddBeat(telemetryBatch, beatMs, e->ibiUs, accepted);
+    }
+  }
+
+  if (millis() - lastSecond >= 1000) {
+    lastSecond = millis();
+    if (mqttReportDue(nowMs)) {
+      int bpm = mqttReportedBpm();
+      uint8_t flags = (pulseDetected ? telemetrySecondDetected : 0) |
+                      (signalQualityAdequate() ? telemetrySecondAdequate : 0);
+      if (!telemetryAddSecond(telemetryBatch, nowMs, bpm, signalValue, flags)) {
+        mqttPublishBatch(nowMs);
+        telemetryAddSecond(telemetryBatch, nowMs, bpm, signalValue, flags);
+      }
+    }
+  }
+
+  if (millis() - batchStart >= MQTT_BATCH_SECONDS * 1000UL) {
+    batchStart = millis();
+#if MQTT_BATCH_WAVE
+    telemetryAddWave(telemetryBatch, nowMs, waveHistory, &telemetryWaveCursor, sampleIntervalMs);
+#endif
+    mqttPublishBatch(nowMs);
+  }
+}
+
+/**
+ * Service the connection and publish; returns immediately while the broker
+ * is unreachable. Telemetry keeps being batched either way and frames that
+ * can't be sent go to the flash log (telemetry_log.h) until it can.
+ */
+void mqttLoopAndPublish() {
+#if MQTT_BATCH_SECONDS > 0
+  if (mqttService()) mqttDrainBacklog();
+  mqttBatchTelemetry();
+#else
+  bool connected = mqttService();
   static unsigned long lastMqtt = 0;
-  if (millis() - lastMqtt > 1000) {
+  if (connected && millis() - lastMqtt > 1000) {
     lastMqtt = millis();
-    char payload[256];
-    // Generate ISO8601 timestamp (placeholder, replace with RTC or NTP if available)
-    char timestamp[32];
-    snprintf(timestamp, sizeof(timestamp), "2025-01-28T10:43:51.123Z"); // TODO: Replace with real time if available
-    snprintf(payload, sizeof(payload),
-             "{\"userId\":\"BW8NUP21AWMkI0xrrI2nxBP6Xd92\",\"dataType\":\"heartRate\",\"bpm\":%d,\"signal\":%d,\"timestamp\":\"%s\",\"deviceId\":\"ESP8266_001\"}",
-             heartRate, signalValue, timestamp);
-    mqttClient.publish(mqtt_topic, payload);
+    if (!mqttReportDue(detectorTimeMs())) return;
+    FixedText<256> payload;
+    textPrintf(payload,
+               "{\"userId\":\"" MQTT_USER_ID "\",\"dataType\":\"heartRate\",\"bpm\":%d,\"signal\":%d,"
+               "\"quality\":%d,\"sdnn\":%.1f,\"rmssd\":%.1f,\"pnn50\":%.1f,\"timestamp\":",
+               mqttReportedBpm(), signalValue, signalQualityIndex,
+               beatStatsSdnnMs(beatStats), beatStatsRmssdMs(beatStats), beatStatsPnn50(beatStats));
+    // UTC of the newest sample; null until the clock has synchronised
+    uint64_t epochUs = detectorEpochUs(lastSampleTick * sampleIntervalUs);
+    if (epochUs) {
+      textAppend(payload, "\"");
+      textAppendIso8601(payload, epochUs);
+      textAppend(payload, "\"");
+    } else {
+      textAppend(payload, "null");
+    }
+    textAppend(payload, ",\"deviceId\":\"" MQTT_DEVICE_ID "\"}");
+    if (mqttClient.publish(mqtt_topic, payload.data) && !mqttFirstPublishMs) mqttFirstPublishMs = millis();
     Serial.print("[MQTT] Published: ");
-    Serial.println(payload);
+    Serial.println(payload.data);
   }
+#endif
 }
 
 #endif // MQTT_PUBLISH_H
@@ -0,0 +1,132 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "text_buffer.h"
+
+/*
+ * Cycle-counting probes and Prometheus text output
+ * ================================================
+ * PROFILE_PROBE(var, "name") defines a probe; PROFILE_SCOPE(var) inside a
+ * block times that block with ESP.getCycleCount() (one register read at
+ * each end) and files the result in a fixed log2 histogram. Probes register
+ * themselves, so /metrics can list them without a table to keep in sync.
+ *
+ * Building with -D HR_PROFILE=0 turns both macros into nothing: no probe
+ * storage, no cycle reads, no histogram updates. The plain counters and
+ * gauges on /metrics are unaffected.
+ *
+ * The cycle counter wraps every ~53 s at 80 MHz; a single scope is far
+ * shorter, so the unsigned difference is always right.
+ */
+
+#ifndef HR_PROFILE
+#define HR_PROFILE 1
+#endif
+
+#ifndef PROFILE_MAX_PROBES
+#define PROFILE_MAX_PROBES 12
+#endif
+
+const int profileBuckets = 16;           // < 2^8 cycles, < 2^9, ... < 2^22, rest
+const int profileFirstShift = 8;         // 256 cycles = 3.2 us at 80 MHz
+
+struct ProfileProbe;
+ProfileProbe* profileProbes[PROFILE_MAX_PROBES];
+uint8_t profileProbeCount = 0;
+
+struct ProfileProbe {
+  const char* name;
+  uint32_t count;
+  uint64_t cycles;               // Total, for the histogram _sum
+  uint32_t maxCycles;
+  uint32_t histogram[profileBuckets];
+
+  explicit ProfileProbe(const char* probeName) : name(probeName), count(0), cycles(0), maxCycles(0) {
+    memset(histogram, 0, sizeof(histogram));
+    if (profileProbeCount < PROFILE_MAX_PROBES) profileProbes[profileProbeCount++] = this;
+  }
+
+  inline void record(uint32_t elapsed) {
+    count++;
+    cycles += elapsed;
+    if (elapsed > maxCycles) maxCycles = elapsed;
+    uint32_t scaled = elapsed >> profileFirstShift;
+    int bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    histogram[bucket < profileBuckets ? bucket : profileBuckets - 1]++;
+  }
+};
+
+struct ProfileScope {
+  ProfileProbe& probe;
+  uint32_t start;
+  explicit ProfileScope(ProfileProbe& p) : probe(p), start(ESP.getCycleCount()) {}
+  ~ProfileScope() { probe.record(ESP.getCycleCount() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if HR_PROFILE
+#define PROFILE_PROBE(var, name) ProfileProbe var(name)
+#define PROFILE_SCOPE(var) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(var)
+#else
+#define PROFILE_PROBE(var, name)
+#define PROFILE_SCOPE(var)
+#endif
+
+// ========================= PROMETHEUS TEXT =========================
+// Written to a TextBuffer with a sink, so the exposition streams out in
+// chunks however many probes and tasks there are.
+
+/**
+ * HELP and TYPE header for a metric family
+ */
+void metricsFamily(TextBuffer& w, const char* name, const char* type, const char* help) {
+  textPrintf(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/**
+ * One log2 histogram as Prometheus cumulative buckets in seconds
+ * @param edgeSeconds Upper edge of bucket 0; each next edge doubles
+ * @param sumSeconds Sum of all observations
+ */
+void metricsHistogram(TextBuffer& w, const char* name, const char* labels,
+                      const uint32_t* histogram, int buckets, double edgeSeconds,
+                      double sumSeconds, uint32_t count) {
+  uint32_t cumulative = 0;
+  double edge = edgeSeconds;
+  for (int b = 0; b < buckets - 1; b++, edge *= 2) {
+    cumulative += histogram[b];
+    textPrintf(w, "%s_bucket{%s,le=\"%.3g\"} %u\n", name, labels, edge, (unsigned)cumulative);
+  }
+  textPrintf(w, "%s_bucket{%s,le=\"+Inf\"} %u\n", name, labels, (unsigned)count);
+  textPrintf(w, "%s_sum{%s} %.6f\n", name, labels, sumSeconds);
+  textPrintf(w, "%s_count{%s} %u\n", name, labels, (unsigned)count);
+}
+
+/**
+ * Every registered probe as the hr_probe_seconds histogram family
+ */
+void metricsProbes(TextBuffer& w) {
+#if HR_PROFILE
+  double secondsPerCycle = 1.0 / (ESP.getCpuFreqMHz() * 1e6);
+  metricsFamily(w, "hr_probe_seconds", "histogram", "Time spent in instrumented code paths");
+  for (uint8_t i = 0; i < profileProbeCount; i++) {
+    const ProfileProbe& p = *profileProbes[i];
+    char labels[40];
+    snprintf(labels, sizeof(labels), "probe=\"%s\"", p.name);
+    metricsHistogram(w, "hr_probe_seconds", labels, p.histogram, profileBuckets,
+                     (1UL << profileFirstShift) * secondsPerCycle, p.cycles * secondsPerCycle, p.count);
+  }
+  metricsFamily(w, "hr_probe_max_seconds", "gauge", "Longest single run of each probe");
+  for (uint8_t i = 0; i < profileProbeCount; i++) {
+    textPrintf(w, "hr_probe_max_seconds{probe=\"%s\"} %.6f\n", profileProbes[i]->name,
+                  profileProbes[i]->maxCycles * secondsPerCycle);
+  }
+#else
+  (void)w;
+#endif
+}
+
+#endif // PROFILER_H
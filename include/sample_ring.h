@@ -0,0 +1,112 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/*
+ * Single-producer / single-consumer lock-free sample ring
+ * =======================================================
+ * The timer ISR is the only writer of `head`, loop() is the only writer of
+ * `tail`. Both indices run freely and are masked on access, so no lock or
+ * interrupt masking is needed on the single-core ESP8266.
+ *
+ * Each slot packs one sample into a single 32-bit word so the ISR publishes
+ * it with one aligned store:
+ *   bits 31..16  low 16 bits of the sample tick (sample number)
+ *   bits 15..0   ADC value x 8 (13 bits, 0..8184), with or without
+ *                oversampling (see acqSampleFractionBits in acquisition.h)
+ * The consumer widens the tick back to 32 bits, so dropped samples show up
+ * as gaps in the tick sequence instead of silently shifting beat timing.
+ *
+ * The producer side runs in the timer ISR, so it is forced inline and, in
+ * case the compiler keeps a copy anyway, placed in IRAM (see
+ * acquisition.h).
+ */
+
+#ifndef SAMPLE_RING_SIZE
+#define SAMPLE_RING_SIZE 512       // Must be a power of two (10.24 s at 50 Hz, enough to
+                                   // ride out a blocking TLS connect)
+#endif
+
+#if (SAMPLE_RING_SIZE & (SAMPLE_RING_SIZE - 1)) != 0
+#error "SAMPLE_RING_SIZE must be a power of two"
+#endif
+
+// Compiler barrier: keeps slot writes/reads ordered against index updates
+#define SAMPLE_RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+struct SampleRing {
+  volatile uint32_t slots[SAMPLE_RING_SIZE];
+  volatile uint32_t head;      // Written by producer only
+  volatile uint32_t tail;      // Written by consumer only
+  volatile uint32_t overruns;  // Samples dropped because the ring was full
+};
+
+/**
+ * Pack a tick and an ADC x 8 value into one ring slot
+ */
+__attribute__((always_inline)) inline IRAM_ATTR uint32_t sampleRingPack(uint32_t tick, uint16_t value) {
+  return (tick << 16) | value;
+}
+
+/**
+ * Producer side (ISR context). Drops the sample and counts an overrun when
+ * the consumer has fallen a full ring behind.
+ * @return true if the sample was stored
+ */
+__attribute__((always_inline)) inline IRAM_ATTR bool sampleRingPush(SampleRing& ring, uint32_t tick,
+                                                                   uint16_t value) {
+  uint32_t head = ring.head;
+  if (head - ring.tail >= SAMPLE_RING_SIZE) {
+    ring.overruns = ring.overruns + 1;
+    return false;
+  }
+  ring.slots[head & (SAMPLE_RING_SIZE - 1)] = sampleRingPack(tick, value);
+  SAMPLE_RING_BARRIER();
+  ring.head = head + 1;
+  return true;
+}
+
+/**
+ * Consumer side (loop context). Copies up to maxCount packed slots into out.
+ * @return number of slots copied
+ */
+inline uint16_t sampleRingPop(SampleRing& ring, uint32_t* out, uint16_t maxCount) {
+  uint32_t tail = ring.tail;
+  uint32_t available = ring.head - tail;
+  SAMPLE_RING_BARRIER();
+  uint16_t count = available < maxCount ? (uint16_t)available : maxCount;
+  for (uint16_t i = 0; i < count; i++) {
+    out[i] = ring.slots[(tail + i) & (SAMPLE_RING_SIZE - 1)];
+  }
+  SAMPLE_RING_BARRIER();
+  ring.tail = tail + count;
+  return count;
+}
+
+/**
+ * Number of samples waiting for the consumer
+ */
+inline uint32_t sampleRingLevel(const SampleRing& ring) {
+  return ring.head - ring.tail;
+}
+
+/**
+ * Unpack the ADC x 8 value from a ring slot
+ */
+inline uint16_t sampleRingValue(uint32_t slot) {
+  return (uint16_t)(slot & 0xFFFF);
+}
+
+/**
+ * Widen the 16-bit tick in a ring slot to 32 bits, relative to the last
+ * tick the consumer saw. Valid as long as fewer than 65536 samples are
+ * skipped between two drains.
+ */
+inline uint32_t sampleRingTick(uint32_t slot, uint32_t lastTick) {
+  uint16_t delta = (uint16_t)((slot >> 16) - (lastTick & 0xFFFF));
+  return lastTick + delta;
+}
+
+#endif // SAMPLE_RING_H
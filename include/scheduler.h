@@ -0,0 +1,129 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+/*
+ * Cooperative deadline-aware scheduler
+ * ====================================
+ * Each task is released once per period and must finish before the next
+ * release (its deadline). schedulerRun() picks one released task per call:
+ * the lowest priority number first, the earliest deadline among equals, so
+ * a slow low-priority task can delay the others by at most its own run
+ * time. With nothing released it yields to the WiFi stack instead of
+ * sleeping a fixed delay.
+ *
+ * Tasks are never preempted. Every run is timed: a fixed log2 histogram
+ * per task, the worst case, runs over the task's budget, and deadline
+ * misses. A task that falls more than a period behind skips the missed
+ * releases rather than running back to back to catch up.
+ */
+
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS 10
+#endif
+
+const int schedHistogramBuckets = 10;      // < 64 us, < 128 us, ... < 16 ms, rest
+const int schedHistogramShift = 6;         // First bucket edge: 1 << 6 us
+
+struct SchedTask {
+  const char* name;
+  void (*run)();
+  uint32_t periodUs;
+  uint32_t budgetUs;             // Expected worst case for one run
+  uint8_t priority;              // 0 = most urgent
+  uint32_t releaseUs;            // Start of the current period
+
+  uint32_t runs;
+  uint32_t misses;               // Finished after the deadline
+  uint32_t overBudget;           // Ran longer than budgetUs
+  uint32_t skipped;              // Releases dropped after falling behind
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t histogram[schedHistogramBuckets];
+};
+
+SchedTask schedTasks[SCHED_MAX_TASKS];
+uint8_t schedTaskCount = 0;
+uint32_t schedIdlePasses = 0;      // schedulerRun() calls that found nothing due
+
+/**
+ * Register a task, first released immediately
+ * @return task index, or -1 if the table is full
+ */
+int schedulerAdd(const char* name, void (*run)(), uint32_t periodMs, uint8_t priority,
+                 uint32_t budgetUs) {
+  if (schedTaskCount >= SCHED_MAX_TASKS) return -1;
+  SchedTask& t = schedTasks[schedTaskCount];
+  memset(&t, 0, sizeof(t));
+  t.name = name;
+  t.run = run;
+  t.periodUs = periodMs * 1000;
+  t.priority = priority;
+  t.budgetUs = budgetUs;
+  t.releaseUs = micros();
+  return schedTaskCount++;
+}
+
+/**
+ * Histogram bucket for a run time
+ */
+inline int schedBucket(uint32_t us) {
+  uint32_t scaled = us >> schedHistogramShift;
+  if (scaled == 0) return 0;
+  int bucket = 32 - __builtin_clz(scaled);
+  return bucket < schedHistogramBuckets ? bucket : schedHistogramBuckets - 1;
+}
+
+/**
+ * Upper edge of a histogram bucket in us (0 for the open-ended last one)
+ */
+inline uint32_t schedBucketEdgeUs(int bucket) {
+  return bucket < schedHistogramBuckets - 1 ? (1UL << (schedHistogramShift + bucket)) : 0;
+}
+
+/**
+ * Run the most urgent released task, or yield if none is due. Call from
+ * loop().
+ */
+void schedulerRun() {
+  uint32_t now = micros();
+  SchedTask* next = nullptr;
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    SchedTask& t = schedTasks[i];
+    if ((int32_t)(now - t.releaseUs) < 0) continue;
+    if (!next || t.priority < next->priority ||
+        (t.priority == next->priority &&
+         (int32_t)((t.releaseUs + t.periodUs) - (next->releaseUs + next->periodUs)) < 0)) {
+      next = &t;
+    }
+  }
+  if (!next) {
+    schedIdlePasses++;
+    yield();
+    return;
+  }
+
+  uint32_t start = micros();
+  next->run();
+  uint32_t end = micros();
+  uint32_t elapsed = end - start;
+
+  next->runs++;
+  next->lastUs = elapsed;
+  next->totalUs += elapsed;
+  if (elapsed > next->maxUs) next->maxUs = elapsed;
+  if (elapsed > next->budgetUs) next->overBudget++;
+  next->histogram[schedBucket(elapsed)]++;
+
+  uint32_t deadline = next->releaseUs + next->periodUs;
+  if ((int32_t)(end - deadline) > 0) next->misses++;
+  next->releaseUs = deadline;
+  if ((int32_t)(end - next->releaseUs) >= (int32_t)next->periodUs) {
+    next->skipped += (end - next->releaseUs) / next->periodUs;
+    next->releaseUs = end;
+  }
+}
+
+#endif // SCHEDULER_H
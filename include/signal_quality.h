@@ -0,0 +1,272 @@
+#ifndef SIGNAL_QUALITY_H
+#define SIGNAL_QUALITY_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "heart_rate_detector.h"
+
+/*
+ * Signal quality index
+ * ====================
+ * How far a channel's reading can be trusted, from four measures scored in
+ * permille:
+ *
+ *   perfusion    pulse amplitude (the detector envelope): 0 at half the
+ *                detector's minPulseAmplitude, full from sqiGoodAmplitude.
+ *                The perfusion index (envelope over the mean raw level)
+ *                is kept alongside for display.
+ *   correlation  shape of each beat: the correlation of the 400 ms of
+ *                filtered signal around its peak with a running template
+ *                of earlier beats. Motion artefacts that get past the
+ *                detector rarely look like a pulse wave.
+ *   clipping     share of raw samples within sqiClipMargin of either ADC
+ *                rail; sqiClipZero permille clipped scores 0.
+ *   consistency  share of recent intervals the IBI statistics accepted
+ *                (range and median outlier checks, beat_stats.h).
+ *
+ * Per-beat measures are averaged over the last ~4 beats and clipping over
+ * the last ~2 s. heart_rate.h combines them for the estimator it reports.
+ *
+ * The template only learns from beats that already resemble it; after
+ * sqiReseedMismatches unlike beats in a row it is replaced, so a first
+ * beat that was an artefact can't lock it.
+ *
+ * Report by exception: ReportGate decides which once-a-second readings are
+ * worth publishing at all (see reportGateCheck()).
+ *
+ * Cost per sample: a store and two compares; per beat, 3 x segment
+ * multiply-adds and a square root; per second, a few divides.
+ */
+
+#ifndef SQI_MIN
+#define SQI_MIN 50                 // Quality index (0-100) needed to publish a reading
+#endif
+
+const int32_t sqiPoorAmplitude = minPulseAmplitude / 2;  // Envelope scoring no perfusion
+const int32_t sqiGoodAmplitude = 4 * minPulseAmplitude;  // Envelope scoring full perfusion
+const int sqiClipMargin = 4;       // ADC counts from either rail that count as clipped
+const int32_t sqiClipZero = 100;   // Permille of clipped samples that scores 0
+const int32_t sqiPoorCorrelation = 600;  // Beat correlation (permille) scoring 0 ...
+const int32_t sqiGoodCorrelation = 950;  // ... and full marks
+const int32_t sqiMatchCorrelation = 500;  // Beats at least this alike refine the template
+const uint8_t sqiReseedMismatches = 4;    // Unlike beats in a row that replace it
+const int sqiBeatSmoothing = 4;    // Per-beat scores: moving average over ~4 beats
+const int sqiSecondSmoothing = 2;  // Clipping: over ~2 s
+
+/**
+ * Quality measures of one channel
+ */
+template <int SampleRateHz>
+struct SignalQuality {
+  static constexpr int segment = SampleRateHz * 2 / 5;   // 400 ms of signal per beat,
+  static constexpr int afterPeak = SampleRateHz / 10;    // 100 ms of it after the peak
+  static_assert(segment >= 4 && segment <= 255, "beat segment must be 4..255 samples");
+
+  int16_t recent[segment];       // Filtered samples, oldest at head
+  int16_t beatTemplate[segment];
+  uint8_t head;
+  uint8_t pending;               // Samples until the newest beat's segment is complete, 0 = none
+  uint8_t mismatches;            // Consecutive beats unlike the template
+  bool hasTemplate;
+  uint32_t seenBeats;
+  uint32_t seenIntervals;        // Accepted + rejected intervals already scored
+  uint32_t seenAccepted;
+  uint16_t samples;              // Counted this second
+  uint16_t clipped;
+  uint32_t levelSum;
+
+  int16_t beatCorrelation;       // Newest beat against the template, permille
+  uint16_t perfusionIndex;       // Envelope / mean level, 0.01 % units
+  // Scores, permille
+  int16_t perfusion;
+  int16_t correlation;
+  int16_t clipping;
+  int16_t consistency;
+};
+
+template <int R>
+void sqiReset(SignalQuality<R>& q) {
+  memset(&q, 0, sizeof(q));
+  q.clipping = 1000;
+}
+
+inline int16_t sqiClamp(int32_t v) {
+  return (int16_t)(v < 0 ? 0 : (v > 1000 ? 1000 : v));
+}
+
+/**
+ * Move a score a 1/n step towards target
+ */
+inline void sqiSmooth(int16_t& score, int32_t target, int n) {
+  score = (int16_t)(score + (target - score) / n);
+}
+
+/**
+ * Correlation of the newest beat's segment with the template, permille
+ */
+template <int R>
+int32_t sqiCorrelate(const SignalQuality<R>& q, const int16_t* segment) {
+  const int n = SignalQuality<R>::segment;
+  int64_t sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+  for (int i = 0; i < n; i++) {
+    int32_t x = segment[i], y = q.beatTemplate[i];
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    syy += y * y;
+    sxy += x * y;
+  }
+  double vx = (double)(sxx * n - sx * sx);
+  double vy = (double)(syy * n - sy * sy);
+  if (vx <= 0 || vy <= 0) return 0;
+  return (int32_t)(1000.0 * (double)(sxy * n - sx * sy) / sqrt(vx * vy));
+}
+
+/**
+ * Score the newest beat's segment and update the template from it
+ */
+template <int R>
+__attribute__((noinline)) void sqiScoreBeat(SignalQuality<R>& q) {
+  const int n = SignalQuality<R>::segment;
+  int16_t segment[n];
+  for (int i = 0; i < n; i++) {
+    int k = q.head + i;
+    segment[i] = q.recent[k >= n ? k - n : k];
+  }
+
+  if (!q.hasTemplate || q.mismatches >= sqiReseedMismatches) {
+    memcpy(q.beatTemplate, segment, sizeof(segment));
+    q.hasTemplate = true;
+    q.mismatches = 0;
+    return;
+  }
+  int32_t r = sqiCorrelate(q, segment);
+  q.beatCorrelation = (int16_t)r;
+  sqiSmooth(q.correlation, sqiClamp((r - sqiPoorCorrelation) * 1000 / (sqiGoodCorrelation - sqiPoorCorrelation)),
+            sqiBeatSmoothing);
+  if (r >= sqiMatchCorrelation) {
+    q.mismatches = 0;
+    for (int i = 0; i < n; i++) {
+      q.beatTemplate[i] += (segment[i] - q.beatTemplate[i]) / 4;
+    }
+  } else {
+    q.mismatches++;
+  }
+}
+
+/**
+ * Close a second: clipping and perfusion scores
+ */
+template <int R>
+void sqiSecond(SignalQuality<R>& q, const DetectorChannel& c) {
+  int32_t clippedPermille = (int32_t)q.clipped * 1000 / q.samples;
+  sqiSmooth(q.clipping, sqiClamp(1000 - clippedPermille * 1000 / sqiClipZero), sqiSecondSmoothing);
+  q.perfusion = sqiClamp((c.envelope - sqiPoorAmplitude) * 1000 / (sqiGoodAmplitude - sqiPoorAmplitude));
+  uint32_t level = q.levelSum / q.samples;
+  uint32_t index = c.envelope > 0 && level ? (uint32_t)c.envelope * (10000 / 8) / level : 0;
+  q.perfusionIndex = (uint16_t)(index > 65535 ? 65535 : index);
+  q.samples = 0;
+  q.clipped = 0;
+  q.levelSum = 0;
+}
+
+/**
+ * Account for the sample a channel of the detector just processed
+ */
+template <int R, int C, int W, int M>
+void sqiPush(SignalQuality<R>& q, const HeartRateDetector<R, C, W, M>& d, int ch) {
+  const DetectorChannel& c = d.channel[ch];
+  const DetectorBeats<W, M>& b = d.beats[ch];
+
+  q.recent[q.head] = (int16_t)(c.filtered > INT16_MAX ? INT16_MAX : (c.filtered < INT16_MIN ? INT16_MIN : c.filtered));
+  q.head = q.head + 1 == SignalQuality<R>::segment ? 0 : q.head + 1;
+  q.samples++;
+  q.levelSum += c.signal;
+  if (c.signal <= sqiClipMargin || c.signal >= 1023 - sqiClipMargin) q.clipped++;
+
+  // A new beat peaked one sample back; wait for the rest of its segment
+  if (b.beatCount != q.seenBeats) {
+    q.seenBeats = b.beatCount;
+    q.pending = SignalQuality<R>::afterPeak;
+  }
+  if (q.pending && --q.pending == 0) sqiScoreBeat(q);
+
+  uint32_t intervals = b.stats.accepted + b.stats.rejected;
+  if (intervals != q.seenIntervals) {
+    q.seenIntervals = intervals;
+    sqiSmooth(q.consistency, b.stats.accepted != q.seenAccepted ? 1000 : 0, sqiBeatSmoothing);
+    q.seenAccepted = b.stats.accepted;
+  }
+
+  if (q.samples >= R) sqiSecond(q, c);
+}
+
+/**
+ * Combined score for a beat-based reading, permille: the mean of
+ * perfusion, beat shape and rhythm, capped by clipping. A weak but clean
+ * pulse still passes; a weak one that is also irregular does not.
+ */
+template <int R>
+inline int32_t sqiBeatScore(const SignalQuality<R>& q) {
+  int32_t score = (q.perfusion + q.correlation + q.consistency) / 3;
+  return q.clipping < score ? q.clipping : score;
+}
+
+// ========================= REPORT BY EXCEPTION =========================
+
+#ifndef REPORT_DEADBAND_BPM
+#define REPORT_DEADBAND_BPM 2      // Publish when the BPM moves by more than this
+#endif
+
+#ifndef REPORT_KEEPALIVE_S
+#define REPORT_KEEPALIVE_S 60      // ... or when nothing was published for this long
+#endif
+
+enum ReportReason { REPORT_NONE, REPORT_FIRST, REPORT_QUALITY, REPORT_CHANGE, REPORT_KEEPALIVE };
+
+struct ReportGate {
+  bool started;
+  bool adequate;                 // Quality at the last report
+  int bpm;                       // BPM at the last report (0 while quality was poor)
+  uint32_t lastMs;
+  uint32_t reports;
+  uint32_t suppressed;
+};
+
+/**
+ * Decide whether a reading is worth publishing: the first one, one where
+ * the quality crossed SQI_MIN either way, one that moved more than
+ * REPORT_DEADBAND_BPM from the last published value while the quality is
+ * adequate, or a keepalive after REPORT_KEEPALIVE_S of silence. Readings
+ * of poor quality only go out as transitions and keepalives; publish them
+ * with BPM 0.
+ * @param quality Quality index, 0-100
+ */
+ReportReason reportGateCheck(ReportGate& g, uint32_t nowMs, int bpm, int quality) {
+  bool adequate = bpm > 0 && quality >= SQI_MIN;
+  if (!adequate) bpm = 0;
+  ReportReason reason = REPORT_NONE;
+  if (!g.started) {
+    reason = REPORT_FIRST;
+  } else if (adequate != g.adequate) {
+    reason = REPORT_QUALITY;
+  } else if (adequate && abs(bpm - g.bpm) > REPORT_DEADBAND_BPM) {
+    reason = REPORT_CHANGE;
+  } else if (nowMs - g.lastMs >= REPORT_KEEPALIVE_S * 1000UL) {
+    reason = REPORT_KEEPALIVE;
+  }
+
+  if (reason == REPORT_NONE) {
+    g.suppressed++;
+    return reason;
+  }
+  g.started = true;
+  g.adequate = adequate;
+  g.bpm = bpm;
+  g.lastMs = nowMs;
+  g.reports++;
+  return reason;
+}
+
+#endif // SIGNAL_QUALITY_H
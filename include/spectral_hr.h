@@ -0,0 +1,237 @@
+#ifndef SPECTRAL_HR_H
+#define SPECTRAL_HR_H
+
+#include <stdint.h>
+#include <string.h>
+#include "dsp_filter.h"
+
+/*
+ * Spectral heart rate estimator
+ * =============================
+ * A second, independent heart rate estimate: the dominant frequency of the
+ * band-passed signal in 0.5-4 Hz over the last SPECTRAL_WINDOW_S seconds.
+ * It does not need clean threshold crossings, so it keeps tracking a weak
+ * or noisy pulse that the peak detector has lost.
+ *
+ * The detector's filtered output is decimated to 10 Hz (its 4 Hz
+ * low-pass already removes what would alias) and fed to a bank of sliding
+ * DFT bins, one every 1/16 Hz (half the window's resolution). Each bin is
+ * updated in O(1) per decimated sample instead of being recomputed:
+ *
+ *   X(n) = x(n) + v X(n-1) - v^N x(n-N),   v = r e^(-j w)
+ *
+ * with Q30 coefficients computed at compile time. r = 1 - 2^-10 damps the
+ * rounding error of the fixed-point recursion, which would otherwise
+ * accumulate forever; the oldest sample in the window keeps r^N = 92% of
+ * its weight.
+ *
+ * Once a second the bin powers are scanned. A pulse wave is not a sine:
+ * its second and third harmonics (also in band below ~80 BPM) can
+ * outweigh the fundamental. So each visible bin is scored by its power
+ * plus that at twice and three times its frequency, the best candidate is
+ * refined by a parabola through its neighbours. The confidence is the
+ * share of band power at it and its harmonics beyond what the noise floor
+ * (the mean of the other bins) accounts for, so noise alone scores near 0.
+ *
+ * Cost per input sample at 50 Hz: one add, and every 5th sample
+ * spectralBins complex multiply-adds; plus one scan per second.
+ */
+
+#ifndef SPECTRAL_WINDOW_S
+#define SPECTRAL_WINDOW_S 8          // Analysis window, seconds
+#endif
+
+const int spectralRateHz = 10;       // Rate the bins are updated at
+const int spectralWindow = SPECTRAL_WINDOW_S * spectralRateHz;
+const int spectralBinsPerHz = 16;    // Bin spacing 1/16 Hz
+const int spectralFirstBin = spectralBinsPerHz / 2;    // 0.5 Hz
+const int spectralBins = 4 * spectralBinsPerHz - spectralFirstBin + 1;  // .. 4 Hz
+const int spectralCoeffShift = 30;
+const int spectralDampShift = 10;    // r = 1 - 2^-10
+const int spectralPeakSpan = 2;      // Bins either side counted as the peak
+const uint32_t spectralVisibleRatio = 8;  // A fundamental needs 1/8 of the strongest bin's power
+const uint32_t spectralMinPower = 16;     // Fundamental below ~2.5 ADC counts of pulse: no estimate
+
+/**
+ * Q30 coefficients of one bin: v and v^N
+ */
+struct SpectralCoeffs {
+  int32_t vr, vi;
+  int32_t vnr, vni;
+};
+
+struct SpectralTable {
+  SpectralCoeffs bin[spectralBins];
+};
+
+constexpr int32_t spectralQ30(double v) {
+  return (int32_t)(v >= 0 ? v * (1L << spectralCoeffShift) + 0.5
+                          : v * (1L << spectralCoeffShift) - 0.5);
+}
+
+constexpr SpectralTable spectralDesign() {
+  SpectralTable t{};
+  double r = 1.0 - 1.0 / (1 << spectralDampShift);
+  double rN = 1.0;
+  for (int i = 0; i < spectralWindow; i++) rN *= r;
+  for (int k = 0; k < spectralBins; k++) {
+    double w = 2.0 * dspPi * (spectralFirstBin + k) / spectralBinsPerHz / spectralRateHz;
+    t.bin[k].vr = spectralQ30(r * dspCos(w));
+    t.bin[k].vi = spectralQ30(-r * dspSin(w));
+    t.bin[k].vnr = spectralQ30(rN * dspCos(w * spectralWindow));
+    t.bin[k].vni = spectralQ30(-rN * dspSin(w * spectralWindow));
+  }
+  return t;
+}
+
+constexpr SpectralTable spectralTable = spectralDesign();
+
+/**
+ * Sliding DFT state for one input stream
+ */
+template <int SampleRateHz>
+struct SpectralEstimator {
+  static_assert(SampleRateHz % spectralRateHz == 0, "input rate must be a multiple of 10 Hz");
+  static constexpr int decimation = SampleRateHz / spectralRateHz;
+
+  int32_t re[spectralBins];
+  int32_t im[spectralBins];
+  int16_t history[spectralWindow];   // Decimated input, oldest at head
+  uint16_t head;
+  uint16_t filled;                   // Decimated samples seen, up to the window
+  int32_t accumulator;
+  uint8_t phase;                     // Input samples in the accumulator
+  uint8_t sinceEstimate;             // Decimated samples since the last scan
+
+  // Latest estimate, refreshed once a second
+  uint16_t bpmX10;                   // 0 until the window has filled
+  uint16_t confidence;               // Permille of band power in the peak above the noise floor
+  bool harmonic;                     // A harmonic was stronger than the fundamental reported
+  uint32_t estimates;
+};
+
+template <int R>
+void spectralReset(SpectralEstimator<R>& s) {
+  memset(&s, 0, sizeof(s));
+}
+
+/**
+ * Power of a bin, scaled down to fit 32 bits
+ */
+template <int R>
+inline uint32_t spectralPower(const SpectralEstimator<R>& s, int k) {
+  int64_t p = (int64_t)s.re[k] * s.re[k] + (int64_t)s.im[k] * s.im[k];
+  return (uint32_t)(p >> 10 > 0xFFFFFFFFLL ? 0xFFFFFFFFLL : p >> 10);
+}
+
+/**
+ * Power near absolute bin a (in 1/16 Hz), allowing one bin of smear, or 0
+ * outside the band
+ */
+inline uint32_t spectralNear(const uint32_t* power, int a) {
+  int k = a - spectralFirstBin;
+  uint32_t p = 0;
+  for (int i = k - 1; i <= k + 1; i++) {
+    if (i >= 0 && i < spectralBins && power[i] > p) p = power[i];
+  }
+  return p;
+}
+
+/**
+ * Scan the bins for the fundamental: the candidate whose harmonics (up to
+ * the third, where they fall in band) carry the most power, among those
+ * that are themselves clearly visible
+ */
+template <int R>
+void spectralEstimate(SpectralEstimator<R>& s) {
+  uint32_t power[spectralBins];
+  uint64_t total = 0;
+  uint32_t strongest = 0;
+  for (int k = 0; k < spectralBins; k++) {
+    power[k] = spectralPower(s, k);
+    total += power[k];
+    if (power[k] > strongest) strongest = power[k];
+  }
+  s.estimates++;
+  if (total == 0) {
+    s.bpmX10 = 0;
+    s.confidence = 0;
+    return;
+  }
+
+  int peak = 0;
+  uint64_t best = 0;
+  for (int k = 0; k < spectralBins; k++) {
+    if (power[k] < strongest / spectralVisibleRatio) continue;
+    int a = spectralFirstBin + k;
+    uint64_t score = (uint64_t)power[k] + spectralNear(power, 2 * a) + spectralNear(power, 3 * a);
+    if (score > best) {
+      best = score;
+      peak = k;
+    }
+  }
+  s.harmonic = power[peak] < strongest;
+
+  // Confidence: share of band power at the fundamental and its harmonics,
+  // less what the noise floor of the other bins would put there anyway
+  uint64_t inPeak = 0;
+  int counted = 0;
+  int fundamental = spectralFirstBin + peak;
+  for (int k = 0; k < spectralBins; k++) {
+    int a = spectralFirstBin + k;
+    int h = (a + fundamental / 2) / fundamental;
+    if (h >= 1 && h <= 3 && abs(a - h * fundamental) <= spectralPeakSpan) {
+      inPeak += power[k];
+      counted++;
+    }
+  }
+  uint64_t floor = counted < spectralBins ? (total - inPeak) * counted / (spectralBins - counted) : 0;
+  s.confidence = inPeak > floor && power[peak] >= spectralMinPower
+                     ? (uint16_t)((inPeak - floor) * 1000 / total) : 0;
+
+  // Parabolic refinement between neighbouring bins
+  float offset = 0;
+  if (peak > 0 && peak < spectralBins - 1) {
+    float a = power[peak - 1], b = power[peak], c = power[peak + 1];
+    float curvature = a - 2 * b + c;
+    if (curvature < 0) offset = 0.5f * (a - c) / curvature;
+  }
+  float hz = (spectralFirstBin + peak + offset) / spectralBinsPerHz;
+  s.bpmX10 = (uint16_t)(hz * 600.0f + 0.5f);
+}
+
+/**
+ * Feed one band-passed sample (the detector's filtered value)
+ */
+template <int R>
+void spectralPush(SpectralEstimator<R>& s, int32_t filtered) {
+  s.accumulator += filtered;
+  if (++s.phase < SpectralEstimator<R>::decimation) return;
+  int32_t x = s.accumulator / SpectralEstimator<R>::decimation;
+  x = x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+  s.accumulator = 0;
+  s.phase = 0;
+
+  int32_t old = s.history[s.head];
+  s.history[s.head] = (int16_t)x;
+  s.head = s.head + 1 == spectralWindow ? 0 : s.head + 1;
+  const int64_t round = 1LL << (spectralCoeffShift - 1);
+  for (int k = 0; k < spectralBins; k++) {
+    const SpectralCoeffs& c = spectralTable.bin[k];
+    int64_t re = (int64_t)c.vr * s.re[k] - (int64_t)c.vi * s.im[k] - (int64_t)c.vnr * old;
+    int64_t im = (int64_t)c.vr * s.im[k] + (int64_t)c.vi * s.re[k] - (int64_t)c.vni * old;
+    s.re[k] = x + (int32_t)((re + round) >> spectralCoeffShift);
+    s.im[k] = (int32_t)((im + round) >> spectralCoeffShift);
+  }
+
+  if (s.filled < spectralWindow) {
+    s.filled++;
+    return;
+  }
+  if (++s.sinceEstimate >= spectralRateHz) {
+    s.sinceEstimate = 0;
+    spectralEstimate(s);
+  }
+}
+
+#endif // SPECTRAL_HR_H
@@ -2,66 +2,302 @@
 #define TELEGRAM_NOTIFY_H
 
 #include <ESP8266WiFi.h>
-#include <ESP8266HTTPClient.h>
-#include <WiFiClientSecure.h>
+#include "text_buffer.h"
+#include "tls_transport.h"
 
 // === Fill in your Telegram Bot Token and User ID ===
 #define TELEGRAM_BOT_TOKEN "5623049233:AAFX7zAZjHrsRYhAzcLiKLZ3dVWQiJHdnC8"
 #define TELEGRAM_USER_ID "-1002769415296"
 
+// Root CA of api.telegram.org's certificate chain
+static const char telegramRootCa[] PROGMEM = R"(
+-----BEGIN CERTIFICATE-----
+MIIDxTCCAq2gAwIBAgIBADANBgkqhkiG9w0BAQsFADCBgzELMAkGA1UEBhMCVVMx
+EDAOBgNVBAgTB0FyaXpvbmExEzARBgNVBAcTClNjb3R0c2RhbGUxGjAYBgNVBAoT
+EUdvRGFkZHkuY29tLCBJbmMuMTEwLwYDVQQDEyhHbyBEYWRkeSBSb290IENlcnRp
+ZmljYXRlIEF1dGhvcml0eSAtIEcyMB4XDTA5MDkwMTAwMDAwMFoXDTM3MTIzMTIz
+NTk1OVowgYMxCzAJBgNVBAYTAlVTMRAwDgYDVQQIEwdBcml6b25hMRMwEQYDVQQH
+EwpTY290dHNkYWxlMRowGAYDVQQKExFHb0RhZGR5LmNvbSwgSW5jLjExMC8GA1UE
+AxMoR28gRGFkZHkgUm9vdCBDZXJ0aWZpY2F0ZSBBdXRob3JpdHkgLSBHMjCCASIw
+DQYJKoZIhvcNAQEBBQADggEPADCCAQoCggEBAL9xYgjx+lk09xvJGKP3gElY6SKD
+E6bFIEMBO4Tx5oVJnyfq9oQbTqC023CYxzIBsQU+B07u9PpPL1kwIuerGVZr4oAH
+/PMWdYA5UXvl+TW2dE6pjYIT5LY/qQOD+qK+ihVqf94Lw7YZFAXK6sOoBJQ7Rnwy
+DfMAZiLIjWltNowRGLfTshxgtDj6AozO091GB94KPutdfMh8+7ArU6SSYmlRJQVh
+GkSBjCypQ5Yj36w6gZoOKcUcqeldHraenjAKOc7xiID7S13MMuyFYkMlNAJWJwGR
+tDtwKj9useiciAF9n9T521NtYJ2/LOdYq7hfRvzOxBsDPAnrSTFcaUaz4EcCAwEA
+AaNCMEAwDwYDVR0TAQH/BAUwAwEB/zAOBgNVHQ8BAf8EBAMCAQYwHQYDVR0OBBYE
+FDqahQcQZyi27/a9BUFuIMGU2g/eMA0GCSqGSIb3DQEBCwUAA4IBAQCZ21151fmX
+WWcDYfF+OwYxdS2hII5PZYe096acvNjpL9DbWu7PdIxztDhC2gV7+AJ1uP2lsdeu
+9tfeE8tTEH6KRtGX+rcuKxGrkLAngPnon1rpN5+r5N9ss4UXnT3ZJE95kTXWXwTr
+gIOrmgIttRD02JDHBHNA7XIloKmf7J6raBKZV8aPEjoJpL1E/QYVN8Gb5DKj7Tjo
+2GTzLH4U/ALqn83/B2gX2yKQOC16jdFU8WnjXzPKej17CuPKf1855eJ1usV2GDPO
+LPAvTK33sefOT6jEm0pUBsV/fdUID+Ic/n4XuKxe9tQWskMJDE32p2u0mYRlynqI
+4uJEvlz36hz1
+-----END CERTIFICATE-----
+)";
+
+/*
+ * Queued, non-blocking Telegram notifier
+ * ======================================
+ * Messages go into a small queue and telegramService(), called from every
+ * loop(), moves one HTTP exchange forward a step at a time: connect, write
+ * the request as the socket takes it, read the status line and headers,
+ * skip the body. Nothing waits for the network except the TLS handshake
+ * inside connect(), and that is kept short by holding the connection open
+ * (HTTP keep-alive) and resuming the saved TLS session when it has to be
+ * reopened (tls_transport.h). The connection is closed after
+ * TELEGRAM_IDLE_CLOSE_MS without traffic to give its BearSSL buffers back
+ * to the heap.
+ *
+ * Messages queued within TELEGRAM_COALESCE_MS of each other are merged into
+ * one chat message. Failed sends are retried with a doubling delay.
+ */
+
+#ifndef TELEGRAM_QUEUE_SIZE
+#define TELEGRAM_QUEUE_SIZE 4
+#endif
+
+#ifndef TELEGRAM_MESSAGE_MAX
+#define TELEGRAM_MESSAGE_MAX 200       // Bytes of text per queued message
+#endif
+
+#ifndef TELEGRAM_COALESCE_MS
+#define TELEGRAM_COALESCE_MS 3000
+#endif
+
+#ifndef TELEGRAM_TIMEOUT_MS
+#define TELEGRAM_TIMEOUT_MS 10000      // Whole exchange, after connecting
+#endif
+
+#ifndef TELEGRAM_MAX_ATTEMPTS
+#define TELEGRAM_MAX_ATTEMPTS 4
+#endif
+
+#ifndef TELEGRAM_IDLE_CLOSE_MS
+#define TELEGRAM_IDLE_CLOSE_MS 60000
+#endif
+
+const char* const telegramHost = "api.telegram.org";
+const unsigned long telegramRetryMs = 5000;
+
+enum TelegramState {
+    TELEGRAM_IDLE,
+    TELEGRAM_SENDING,                  // Writing the request
+    TELEGRAM_HEADERS,                  // Reading status line and headers
+    TELEGRAM_BODY                      // Skipping the response body
+};
+
+struct TelegramMessage {
+    char text[TELEGRAM_MESSAGE_MAX];
+    unsigned long queuedMs;
+    unsigned long retryAtMs;
+    uint8_t attempts;
+};
+
+TelegramMessage telegramQueue[TELEGRAM_QUEUE_SIZE];
+uint8_t telegramHead = 0;
+uint8_t telegramCount = 0;
+
+TlsTransport telegramTls = {telegramHost, 443, telegramRootCa, "telegram"};
+WiFiClientSecure& telegramClient = telegramTls.client;
+TelegramState telegramState = TELEGRAM_IDLE;
+char telegramRequest[3 * TELEGRAM_MESSAGE_MAX + 192];   // Fully percent-encoded text fits
+size_t telegramRequestLength = 0;
+size_t telegramRequestSent = 0;
+char telegramLine[64];                 // Current header line (truncated)
+uint8_t telegramLineLength = 0;
+int telegramStatus = 0;
+long telegramBodyLeft = 0;             // -1: until the server closes
+bool telegramCloseAfter = false;
+unsigned long telegramDeadlineMs = 0;
+unsigned long telegramLastUseMs = 0;
+
+// Counters, reported by /data
+uint32_t telegramSent = 0;
+uint32_t telegramFailed = 0;           // Dropped after TELEGRAM_MAX_ATTEMPTS
+uint32_t telegramDropped = 0;          // Queue full
+uint32_t telegramCoalesced = 0;
+
 /**
- * URL-encode a string for safe HTTP transmission
+ * Queue a message; merges it into the newest queued one if that was queued
+ * moments ago and hasn't started sending
+ * @return false if the queue was full and the message was dropped
  */
-String urlencode(const String& str);
+bool telegramEnqueue(const char* text) {
+    unsigned long now = millis();
+    if (telegramCount > 0) {
+        TelegramMessage& tail = telegramQueue[(telegramHead + telegramCount - 1) % TELEGRAM_QUEUE_SIZE];
+        bool inFlight = telegramCount == 1 && telegramState != TELEGRAM_IDLE;
+        size_t used = strlen(tail.text);
+        if (!inFlight && now - tail.queuedMs < TELEGRAM_COALESCE_MS &&
+            used + 1 + strlen(text) < TELEGRAM_MESSAGE_MAX) {
+            tail.text[used] = '\n';
+            strcpy(tail.text + used + 1, text);
+            telegramCoalesced++;
+            return true;
+        }
+    }
+    if (telegramCount == TELEGRAM_QUEUE_SIZE) {
+        telegramDropped++;
+        return false;
+    }
+    TelegramMessage& msg = telegramQueue[(telegramHead + telegramCount) % TELEGRAM_QUEUE_SIZE];
+    strncpy(msg.text, text, TELEGRAM_MESSAGE_MAX - 1);
+    msg.text[TELEGRAM_MESSAGE_MAX - 1] = '\0';
+    msg.queuedMs = now;
+    msg.retryAtMs = now;
+    msg.attempts = 0;
+    telegramCount++;
+    return true;
+}
 
 /**
- * Send a notification message to a Telegram user via bot
+ * Queue a notification message for the Telegram chat
  * @param message The message to send
- * @return true if sent successfully, false otherwise
+ * @return true if queued; delivery happens from telegramService()
  */
-bool sendTelegramNotification(const String& message) {
-    if (WiFi.status() != WL_CONNECTED) return false;
-    HTTPClient http;
-    WiFiClientSecure wifiClient;
-    wifiClient.setInsecure(); // Accept all certificates (not secure, but needed for ESP8266)
-    String url = "https://api.telegram.org/bot";
-    url += TELEGRAM_BOT_TOKEN;
-    url += "/sendMessage?chat_id=";
-    url += TELEGRAM_USER_ID;
-    url += "&text=";
-    url += urlencode(message);
-
-    http.begin(wifiClient, url);
-    int httpCode = http.GET();
-    String payload = http.getString();
-    Serial.print("[Telegram] HTTP code: ");
-    Serial.println(httpCode);
-    Serial.print("[Telegram] Response: ");
-    Serial.println(payload);
-    http.end();
-    return (httpCode == 200);
+bool sendTelegramNotification(const char* message) {
+    return telegramEnqueue(message);
 }
 
-// Simple URL encoder for message text
-String urlencode(const String& str) {
-    String encoded = "";
-    char c;
-    char code0, code1;
-    for (size_t i = 0; i < str.length(); i++) {
-        c = str.charAt(i);
-        if (isalnum(c)) {
-            encoded += c;
+/**
+ * Finish the exchange for the message at the head of the queue
+ */
+void telegramComplete(bool ok) {
+    TelegramMessage& msg = telegramQueue[telegramHead];
+    telegramState = TELEGRAM_IDLE;
+    telegramLastUseMs = millis();
+    if (!ok || telegramCloseAfter) telegramClient.stop();
+    if (ok) {
+        telegramSent++;
+    } else if (++msg.attempts < TELEGRAM_MAX_ATTEMPTS) {
+        msg.retryAtMs = millis() + (telegramRetryMs << (msg.attempts - 1));
+        Serial.printf("[Telegram] Failed (HTTP %d), retry %u\n", telegramStatus, msg.attempts);
+        return;
+    } else {
+        telegramFailed++;
+        Serial.printf("[Telegram] Giving up (HTTP %d)\n", telegramStatus);
+    }
+    telegramHead = (telegramHead + 1) % TELEGRAM_QUEUE_SIZE;
+    telegramCount--;
+}
+
+/**
+ * Start sending the message at the head of the queue
+ */
+void telegramStart() {
+    TelegramMessage& msg = telegramQueue[telegramHead];
+    if (!telegramClient.connected()) {
+        if (!tlsConnect(telegramTls)) {
+            telegramStatus = 0;
+            telegramComplete(false);
+            return;
+        }
+    }
+
+    TextBuffer request = textOver(telegramRequest, sizeof(telegramRequest));
+    textAppend(request, "GET /bot" TELEGRAM_BOT_TOKEN "/sendMessage?chat_id=" TELEGRAM_USER_ID "&text=");
+    textAppendUrlEncoded(request, msg.text);
+    textPrintf(request, " HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n", telegramHost);
+    if (request.overflow) {
+        telegramStatus = 0;
+        telegramComplete(false);
+        return;
+    }
+    telegramRequestLength = request.length;
+    telegramRequestSent = 0;
+    telegramLineLength = 0;
+    telegramStatus = 0;
+    telegramBodyLeft = -1;
+    telegramCloseAfter = false;
+    telegramDeadlineMs = millis() + TELEGRAM_TIMEOUT_MS;
+    telegramState = TELEGRAM_SENDING;
+}
+
+/**
+ * Interpret one complete response header line
+ */
+void telegramHeaderLine(const char* line) {
+    if (telegramStatus == 0) {
+        const char* code = strchr(line, ' ');
+        telegramStatus = code ? atoi(code + 1) : -1;
+    } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+        telegramBodyLeft = atol(line + 15);
+    } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close")) {
+        telegramCloseAfter = true;
+    }
+}
+
+/**
+ * Advance the current exchange without blocking. Call once per loop().
+ */
+void telegramService() {
+    unsigned long now = millis();
+    if (telegramState == TELEGRAM_IDLE) {
+        if (telegramClient.connected() && now - telegramLastUseMs >= TELEGRAM_IDLE_CLOSE_MS) {
+            telegramClient.stop();
+        }
+        if (telegramCount == 0 || WiFi.status() != WL_CONNECTED ||
+            (long)(now - telegramQueue[telegramHead].retryAtMs) < 0) {
+            return;
+        }
+        // Reusing the open connection needs nothing; a new one may have to
+        // wait for an MFLN probe pass, the clock or heap
+        if (!telegramClient.connected() && !tlsPrepare(telegramTls)) return;
+        telegramStart();
+        return;
+    }
+
+    if ((long)(now - telegramDeadlineMs) >= 0) {
+        telegramComplete(false);
+        return;
+    }
+
+    if (telegramState == TELEGRAM_SENDING) {
+        int room = telegramClient.availableForWrite();
+        if (room <= 0) return;
+        size_t chunk = telegramRequestLength - telegramRequestSent;
+        if ((int)chunk > room) chunk = room;
+        telegramRequestSent += telegramClient.write((const uint8_t*)telegramRequest + telegramRequestSent, chunk);
+        if (telegramRequestSent == telegramRequestLength) telegramState = TELEGRAM_HEADERS;
+        return;
+    }
+
+    if (!telegramClient.connected() && telegramClient.available() == 0) {
+        // Closed by the server: fine only for a close-delimited body
+        telegramCloseAfter = true;
+        telegramComplete(telegramState == TELEGRAM_BODY && telegramBodyLeft < 0 && telegramStatus == 200);
+        return;
+    }
+
+    while (telegramState == TELEGRAM_HEADERS && telegramClient.available() > 0) {
+        char c = (char)telegramClient.read();
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (telegramLineLength < sizeof(telegramLine) - 1) telegramLine[telegramLineLength++] = c;
+            continue;
+        }
+        telegramLine[telegramLineLength] = '\0';
+        if (telegramLineLength == 0) {
+            telegramState = TELEGRAM_BODY;
+            if (telegramBodyLeft < 0) telegramCloseAfter = true;
         } else {
-            code1 = (c & 0xF) + '0';
-            if ((c & 0xF) > 9) code1 = (c & 0xF) - 10 + 'A';
-            code0 = ((c >> 4) & 0xF) + '0';
-            if (((c >> 4) & 0xF) > 9) code0 = ((c >> 4) & 0xF) - 10 + 'A';
-            encoded += '%';
-            encoded += code0;
-            encoded += code1;
+            telegramHeaderLine(telegramLine);
+        }
+        telegramLineLength = 0;
+    }
+
+    if (telegramState == TELEGRAM_BODY) {
+        uint8_t scratch[64];
+        int available;
+        while (telegramBodyLeft != 0 && (available = telegramClient.available()) > 0) {
+            size_t chunk = available < (int)sizeof(scratch) ? available : sizeof(scratch);
+            if (telegramBodyLeft > 0 && (long)chunk > telegramBodyLeft) chunk = telegramBodyLeft;
+            size_t got = telegramClient.read(scratch, chunk);
+            if (telegramBodyLeft > 0) telegramBodyLeft -= got;
         }
+        if (telegramBodyLeft == 0) telegramComplete(telegramStatus == 200);
     }
-    return encoded;
 }
 
 #endif // TELEGRAM_NOTIFY_H
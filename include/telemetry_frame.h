@@ -0,0 +1,239 @@
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "wave_history.h"
+
+/*
+ * Batched binary telemetry frame
+ * ==============================
+ * One MQTT publish carries several seconds of data instead of one JSON
+ * object per second. Device identity is not repeated in every frame: it
+ * lives in the topic and in a retained metadata message.
+ *
+ * Layout, all little-endian:
+ *
+ *   Header (20 bytes)
+ *     u8   version        = 2
+ *     u8   flags          bit 0: contains a WAVE record
+ *     u16  records        number of records that follow
+ *     u32  batchSeq       +1 per frame; a jump means frames were lost
+ *     u32  baseMs         detector time of the first record (ms since
+ *                         sampling started)
+ *     u64  baseEpochMs    UTC of baseMs in ms since 1970, 0 if the clock
+ *                         was not yet synchronised (timebase.h)
+ *
+ *   A record's UTC is baseEpochMs + its offset; the sample with wave
+ *   sequence number n was taken at baseEpochMs + n * interval - baseMs.
+ *   Offsets run on the device crystal, which the timebase holds to within
+ *   TIMEBASE_MAX_PPM, so across a 10 s frame they stay within a few ms.
+ *   Version 1 frames (still found in an old offline log) are the same
+ *   without baseEpochMs.
+ *
+ *   Records: u8 type, u16 offsetMs (from baseMs, clamped), then by type
+ *     0x01 SECOND  u8 bpm, u16 signal (ADC 0-1023), u8 flags     7 bytes
+ *                  flags bit 0: pulse detected
+ *                        bit 1: quality adequate (signal_quality.h);
+ *                               bpm is 0 when it is not
+ *     0x02 BEAT    u16 ibi (0.1 ms units, 0 = no previous beat,   6 bytes
+ *                  0xFFFF = longer), u8 flags
+ *                  flags bit 0: interval accepted by the statistics
+ *     0x03 WAVE    u16 length, then a /wave frame                 5 + length
+ *                  (see wave_history.h)
+ *
+ * A 10 s batch without raw samples is ~20 + 10*7 + 12*6 = ~162 bytes,
+ * versus ~10 x 190 bytes of JSON.
+ */
+
+const uint8_t telemetryVersion = 2;
+const size_t telemetryHeaderSize = 20;
+const size_t telemetryV1HeaderSize = 12;
+
+const uint8_t telemetryFlagWave = 0x01;
+
+const uint8_t telemetrySecond = 0x01;
+const uint8_t telemetryBeat = 0x02;
+const uint8_t telemetryWave = 0x03;
+
+const uint8_t telemetrySecondDetected = 0x01;
+const uint8_t telemetrySecondAdequate = 0x02;
+const uint8_t telemetryBeatAccepted = 0x01;
+
+#ifndef TELEMETRY_FRAME_SIZE
+#define TELEMETRY_FRAME_SIZE 1024
+#endif
+
+struct TelemetryBatch {
+  uint8_t data[TELEMETRY_FRAME_SIZE];
+  size_t length;
+  uint16_t records;
+  uint32_t baseMs;
+  uint64_t baseEpochMs;
+  uint32_t seq;                  // Sequence number of the frame being built
+};
+
+inline uint16_t telemetryU16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t telemetryU32(const uint8_t* p) {
+  return telemetryU16(p) | ((uint32_t)telemetryU16(p + 2) << 16);
+}
+
+inline uint64_t telemetryU64(const uint8_t* p) {
+  return telemetryU32(p) | ((uint64_t)telemetryU32(p + 4) << 32);
+}
+
+/**
+ * Start a new frame whose record offsets are relative to baseMs
+ * @param baseEpochMs UTC of baseMs, 0 if unknown
+ */
+void telemetryBegin(TelemetryBatch& b, uint32_t seq, uint32_t baseMs, uint64_t baseEpochMs) {
+  b.seq = seq;
+  b.baseMs = baseMs;
+  b.baseEpochMs = baseEpochMs;
+  b.records = 0;
+  b.length = telemetryHeaderSize;
+  b.data[0] = telemetryVersion;
+  b.data[1] = 0;
+  wavePutU16(b.data + 2, 0);
+  wavePutU32(b.data + 4, seq);
+  wavePutU32(b.data + 8, baseMs);
+  wavePutU32(b.data + 12, (uint32_t)baseEpochMs);
+  wavePutU32(b.data + 16, (uint32_t)(baseEpochMs >> 32));
+}
+
+/**
+ * Bytes still free in the frame
+ */
+inline size_t telemetryRoom(const TelemetryBatch& b) {
+  return TELEMETRY_FRAME_SIZE - b.length;
+}
+
+/**
+ * Write a record's type and offset; false if size more bytes don't fit
+ */
+bool telemetryRecord(TelemetryBatch& b, uint8_t type, uint32_t timeMs, size_t size) {
+  if (telemetryRoom(b) < size) return false;
+  int32_t offset = (int32_t)(timeMs - b.baseMs);     // Clamped into 0..65535
+  b.data[b.length] = type;
+  wavePutU16(b.data + b.length + 1, offset < 0 ? 0 : (offset > 0xFFFF ? 0xFFFF : (uint16_t)offset));
+  b.length += 3;
+  b.records++;
+  return true;
+}
+
+bool telemetryAddSecond(TelemetryBatch& b, uint32_t timeMs, int bpm, int signal, uint8_t flags) {
+  if (!telemetryRecord(b, telemetrySecond, timeMs, 7)) return false;
+  b.data[b.length] = (uint8_t)(bpm < 0 ? 0 : (bpm > 255 ? 255 : bpm));
+  wavePutU16(b.data + b.length + 1, (uint16_t)signal);
+  b.data[b.length + 3] = flags;
+  b.length += 4;
+  return true;
+}
+
+bool telemetryAddBeat(TelemetryBatch& b, uint32_t timeMs, uint32_t ibiUs, bool accepted) {
+  if (!telemetryRecord(b, telemetryBeat, timeMs, 6)) return false;
+  uint32_t tenths = (ibiUs + 50) / 100;
+  wavePutU16(b.data + b.length, tenths > 0xFFFF ? 0xFFFF : (uint16_t)tenths);
+  b.data[b.length + 2] = accepted ? telemetryBeatAccepted : 0;
+  b.length += 3;
+  return true;
+}
+
+/**
+ * Append the samples after *cursor as a WAVE record and advance the cursor
+ * past what fit
+ */
+bool telemetryAddWave(TelemetryBatch& b, uint32_t timeMs, const WaveHistory& h,
+                      uint32_t* cursor, uint16_t intervalMs) {
+  if (telemetryRoom(b) < 5 + waveFrameHeaderSize + 2) return false;
+  size_t at = b.length;
+  telemetryRecord(b, telemetryWave, timeMs, 5);
+  size_t size = waveEncode(h, *cursor, intervalMs, b.data + at + 5, telemetryRoom(b) - 2);
+  if (size == 0) {
+    b.length = at;
+    b.records--;
+    return false;
+  }
+  wavePutU16(b.data + at + 3, (uint16_t)size);
+  b.length = at + 5 + size;
+  b.data[1] |= telemetryFlagWave;
+  const uint8_t* wave = b.data + at + 5;
+  *cursor = telemetryU32(wave + 4) + telemetryU16(wave + 8);   // firstSeq + count
+  return true;
+}
+
+/**
+ * Patch the record count into the header
+ * @return the finished frame length
+ */
+size_t telemetryFinish(TelemetryBatch& b) {
+  wavePutU16(b.data + 2, b.records);
+  return b.length;
+}
+
+// ========================= DECODING (host tools) =========================
+
+struct TelemetryRecord {
+  uint8_t type;
+  uint32_t timeMs;               // baseMs + offset
+  uint64_t epochMs;              // baseEpochMs + offset, 0 if not synchronised
+  uint8_t bpm;                   // SECOND
+  uint16_t signal;               // SECOND
+  uint32_t ibiUs;                // BEAT
+  uint8_t flags;                 // SECOND, BEAT
+  const uint8_t* wave;           // WAVE: embedded /wave frame
+  uint16_t waveLength;
+};
+
+/**
+ * Parse a frame into out[]
+ * @return number of records, or -1 if the frame is malformed or
+ *         truncated
+ */
+int telemetryDecode(const uint8_t* frame, size_t size, uint32_t* seq, uint32_t* baseMs,
+                    TelemetryRecord* out, size_t maxRecords) {
+  if (size < telemetryV1HeaderSize || frame[0] < 1 || frame[0] > telemetryVersion) return -1;
+  size_t pos = frame[0] == 1 ? telemetryV1HeaderSize : telemetryHeaderSize;
+  if (size < pos) return -1;
+  uint16_t records = telemetryU16(frame + 2);
+  *seq = telemetryU32(frame + 4);
+  *baseMs = telemetryU32(frame + 8);
+  uint64_t baseEpochMs = frame[0] == 1 ? 0 : telemetryU64(frame + 12);
+  if (records > maxRecords) return -1;
+
+  for (uint16_t i = 0; i < records; i++) {
+    if (pos + 3 > size) return -1;
+    TelemetryRecord& r = out[i];
+    r = TelemetryRecord();
+    r.type = frame[pos];
+    r.timeMs = *baseMs + telemetryU16(frame + pos + 1);
+    r.epochMs = baseEpochMs ? baseEpochMs + telemetryU16(frame + pos + 1) : 0;
+    pos += 3;
+    if (r.type == telemetrySecond) {
+      if (pos + 4 > size) return -1;
+      r.bpm = frame[pos];
+      r.signal = telemetryU16(frame + pos + 1);
+      r.flags = frame[pos + 3];
+      pos += 4;
+    } else if (r.type == telemetryBeat) {
+      if (pos + 3 > size) return -1;
+      r.ibiUs = telemetryU16(frame + pos) * 100UL;
+      r.flags = frame[pos + 2];
+      pos += 3;
+    } else if (r.type == telemetryWave) {
+      if (pos + 2 > size) return -1;
+      r.waveLength = telemetryU16(frame + pos);
+      r.wave = frame + pos + 2;
+      pos += 2 + r.waveLength;
+      if (pos > size) return -1;
+    } else {
+      return -1;
+    }
+  }
+  return pos == size ? records : -1;
+}
+
+#endif // TELEMETRY_FRAME_H
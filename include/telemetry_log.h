@@ -0,0 +1,419 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+/*
+ * Flash-backed store-and-forward log
+ * ==================================
+ * Telemetry frames that cannot be published are appended to a segment log
+ * on LittleFS and replayed once the broker is back.
+ *
+ * The log is a ring of TLOG_SEGMENTS files, each at most TLOG_SEGMENT_BYTES.
+ * Segment ids only ever grow; id N lives in slot N % TLOG_SEGMENTS, so the
+ * files are rewritten round-robin and no slot wears faster than another.
+ * Records are only ever appended and segments are only ever deleted whole.
+ * When every slot is in use the oldest undelivered segment is dropped,
+ * which bounds the log to TLOG_SEGMENTS * TLOG_SEGMENT_BYTES of flash.
+ *
+ *   segment   u32 magic "TLG1", u32 segment id, then records
+ *   record    u16 length, u16 Fletcher-16 of the payload, payload
+ *   cursor    /tlog.cur: u32 segment id, u32 offset, u32 check
+ *
+ * The read cursor is persisted when a segment has been fully delivered and
+ * otherwise at most every TLOG_CURSOR_SYNC_MS, so a reboot resends at most
+ * that much (frames carry a sequence number for de-duplication). Consuming
+ * a frame only updates RAM: the cursor is written by the next
+ * tlogPeekBatch() once due, so a drain touches flash once per batch (every
+ * flash access stops sampling, acquisition.h). A record
+ * torn by a power cut fails its checksum; the log recovers the valid prefix
+ * and continues in a fresh segment.
+ */
+
+#ifndef TLOG_SEGMENTS
+#define TLOG_SEGMENTS 8
+#endif
+
+#ifndef TLOG_SEGMENT_BYTES
+#define TLOG_SEGMENT_BYTES 16384    // 8 x 16 KB: ~14 h of 10 s frames without waveform
+#endif
+
+#ifndef TLOG_CURSOR_SYNC_MS
+#define TLOG_CURSOR_SYNC_MS 30000
+#endif
+
+const uint32_t tlogMagic = 0x31474C54;   // "TLG1"
+const uint32_t tlogHeaderSize = 8;
+const uint32_t tlogRecordHeaderSize = 4;
+const char* const tlogCursorPath = "/tlog.cur";
+
+struct TelemetryLog {
+  bool ready;
+  uint32_t firstId;              // Oldest segment with undelivered records
+  uint32_t lastId;               // Segment being appended to
+  uint32_t readOffset;           // Next undelivered record in firstId
+  uint32_t readIndex;            // Records delivered from firstId
+  uint32_t writeOffset;          // Bytes in lastId
+  uint32_t segRecords[TLOG_SEGMENTS];  // Records per slot (from the cursor for firstId)
+  uint32_t pending;              // Records waiting to be delivered
+  File writer;
+
+  bool cursorDirty;
+  unsigned long cursorSavedMs;
+
+  // Counters, reported by /data
+  uint32_t appended;
+  uint32_t delivered;
+  uint32_t dropped;              // Records lost to the size bound
+  uint32_t corrupt;              // Torn or damaged records skipped
+  uint32_t appendUsLast;
+  uint32_t appendUsMax;
+  uint32_t readUsLast;
+};
+
+TelemetryLog telemetryLog;
+
+/**
+ * File name of the slot holding segment id
+ */
+void tlogPath(uint32_t id, char* out, size_t size) {
+  snprintf(out, size, "/tlog%u.seg", (unsigned)(id % TLOG_SEGMENTS));
+}
+
+/**
+ * Fletcher-16 of data, continuing from the checksum of what came before it
+ * (0 to start)
+ */
+uint16_t tlogChecksum(const uint8_t* data, size_t size, uint16_t running = 0) {
+  uint16_t a = running & 0xFF, b = running >> 8;
+  for (size_t i = 0; i < size; i++) {
+    a = (a + data[i]) % 255;
+    b = (b + a) % 255;
+  }
+  return (uint16_t)((b << 8) | a);
+}
+
+inline uint32_t tlogU32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void tlogPutU32(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * Read the record header at offset and validate its payload
+ * @return payload length, 0 at the end of the segment or on damage
+ *         (*damaged tells which)
+ */
+size_t tlogReadRecord(File& f, uint32_t offset, uint8_t* out, size_t capacity, bool* damaged) {
+  uint8_t head[tlogRecordHeaderSize];
+  *damaged = false;
+  if (!f.seek(offset) || f.read(head, sizeof(head)) != sizeof(head)) return 0;
+  size_t length = head[0] | (head[1] << 8);
+  uint16_t check = head[2] | (head[3] << 8);
+  if (length == 0 || length > capacity || f.read(out, length) != length ||
+      tlogChecksum(out, length) != check) {
+    *damaged = true;
+    return 0;
+  }
+  return length;
+}
+
+/**
+ * Validate the record at offset without keeping its payload, which is
+ * checksummed in small chunks on the stack
+ * @return payload length, 0 at the end of the segment or on damage
+ *         (*damaged tells which)
+ */
+size_t tlogCheckRecord(File& f, uint32_t offset, bool* damaged) {
+  uint8_t head[tlogRecordHeaderSize];
+  *damaged = false;
+  if (!f.seek(offset) || f.read(head, sizeof(head)) != sizeof(head)) return 0;
+  size_t length = head[0] | (head[1] << 8);
+  uint16_t check = head[2] | (head[3] << 8);
+  uint16_t sum = 0;
+  size_t done = 0;
+  if (length > 0 && length <= TLOG_SEGMENT_BYTES - tlogHeaderSize - tlogRecordHeaderSize) {
+    uint8_t chunk[64];
+    while (done < length) {
+      size_t n = length - done < sizeof(chunk) ? length - done : sizeof(chunk);
+      if (f.read(chunk, n) != n) break;
+      sum = tlogChecksum(chunk, n, sum);
+      done += n;
+    }
+  }
+  if (length == 0 || done != length || sum != check) {
+    *damaged = true;
+    return 0;
+  }
+  return length;
+}
+
+/**
+ * Count the valid records of segment id from offset
+ * @param end Offset after the last valid record
+ * @return record count; *torn is set if damage stopped the scan
+ */
+uint32_t tlogScan(uint32_t id, uint32_t offset, uint32_t* end, bool* torn) {
+  char path[16];
+  tlogPath(id, path, sizeof(path));
+  *end = offset;
+  *torn = false;
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  uint32_t count = 0;
+  size_t length;
+  while ((length = tlogCheckRecord(f, *end, torn)) > 0) {
+    *end += tlogRecordHeaderSize + length;
+    count++;
+  }
+  f.close();
+  return count;
+}
+
+void tlogSaveCursor(TelemetryLog& log) {
+  uint8_t cur[12];
+  tlogPutU32(cur, log.firstId);
+  tlogPutU32(cur + 4, log.readOffset);
+  tlogPutU32(cur + 8, log.firstId ^ log.readOffset ^ tlogMagic);
+  File f = LittleFS.open(tlogCursorPath, "w");
+  if (f) {
+    f.write(cur, sizeof(cur));
+    f.close();
+  }
+  log.cursorDirty = false;
+  log.cursorSavedMs = millis();
+}
+
+/**
+ * Start segment lastId in its slot, replacing whatever it held
+ */
+bool tlogStartSegment(TelemetryLog& log) {
+  char path[16];
+  tlogPath(log.lastId, path, sizeof(path));
+  log.writer.close();
+  log.writer = LittleFS.open(path, "w");
+  if (!log.writer) return false;
+  uint8_t head[tlogHeaderSize];
+  tlogPutU32(head, tlogMagic);
+  tlogPutU32(head + 4, log.lastId);
+  log.writer.write(head, sizeof(head));
+  log.writer.flush();
+  log.writeOffset = tlogHeaderSize;
+  log.segRecords[log.lastId % TLOG_SEGMENTS] = 0;
+  return true;
+}
+
+/**
+ * Forget the oldest segment's undelivered records and delete it
+ */
+void tlogDropFirst(TelemetryLog& log) {
+  uint32_t lost = log.segRecords[log.firstId % TLOG_SEGMENTS] - log.readIndex;
+  log.dropped += lost;
+  log.pending -= lost;
+  char path[16];
+  tlogPath(log.firstId, path, sizeof(path));
+  LittleFS.remove(path);
+  log.firstId++;
+  log.readOffset = tlogHeaderSize;
+  log.readIndex = 0;
+  log.cursorDirty = true;
+}
+
+/**
+ * Mount the filesystem and recover the log left by the last boot
+ */
+bool tlogBegin(TelemetryLog& log) {
+  log.writer.close();
+  log = TelemetryLog();
+  log.ready = LittleFS.begin();
+  if (!log.ready) return false;
+
+  // Which segment ids do the slots hold?
+  bool any = false;
+  uint32_t minId = 0, maxId = 0;
+  for (uint32_t slot = 0; slot < TLOG_SEGMENTS; slot++) {
+    char path[16];
+    tlogPath(slot, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    if (!f) continue;
+    uint8_t head[tlogHeaderSize];
+    bool ok = f.read(head, sizeof(head)) == sizeof(head) && tlogU32(head) == tlogMagic &&
+              tlogU32(head + 4) % TLOG_SEGMENTS == slot;
+    f.close();
+    if (!ok) continue;
+    uint32_t id = tlogU32(head + 4);
+    if (!any || id < minId) minId = id;
+    if (!any || id > maxId) maxId = id;
+    any = true;
+  }
+  if (!any) {
+    log.firstId = log.lastId = 0;
+    log.readOffset = tlogHeaderSize;
+    return tlogStartSegment(log);
+  }
+
+  // Resume from the saved cursor if it points into the surviving range
+  log.firstId = minId;
+  log.readOffset = tlogHeaderSize;
+  File cf = LittleFS.open(tlogCursorPath, "r");
+  uint8_t cur[12];
+  if (cf && cf.read(cur, sizeof(cur)) == sizeof(cur) &&
+      (tlogU32(cur) ^ tlogU32(cur + 4) ^ tlogMagic) == tlogU32(cur + 8) &&
+      tlogU32(cur) >= minId && tlogU32(cur) <= maxId) {
+    log.firstId = tlogU32(cur);
+    log.readOffset = tlogU32(cur + 4);
+  }
+  cf.close();
+
+  bool torn = false;
+  uint32_t end = log.readOffset;
+  for (uint32_t id = log.firstId; id <= maxId; id++) {
+    uint32_t count = tlogScan(id, id == log.firstId ? log.readOffset : tlogHeaderSize, &end, &torn);
+    log.segRecords[id % TLOG_SEGMENTS] = count;
+    log.pending += count;
+    if (torn) log.corrupt++;
+  }
+  log.lastId = maxId;
+  log.writeOffset = end;
+
+  // Append to the newest segment unless its tail is damaged
+  char path[16];
+  tlogPath(log.lastId, path, sizeof(path));
+  if (torn) {
+    log.lastId++;
+    if (log.lastId - log.firstId >= TLOG_SEGMENTS) tlogDropFirst(log);
+    return tlogStartSegment(log);
+  }
+  log.writer = LittleFS.open(path, "a");
+  return (bool)log.writer;
+}
+
+/**
+ * Append one frame, rotating segments and dropping the oldest when full
+ */
+bool tlogAppend(TelemetryLog& log, const uint8_t* data, size_t size) {
+  if (!log.ready || size == 0 || size > TLOG_SEGMENT_BYTES - tlogHeaderSize - tlogRecordHeaderSize) {
+    return false;
+  }
+  unsigned long start = micros();
+  if (log.writeOffset + tlogRecordHeaderSize + size > TLOG_SEGMENT_BYTES) {
+    log.lastId++;
+    if (log.lastId - log.firstId >= TLOG_SEGMENTS) tlogDropFirst(log);
+    if (!tlogStartSegment(log)) return false;
+  }
+
+  uint8_t head[tlogRecordHeaderSize];
+  uint16_t check = tlogChecksum(data, size);
+  head[0] = (uint8_t)size;
+  head[1] = (uint8_t)(size >> 8);
+  head[2] = (uint8_t)check;
+  head[3] = (uint8_t)(check >> 8);
+  if (log.writer.write(head, sizeof(head)) != sizeof(head) ||
+      log.writer.write(data, size) != size) {
+    return false;
+  }
+  log.writer.flush();
+  log.writeOffset += tlogRecordHeaderSize + size;
+  log.segRecords[log.lastId % TLOG_SEGMENTS]++;
+  log.pending++;
+  log.appended++;
+
+  log.appendUsLast = micros() - start;
+  if (log.appendUsLast > log.appendUsMax) log.appendUsMax = log.appendUsLast;
+  return true;
+}
+
+/**
+ * Whether consumed frames are waiting for the cursor to be saved: the log
+ * has been emptied, or TLOG_CURSOR_SYNC_MS has passed
+ */
+inline bool tlogCursorDue(const TelemetryLog& log) {
+  return log.cursorDirty && (log.pending == 0 || millis() - log.cursorSavedMs >= TLOG_CURSOR_SYNC_MS);
+}
+
+/**
+ * Copy up to maxFrames of the oldest undelivered frames into out, back to
+ * back, without consuming them. Reads one segment with one open and saves
+ * the cursor first if it is due.
+ * @param lengths Receives the length of each frame copied
+ * @return frames copied, 0 if the log is empty
+ */
+uint8_t tlogPeekBatch(TelemetryLog& log, uint8_t* out, size_t capacity, uint16_t* lengths,
+                      uint8_t maxFrames) {
+  if (tlogCursorDue(log)) tlogSaveCursor(log);
+  while (log.ready && log.pending > 0) {
+    // Finished with the oldest segment: delete it and move on
+    if (log.firstId != log.lastId &&
+        log.readIndex >= log.segRecords[log.firstId % TLOG_SEGMENTS]) {
+      char path[16];
+      tlogPath(log.firstId, path, sizeof(path));
+      LittleFS.remove(path);
+      log.firstId++;
+      log.readOffset = tlogHeaderSize;
+      log.readIndex = 0;
+      tlogSaveCursor(log);
+      continue;
+    }
+
+    unsigned long start = micros();
+    char path[16];
+    tlogPath(log.firstId, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    uint32_t left = log.segRecords[log.firstId % TLOG_SEGMENTS] - log.readIndex;
+    uint32_t offset = log.readOffset;
+    size_t used = 0;
+    uint8_t count = 0;
+    bool damaged = false;
+    while (f && count < maxFrames && count < left) {
+      // A later record that is damaged or doesn't fit waits for the next batch
+      size_t length = tlogReadRecord(f, offset, out + used, capacity - used, &damaged);
+      if (length == 0) break;
+      lengths[count++] = (uint16_t)length;
+      used += length;
+      offset += tlogRecordHeaderSize + length;
+    }
+    f.close();
+    log.readUsLast = micros() - start;
+    if (count > 0) return count;
+
+    // Unreadable: give up on the rest of this segment
+    log.corrupt++;
+    uint32_t lost = log.segRecords[log.firstId % TLOG_SEGMENTS] - log.readIndex;
+    log.pending -= lost;
+    log.readIndex += lost;
+    if (log.firstId == log.lastId) {
+      log.lastId++;
+      tlogStartSegment(log);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Copy the oldest undelivered frame into out without consuming it
+ * @return frame length, 0 if the log is empty
+ */
+size_t tlogPeek(TelemetryLog& log, uint8_t* out, size_t capacity) {
+  uint16_t length;
+  return tlogPeekBatch(log, out, capacity, &length, 1) ? length : 0;
+}
+
+/**
+ * Mark the next frame returned by tlogPeek() or tlogPeekBatch() as
+ * delivered. RAM only; see tlogCursorDue().
+ */
+void tlogConsume(TelemetryLog& log, size_t length) {
+  log.readOffset += tlogRecordHeaderSize + length;
+  log.readIndex++;
+  log.pending--;
+  log.delivered++;
+  log.cursorDirty = true;
+}
+
+#endif // TELEMETRY_LOG_H
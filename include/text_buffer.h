@@ -0,0 +1,170 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <time.h>
+
+/*
+ * Fixed-capacity text formatting
+ * ==============================
+ * Every HTTP response body and outgoing payload is formatted into a buffer
+ * whose size is fixed at compile time (a static, or a stack array for small
+ * ones) instead of growing an Arduino String. Long-running String `+=`
+ * chains leave holes in the ESP8266 heap; after days of uptime the largest
+ * free block is too small for the ~20 KB BearSSL needs and TLS connects
+ * start failing even though plenty of memory is free in total.
+ *
+ * A TextBuffer either has a sink, in which case full chunks are handed to
+ * it (chunked HTTP) and output of any length streams through, or it has
+ * none, and anything that does not fit sets overflow instead of writing
+ * past the end. The text is always NUL-terminated.
+ *
+ * The native build counts heap allocations around a steady-state loop that
+ * uses these paths (replay --alloc-check) to keep them allocation-free.
+ */
+
+struct TextBuffer {
+  char* data;
+  size_t capacity;               // Including the terminating NUL
+  size_t length;
+  bool overflow;                 // Something was cut short (no sink only)
+  void (*sink)(const char* data, size_t size);  // Optional: receives full chunks
+};
+
+/**
+ * TextBuffer with its own storage
+ */
+template <size_t N>
+struct FixedText : TextBuffer {
+  char storage[N];
+  FixedText() : TextBuffer{storage, N, 0, false, nullptr} { storage[0] = '\0'; }
+};
+
+/**
+ * Wrap existing storage
+ */
+TextBuffer textOver(char* storage, size_t capacity) {
+  storage[0] = '\0';
+  return TextBuffer{storage, capacity, 0, false, nullptr};
+}
+
+void textClear(TextBuffer& b) {
+  b.length = 0;
+  b.overflow = false;
+  b.data[0] = '\0';
+}
+
+/**
+ * Hand the buffered text to the sink (no-op without one)
+ */
+void textFlush(TextBuffer& b) {
+  if (!b.sink || b.length == 0) return;
+  b.sink(b.data, b.length);
+  b.length = 0;
+  b.data[0] = '\0';
+}
+
+void textAppend(TextBuffer& b, const char* text, size_t size) {
+  while (size > 0) {
+    size_t room = b.capacity - 1 - b.length;
+    if (room == 0) {
+      if (!b.sink) {
+        b.overflow = true;
+        return;
+      }
+      textFlush(b);
+      continue;
+    }
+    size_t chunk = size < room ? size : room;
+    memcpy(b.data + b.length, text, chunk);
+    b.length += chunk;
+    b.data[b.length] = '\0';
+    text += chunk;
+    size -= chunk;
+  }
+}
+
+void textAppend(TextBuffer& b, const char* text) {
+  textAppend(b, text, strlen(text));
+}
+
+/**
+ * printf into the buffer. With a sink a line that doesn't fit flushes and
+ * is formatted again, so a single call can use the whole capacity.
+ */
+void textPrintf(TextBuffer& b, const char* format, ...) {
+  for (int pass = 0; pass < 2; pass++) {
+    size_t room = b.capacity - b.length;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(b.data + b.length, room, format, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t)n < room) {
+      b.length += n;
+      return;
+    }
+    if (!b.sink || b.length == 0) break;
+    b.data[b.length] = '\0';
+    textFlush(b);
+  }
+  // Truncated: keep what vsnprintf wrote, which is already NUL-terminated
+  b.length = b.capacity - 1;
+  if (b.sink) {
+    textFlush(b);
+  } else {
+    b.overflow = true;
+  }
+}
+
+/**
+ * Unsigned 64-bit decimal (not every printf supports %llu)
+ */
+void textAppendU64(TextBuffer& b, uint64_t value) {
+  char digits[21];
+  int n = sizeof(digits);
+  digits[--n] = '\0';
+  do {
+    digits[--n] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  textAppend(b, digits + n, sizeof(digits) - 1 - n);
+}
+
+/**
+ * ISO 8601 UTC with milliseconds, e.g. 2025-01-28T10:43:51.123Z
+ */
+void textAppendIso8601(TextBuffer& b, uint64_t epochUs) {
+  time_t seconds = (time_t)(epochUs / 1000000);
+  struct tm utc;
+  gmtime_r(&seconds, &utc);
+  textPrintf(b, "%04d-%02d-%02dT%02d:%02d:%02d.%03uZ", utc.tm_year + 1900, utc.tm_mon + 1,
+             utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, (unsigned)(epochUs / 1000 % 1000));
+}
+
+/**
+ * Percent-encode text for a URL query value (alphanumerics pass through).
+ * Stops at a whole character if it runs out of room.
+ */
+void textAppendUrlEncoded(TextBuffer& b, const char* text) {
+  static const char hex[] = "0123456789ABCDEF";
+  for (const char* p = text; *p; p++) {
+    uint8_t c = (uint8_t)*p;
+    char encoded[3] = {(char)c, 0, 0};
+    size_t size = 1;
+    if (!isalnum(c)) {
+      encoded[0] = '%';
+      encoded[1] = hex[c >> 4];
+      encoded[2] = hex[c & 0xF];
+      size = 3;
+    }
+    if (!b.sink && b.length + size >= b.capacity) {
+      b.overflow = true;
+      return;
+    }
+    textAppend(b, encoded, size);
+  }
+}
+
+#endif // TEXT_BUFFER_H
@@ -0,0 +1,178 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <Arduino.h>
+#include "acquisition.h"
+#include "heart_rate.h"
+
+/*
+ * NTP-disciplined timebase
+ * ========================
+ * Maps the monotonic microsecond counter to UTC. micros() is extended to
+ * 64 bits; each SNTP update hands timebaseSync() one (monotonic, UTC)
+ * pair, and conversion is a straight line through the last reference:
+ *
+ *   utc = refEpochUs + d + (d * rate >> 32),   d = monoUs - refMonoUs
+ *
+ * one 64-bit multiply and a shift, cheap enough for every sample and beat.
+ *
+ * rate corrects the crystal. The first interval after boot measures the
+ * crystal's frequency error directly (drift); after that a small
+ * phase-locked loop refines it from the offset seen at each sync, and adds
+ * a term that slews the remaining offset out over the next sync interval.
+ * The line is continuous at each sync, so timestamps never jump backwards.
+ * Only an offset larger than TIMEBASE_STEP_US (first sync, or after a long
+ * outage) steps the clock, and that is counted in steps.
+ *
+ * Detector times (microseconds since sampling began, wrapping every
+ * ~71 min) convert through the instant acquisition recorded for tick 0.
+ *
+ * timebaseSync() only does arithmetic on the pair it is given, so it can
+ * be driven by a mocked clock (see replay --timebase-check).
+ */
+
+#ifndef TIMEBASE_STEP_US
+#define TIMEBASE_STEP_US 500000        // Offsets beyond this are stepped, not slewed
+#endif
+
+#ifndef TIMEBASE_MAX_PPM
+#define TIMEBASE_MAX_PPM 500           // Largest crystal error believed
+#endif
+
+#ifndef TIMEBASE_SYNC_MS
+#define TIMEBASE_SYNC_MS 900000        // SNTP poll interval (the core default is 1 h)
+#endif
+
+// Rates are in units of 2^-32 (~0.23 ppb)
+const int32_t timebaseMaxDrift = (int32_t)(TIMEBASE_MAX_PPM * 4294.967296);
+const int timebaseDriftGainShift = 1;  // drift += residual / 2 per sync
+const int timebaseSlewGainShift = 0;   // Slew the whole offset out over the next interval
+const uint64_t timebaseRebaseUs = 86400000000ULL;  // Re-anchor daily without syncs (keeps d * rate in range)
+
+struct Timebase {
+  bool synced;
+  uint64_t refMonoUs;            // Reference point of the current line
+  uint64_t refEpochUs;
+  int32_t rate;                  // Applied correction: drift + slew
+  int32_t drift;                 // Estimated crystal error
+  bool driftKnown;               // Set by the first interval measured after boot
+  uint64_t lastSyncMonoUs;
+  int32_t lastOffsetUs;          // UTC minus our estimate at the last sync
+  uint32_t syncs;
+  uint32_t steps;
+};
+
+Timebase timebase;
+uint64_t timebaseOriginUs = 0;   // Monotonic time of detector time 0 (tick 0)
+
+/**
+ * 64-bit micros(). Must be called at least once per ~71 min to catch
+ * every wrap; not for ISRs.
+ */
+uint64_t timebaseMonoUs() {
+  static uint32_t last = 0;
+  static uint32_t high = 0;
+  uint32_t now = (uint32_t)micros();
+  if (now < last) high++;
+  last = now;
+  return ((uint64_t)high << 32) | now;
+}
+
+/**
+ * UTC in microseconds since 1970 for a monotonic time, or 0 before the
+ * first sync
+ */
+inline uint64_t timebaseEpochUs(const Timebase& t, uint64_t monoUs) {
+  if (!t.synced) return 0;
+  int64_t d = (int64_t)(monoUs - t.refMonoUs);
+  return t.refEpochUs + d + ((d * t.rate) >> 32);
+}
+
+/**
+ * UTC now, or 0 before the first sync
+ */
+uint64_t timebaseNowUs() {
+  return timebaseEpochUs(timebase, timebaseMonoUs());
+}
+
+inline int32_t timebaseClamp(int64_t v, int32_t limit) {
+  return v > limit ? limit : (v < -limit ? -limit : (int32_t)v);
+}
+
+/**
+ * Discipline the timebase with one reference reading
+ * @param monoUs Monotonic time the reading was taken
+ * @param utcUs UTC at that instant, microseconds since 1970
+ */
+void timebaseSync(Timebase& t, uint64_t monoUs, uint64_t utcUs) {
+  int64_t offset = t.synced ? (int64_t)(utcUs - timebaseEpochUs(t, monoUs)) : 0;
+  int64_t interval = (int64_t)(monoUs - t.lastSyncMonoUs);
+  t.syncs++;
+
+  if (!t.synced || offset > TIMEBASE_STEP_US || offset < -TIMEBASE_STEP_US || interval <= 0) {
+    if (t.synced) t.steps++;
+    t.synced = true;
+    t.refMonoUs = monoUs;
+    t.refEpochUs = utcUs;
+    t.rate = t.drift;
+  } else {
+    // Offset per microsecond since the last sync, in 2^-32 units
+    int64_t residual = offset * 4294967296LL / interval;
+    t.drift = timebaseClamp(t.drift + (t.driftKnown ? residual >> timebaseDriftGainShift : residual),
+                            timebaseMaxDrift);
+    t.driftKnown = true;
+    t.refEpochUs = timebaseEpochUs(t, monoUs);
+    t.refMonoUs = monoUs;
+    t.rate = timebaseClamp((int64_t)t.drift + (residual >> timebaseSlewGainShift), 2 * timebaseMaxDrift);
+  }
+  t.lastOffsetUs = timebaseClamp(offset, INT32_MAX);
+  t.lastSyncMonoUs = monoUs;
+}
+
+/**
+ * Keep the 64-bit counter current and the reference recent. Call at
+ * least every few minutes.
+ */
+void timebaseService() {
+  uint64_t now = timebaseMonoUs();
+  if (timebase.synced && now - timebase.refMonoUs > timebaseRebaseUs) {
+    timebase.refEpochUs = timebaseEpochUs(timebase, now);
+    timebase.refMonoUs = now;
+  }
+}
+
+/**
+ * Estimated crystal error in parts per billion (positive: micros() runs slow)
+ */
+int32_t timebaseDriftPpb(const Timebase& t) {
+  return (int32_t)(((int64_t)t.drift * 1000000000LL) >> 32);
+}
+
+// ========================= DETECTOR TIME =========================
+
+/**
+ * Anchor detector time 0 once acquisition has started
+ */
+void timebaseBegin() {
+  uint64_t now = timebaseMonoUs();
+  timebaseOriginUs = now + (int32_t)(acqTickZeroUs - (uint32_t)micros());
+}
+
+/**
+ * UTC of a detector time (lastSampleTick * sampleIntervalUs or a beat
+ * time; within ~35 min of the newest sample), or 0 before the first sync
+ */
+uint64_t detectorEpochUs(uint32_t detectorUs) {
+  uint64_t now = (uint64_t)lastSampleTick * sampleIntervalUs;
+  uint64_t at = now - (int64_t)(int32_t)((uint32_t)now - detectorUs);
+  return timebaseEpochUs(timebase, timebaseOriginUs + at);
+}
+
+/**
+ * UTC of an acquisition tick (a sample or wave sequence number)
+ */
+inline uint64_t tickEpochUs(uint32_t tick) {
+  return timebaseEpochUs(timebase, timebaseOriginUs + (uint64_t)tick * sampleIntervalUs);
+}
+
+#endif // TIMEBASE_H
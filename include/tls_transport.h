@@ -0,0 +1,270 @@
+#ifndef TLS_TRANSPORT_H
+#define TLS_TRANSPORT_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClientSecure.h>
+#include <time.h>
+#include <new>
+#ifdef UMM_STATS_FULL
+#include <umm_malloc/umm_malloc.h>
+#endif
+
+/*
+ * Memory-bounded TLS transport
+ * ============================
+ * One TlsTransport per secure peer (the MQTT broker, the Telegram API),
+ * each wrapping its WiFiClientSecure with the same policy:
+ *
+ *   buffers   BearSSL's default receive buffer holds a whole 16 KB TLS
+ *             record, so two open connections barely fit in the heap. The
+ *             first connect asks for TLS_MFLN-byte records with the max
+ *             fragment length extension (MFLN), which BearSSL sends when
+ *             the receive buffer is that small. If the server ignores it
+ *             (its records then fail as too large, or the handshake reports
+ *             no MFLN) every later connect uses full records. Outgoing
+ *             records are ours to size and always use TLS_XMIT_BUFFER.
+ *   sessions  The negotiated session is kept and offered on every
+ *             reconnect, so the server can resume it: one round trip and
+ *             no certificate chain or RSA work instead of a full handshake.
+ *   pinning   The server must chain to the root CA configured for it (PEM
+ *             in flash, parsed on first use). Certificate dates are checked
+ *             too, so nothing connects before SNTP has set the clock. If
+ *             the CA cannot be loaded (no heap, or no certificate in the
+ *             PEM) the connect is put off like one short of heap; it never
+ *             falls back to an unverified connection.
+ *             rootCa = nullptr or TLS_VERIFY 0 accepts any certificate.
+ *   headroom  A connect is only started while the heap can take it: the
+ *             peak measured on the last handshake (an estimate before the
+ *             first) must be free. The peak is read from the heap's low-water
+ *             mark, which the core only keeps with -D UMM_STATS_FULL=1 (set
+ *             in platformio.ini); without it the estimate is always used.
+ *
+ * A connect blocks the loop while the timer ISR keeps filling the sample
+ * ring, so every wait in it is bounded: tlsPrepare() looks the host up
+ * with TLS_DNS_TIMEOUT_MS (the connect's own lookup of the name, which SNI
+ * needs, then comes from lwIP's DNS cache), and the TCP connect and the
+ * handshake each give up after TLS_TIMEOUT_MS. tlsConnectMaxMs is the sum,
+ * plus one BearSSL step that can run past the timeout; callers check it
+ * against the ring (mqtt_publish.h). Each handshake's duration, whether it
+ * was resumed and how much heap it took at its peak are kept in the
+ * transport, for /metrics.
+ */
+
+#ifndef TLS_VERIFY
+#define TLS_VERIFY 1               // 0 = accept any certificate (setInsecure)
+#endif
+
+#ifndef TLS_MFLN
+#define TLS_MFLN 1024              // Record size asked for: 512, 1024, 2048 or 4096
+#endif
+
+#ifndef TLS_XMIT_BUFFER
+#define TLS_XMIT_BUFFER 512        // Outgoing record size; longer writes are split
+#endif
+
+#ifndef TLS_DNS_TIMEOUT_MS
+#define TLS_DNS_TIMEOUT_MS 1000    // Host lookup before each connect
+#endif
+
+#ifndef TLS_TIMEOUT_MS
+#define TLS_TIMEOUT_MS 3000        // TCP connect, and the whole handshake (CPU included)
+#endif
+
+#ifndef TLS_HANDSHAKE_HEAP
+#define TLS_HANDSHAKE_HEAP 14000   // Heap a handshake needs besides the buffers, until one is measured
+#endif
+
+const uint16_t tlsFullRecord = 16384;
+const uint32_t tlsHeapRecheckMs = 1000;      // After a connect was put off for heap
+const uint32_t tlsLookupRetryMs = 5000;      // After a failed host lookup
+const uint32_t tlsStepMs = 1000;             // Longest BearSSL step (RSA/EC math), may overrun the timeout
+const uint32_t tlsConnectMaxMs = TLS_DNS_TIMEOUT_MS + 2 * TLS_TIMEOUT_MS + tlsStepMs;
+const time_t tlsClockValid = 1700000000;     // Any earlier time(): SNTP hasn't synced yet
+
+enum TlsMfln { TLS_MFLN_UNKNOWN, TLS_MFLN_SUPPORTED, TLS_MFLN_UNSUPPORTED };
+
+struct TlsTransport {
+  const char* host;
+  uint16_t port;
+  const char* rootCa;            // PEM in PROGMEM, nullptr = don't verify
+  const char* name;              // Label in /metrics
+  WiFiClientSecure client;
+  BearSSL::Session session;
+  BearSSL::X509List* anchors;
+  TlsMfln mfln;
+  uint16_t recvBuffer;           // Receive buffer in use
+
+  // Reported by /metrics
+  uint32_t handshakes;
+  uint32_t resumed;              // ...of which resumed a saved session
+  uint32_t failures;
+  uint32_t deferred;             // Connects put off for lack of heap (or a root CA)
+  uint32_t handshakeMsLast;
+  uint32_t handshakeMsMax;
+  uint32_t heapPeak;             // Heap taken at the peak of the last handshake
+  uint32_t heapPeakMax;
+  uint32_t heapHeld;             // Heap held by the open connection
+  int lastError;                 // BearSSL error of the last failure
+  uint32_t deferredAtMs;         // millis() of the last deferral, 0 = none pending
+  uint32_t lookupMs;             // Duration of the last host lookup
+  uint32_t lookupFailures;
+  uint32_t lookupAtMs;           // millis() of a failed lookup, 0 = none pending
+
+  // Between tlsHandshakeBegin() and tlsHandshakeEnd()
+  uint32_t startMs;
+  uint32_t freeBefore;
+  uint8_t offeredId[32];
+  uint8_t offeredIdLength;
+};
+
+/**
+ * Heap a handshake will need: what the last one took, or the buffers plus
+ * an estimate of the BearSSL context and certificate work
+ */
+uint32_t tlsHeapNeeded(const TlsTransport& t) {
+  if (t.heapPeakMax) return t.heapPeakMax;
+  return t.recvBuffer + TLS_XMIT_BUFFER + TLS_HANDSHAKE_HEAP;
+}
+
+/**
+ * Parse the root CA into a trust anchor (once; kept for every reconnect)
+ * @return false if it could not be loaded: out of heap, or no certificate
+ *         in the PEM
+ */
+bool tlsLoadAnchors(TlsTransport& t) {
+  if (t.anchors) return true;
+  size_t length = strlen_P(t.rootCa);
+  char* pem = (char*)malloc(length + 1);
+  if (!pem) return false;
+  memcpy_P(pem, t.rootCa, length + 1);
+  BearSSL::X509List* anchors = new (std::nothrow) BearSSL::X509List(pem);
+  free(pem);
+  if (!anchors) return false;
+  if (anchors->getCount() == 0) {
+    Serial.printf("[TLS] %s: root CA holds no usable certificate\n", t.name);
+    delete anchors;
+    return false;
+  }
+  t.anchors = anchors;
+  return true;
+}
+
+/**
+ * Get the client ready to connect: size the buffers, set the trust anchor,
+ * clock, session and timeouts, and look the host up
+ * @return false if the caller should not connect on this pass (the clock
+ *         isn't set yet, the heap is too low, the root CA could not be
+ *         loaded or the lookup failed)
+ */
+bool tlsPrepare(TlsTransport& t) {
+  bool verify = TLS_VERIFY && t.rootCa;
+  if (verify && time(nullptr) < tlsClockValid) return false;
+
+  t.recvBuffer = t.mfln == TLS_MFLN_UNSUPPORTED ? tlsFullRecord : TLS_MFLN;
+
+  if (t.deferredAtMs && millis() - t.deferredAtMs < tlsHeapRecheckMs) return false;
+  t.deferredAtMs = 0;
+  if (ESP.getFreeHeap() < tlsHeapNeeded(t) || ESP.getMaxFreeBlockSize() < t.recvBuffer + 512u) {
+    t.deferred++;
+    t.deferredAtMs = millis() | 1;
+    return false;
+  }
+
+  if (verify && !tlsLoadAnchors(t)) {
+    t.deferred++;
+    t.deferredAtMs = millis() | 1;
+    return false;
+  }
+
+  if (t.lookupAtMs && millis() - t.lookupAtMs < tlsLookupRetryMs) return false;
+  uint32_t start = millis();
+  IPAddress ip;
+  bool resolved = WiFi.hostByName(t.host, ip, TLS_DNS_TIMEOUT_MS) == 1;
+  t.lookupMs = millis() - start;
+  if (!resolved) {
+    t.lookupFailures++;
+    t.lookupAtMs = millis() | 1;
+    Serial.printf("[TLS] %s: lookup of %s failed (%u ms)\n", t.name, t.host, (unsigned)t.lookupMs);
+    return false;
+  }
+  t.lookupAtMs = 0;
+
+  t.client.setTimeout(TLS_TIMEOUT_MS);
+  t.client.setBufferSizes(t.recvBuffer, TLS_XMIT_BUFFER);
+  t.client.setSession(&t.session);
+  if (verify) {
+    t.client.setTrustAnchors(t.anchors);
+    t.client.setX509Time(time(nullptr));
+  } else {
+    t.client.setInsecure();
+  }
+  return true;
+}
+
+/**
+ * Call right before the connect that performs the handshake
+ */
+void tlsHandshakeBegin(TlsTransport& t) {
+  const br_ssl_session_parameters* s = t.session.getSession();
+  t.offeredIdLength = s->session_id_len;
+  memcpy(t.offeredId, s->session_id, sizeof(t.offeredId));
+  t.freeBefore = ESP.getFreeHeap();
+#ifdef UMM_STATS_FULL
+  umm_free_heap_size_min_reset();
+#endif
+  t.startMs = millis();
+}
+
+/**
+ * Call right after it, with its outcome
+ */
+void tlsHandshakeEnd(TlsTransport& t, bool ok) {
+  uint32_t elapsed = millis() - t.startMs;
+#ifdef UMM_STATS_FULL
+  uint32_t lowest = umm_free_heap_size_min();
+  t.heapPeak = t.freeBefore > lowest ? t.freeBefore - lowest : 0;
+  if (t.heapPeak > t.heapPeakMax) t.heapPeakMax = t.heapPeak;
+#endif
+  if (t.mfln == TLS_MFLN_UNKNOWN) {
+    // Decided by the first handshake that gets far enough to tell
+    int error = ok ? 0 : t.client.getLastSSLError();
+    if (error == BR_ERR_TOO_LARGE || (ok && t.client.connected())) {
+      t.mfln = error == 0 && t.client.getMFLNStatus() ? TLS_MFLN_SUPPORTED : TLS_MFLN_UNSUPPORTED;
+      Serial.printf("[TLS] %s: max fragment length %u %s\n", t.name, TLS_MFLN,
+                    t.mfln == TLS_MFLN_SUPPORTED ? "accepted" : "refused, full records from now on");
+    }
+  }
+  if (!ok) {
+    t.failures++;
+    t.lastError = t.client.getLastSSLError();
+    Serial.printf("[TLS] %s: connect failed after %u ms, error %d\n", t.name, (unsigned)elapsed, t.lastError);
+    return;
+  }
+  // A server resuming a session answers with the ID that was offered
+  const br_ssl_session_parameters* s = t.session.getSession();
+  bool resumed = t.offeredIdLength > 0 && s->session_id_len == t.offeredIdLength &&
+                 memcmp(s->session_id, t.offeredId, t.offeredIdLength) == 0;
+  uint32_t freeAfter = ESP.getFreeHeap();
+  t.heapHeld = t.freeBefore > freeAfter ? t.freeBefore - freeAfter : 0;
+  t.handshakes++;
+  if (resumed) t.resumed++;
+  t.handshakeMsLast = elapsed;
+  if (elapsed > t.handshakeMsMax) t.handshakeMsMax = elapsed;
+  Serial.printf("[TLS] %s: %s handshake %u ms, heap peak %u held %u, %u-byte records\n", t.name,
+                resumed ? "resumed" : "full", (unsigned)elapsed, (unsigned)t.heapPeak,
+                (unsigned)t.heapHeld, t.recvBuffer);
+}
+
+/**
+ * Connect and handshake (blocking), for callers that own the connection;
+ * MQTT lets PubSubClient connect and brackets that with the two calls above
+ */
+bool tlsConnect(TlsTransport& t) {
+  tlsHandshakeBegin(t);
+  bool ok = t.client.connect(t.host, t.port);
+  tlsHandshakeEnd(t, ok);
+  return ok;
+}
+
+#endif // TLS_TRANSPORT_H
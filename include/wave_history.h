@@ -0,0 +1,211 @@
+#ifndef WAVE_HISTORY_H
+#define WAVE_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Waveform history and delta-encoded frames
+ * =========================================
+ * Every processed sample is kept in a power-of-two ring indexed by its
+ * sequence number (the acquisition tick), so a reader holding a cursor can
+ * ask for "everything after seq N" and never sees a sample twice.
+ *
+ * Frame layout served by /wave (all little-endian):
+ *   u8   version          = 1
+ *   u8   flags            bit 0: samples between `since` and firstSeq were lost
+ *                         bit 1: some samples in the frame are fill (below)
+ *   u16  interval         sample period in ms
+ *   u32  firstSeq         sequence number of the first sample
+ *   u16  count            samples in this frame (0 = nothing new)
+ *   i16  first            first sample, ADC x 8
+ *   ...  count-1 deltas   zigzag varints: 1 byte for |d| < 64, 2 for < 8192
+ * The next request should use since = firstSeq + count.
+ * A PPG at 50 Hz moves a few ADC x 8 units per sample, so nearly every
+ * delta is a single byte.
+ *
+ * Samples the acquisition ring dropped (overruns) still get their sequence
+ * numbers, holding the last real value, so seq stays an exact index. They
+ * are marked in a bitmap beside the ring; a frame that contains any has
+ * bit 1 set, and `filled` counts them all for /metrics.
+ */
+
+#ifndef WAVE_HISTORY_SIZE
+#define WAVE_HISTORY_SIZE 512      // Samples kept (10.24 s at 50Hz); power of two
+#endif
+
+#if (WAVE_HISTORY_SIZE & (WAVE_HISTORY_SIZE - 1)) != 0
+#error "WAVE_HISTORY_SIZE must be a power of two"
+#endif
+
+const uint8_t waveFrameVersion = 1;
+const uint8_t waveFlagGap = 0x01;
+const uint8_t waveFlagFilled = 0x02;
+const size_t waveFrameHeaderSize = 10;
+
+struct WaveHistory {
+  uint16_t samples[WAVE_HISTORY_SIZE];
+  uint32_t fill[WAVE_HISTORY_SIZE / 32];   // Bit set: that slot repeats the last real sample
+  uint32_t nextSeq;              // Sequence number the next push will get
+  uint32_t stored;               // Samples pushed since reset (saturates at size)
+  uint32_t filled;               // Fill samples pushed since boot
+};
+
+WaveHistory waveHistory;
+
+/**
+ * Forget all stored samples
+ */
+void waveHistoryReset(WaveHistory& h) {
+  h.nextSeq = 0;
+  h.stored = 0;
+  memset(h.fill, 0, sizeof(h.fill));
+}
+
+/**
+ * Mark or clear the fill bit of a ring slot
+ */
+inline void waveHistoryMark(WaveHistory& h, uint32_t seq, bool filled) {
+  uint32_t slot = seq & (WAVE_HISTORY_SIZE - 1);
+  uint32_t bit = 1UL << (slot & 31);
+  if (filled) h.fill[slot >> 5] |= bit;
+  else h.fill[slot >> 5] &= ~bit;
+}
+
+/**
+ * Whether a stored sample is fill
+ */
+inline bool waveHistoryIsFill(const WaveHistory& h, uint32_t seq) {
+  uint32_t slot = seq & (WAVE_HISTORY_SIZE - 1);
+  return (h.fill[slot >> 5] >> (slot & 31)) & 1;
+}
+
+/**
+ * Store the sample with sequence number seq. Sequence gaps (ring overruns)
+ * are filled by repeating the last value, and marked, so seq stays an
+ * exact index.
+ */
+inline void waveHistoryPush(WaveHistory& h, uint32_t seq, uint16_t value) {
+  if (h.stored > 0 && seq - h.nextSeq < WAVE_HISTORY_SIZE) {
+    uint16_t last = h.samples[(h.nextSeq - 1) & (WAVE_HISTORY_SIZE - 1)];
+    while (h.nextSeq != seq) {
+      waveHistoryMark(h, h.nextSeq, true);
+      h.samples[h.nextSeq++ & (WAVE_HISTORY_SIZE - 1)] = last;
+      h.filled++;
+      if (h.stored < WAVE_HISTORY_SIZE) h.stored++;
+    }
+  } else if (seq != h.nextSeq) {
+    h.stored = 0;   // Jumped a whole ring or more: nothing stored is contiguous
+  }
+  waveHistoryMark(h, seq, false);
+  h.samples[seq & (WAVE_HISTORY_SIZE - 1)] = value;
+  h.nextSeq = seq + 1;
+  if (h.stored < WAVE_HISTORY_SIZE) h.stored++;
+}
+
+/**
+ * Oldest sequence number still in the ring
+ */
+inline uint32_t waveHistoryOldest(const WaveHistory& h) {
+  return h.nextSeq - h.stored;
+}
+
+inline void wavePutU16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+inline void wavePutU32(uint8_t* p, uint32_t v) {
+  wavePutU16(p, (uint16_t)v);
+  wavePutU16(p + 2, (uint16_t)(v >> 16));
+}
+
+/**
+ * Encode every stored sample after cursor `since` into out
+ * @param intervalMs Sample period written into the header
+ * @return frame size in bytes: the bare header if there is nothing new, 0
+ *         if capacity cannot hold the header and one sample. Samples that
+ *         don't fit are left for the next request.
+ */
+size_t waveEncode(const WaveHistory& h, uint32_t since, uint16_t intervalMs,
+                  uint8_t* out, size_t capacity) {
+  if (capacity < waveFrameHeaderSize + 2) return 0;
+
+  uint32_t oldest = waveHistoryOldest(h);
+  uint8_t flags = 0;
+  // Cursor older than the ring (or from before a reboot): restart at oldest
+  if (since - oldest > h.stored) {
+    flags |= waveFlagGap;
+    since = oldest;
+  }
+  uint32_t available = h.nextSeq - since;
+
+  out[0] = waveFrameVersion;
+  wavePutU16(out + 2, intervalMs);
+  wavePutU32(out + 4, since);
+  size_t pos = waveFrameHeaderSize;
+  uint16_t count = 0;
+
+  int32_t prev = 0;
+  while (count < available) {
+    int32_t value = h.samples[(since + count) & (WAVE_HISTORY_SIZE - 1)];
+    if (count == 0) {
+      wavePutU16(out + pos, (uint16_t)value);
+      pos += 2;
+    } else {
+      int32_t delta = value - prev;
+      uint32_t zz = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+      uint8_t bytes[3];
+      size_t n = 0;
+      do {
+        bytes[n] = zz & 0x7F;
+        zz >>= 7;
+        if (zz) bytes[n] |= 0x80;
+        n++;
+      } while (zz);
+      if (pos + n > capacity) break;
+      for (size_t i = 0; i < n; i++) out[pos++] = bytes[i];
+    }
+    if (waveHistoryIsFill(h, since + count)) flags |= waveFlagFilled;
+    prev = value;
+    count++;
+  }
+  out[1] = flags;
+  wavePutU16(out + 8, count);
+  return count ? pos : waveFrameHeaderSize;
+}
+
+/**
+ * Decode a frame produced by waveEncode (used by the native tools)
+ * @return samples written to values, or -1 if the frame is malformed
+ */
+int waveDecode(const uint8_t* frame, size_t size, uint32_t* firstSeq,
+               uint16_t* values, size_t maxValues) {
+  if (size < waveFrameHeaderSize || frame[0] != waveFrameVersion) return -1;
+  *firstSeq = frame[4] | (frame[5] << 8) | ((uint32_t)frame[6] << 16) | ((uint32_t)frame[7] << 24);
+  uint16_t count = frame[8] | (frame[9] << 8);
+  if (count == 0) return 0;
+  if (count > maxValues || size < waveFrameHeaderSize + 2) return -1;
+
+  size_t pos = waveFrameHeaderSize;
+  int32_t value = (int16_t)(frame[pos] | (frame[pos + 1] << 8));
+  pos += 2;
+  values[0] = (uint16_t)value;
+  for (uint16_t i = 1; i < count; i++) {
+    uint32_t zz = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+      if (pos >= size || shift > 21) return -1;
+      b = frame[pos++];
+      zz |= (uint32_t)(b & 0x7F) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    value += (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+    values[i] = (uint16_t)value;
+  }
+  return pos == size ? count : -1;
+}
+
+#endif // WAVE_HISTORY_H
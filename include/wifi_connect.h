@@ -0,0 +1,172 @@
+#ifndef WIFI_CONNECT_H
+#define WIFI_CONNECT_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <stddef.h>
+
+/*
+ * Background WiFi bring-up
+ * ========================
+ * setup() used to wait up to 10 s for WiFi before sampling started. Now it
+ * calls wifiBegin() and moves on; wifiService() (a scheduler task) follows
+ * the link and calls wifiOnUp once it is connected.
+ *
+ * Fast reconnect: once connected, the access point's BSSID and channel and
+ * the DHCP lease (address, gateway, mask, DNS) are kept in RTC user memory,
+ * which survives resets and deep sleep but not a power cycle. On the next
+ * boot wifiBegin() sets the address statically and joins that BSSID on
+ * that channel, skipping the scan and DHCP. If that has not connected
+ * within WIFI_FAST_TIMEOUT_MS (the AP moved, or a different password) the
+ * cache is dropped and a normal scan-and-DHCP join follows. RTC memory
+ * rather than flash: it can be rewritten on every new lease without flash
+ * wear, and after a power cycle a fresh DHCP lease is the safer choice.
+ *
+ * WiFi.persistent(false) also stops the SDK from rewriting its own copy of
+ * the credentials in flash on every begin().
+ */
+
+#ifndef WIFI_FAST_TIMEOUT_MS
+#define WIFI_FAST_TIMEOUT_MS 3000  // Cached join allowed before falling back to scan + DHCP
+#endif
+
+const uint32_t wifiCacheMagic = 0x57494631;   // "WIF1"
+const uint32_t wifiCacheRtcBlock = 0;         // RTC user memory offset, in 4-byte blocks
+
+struct WifiCache {
+  uint32_t magic;
+  uint32_t ssidHash;             // Cache only applies to the network it was made for
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t mask;
+  uint32_t dns;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t check;                // wifiHash() of everything above
+};
+
+enum WifiLinkState { WIFI_LINK_FAST, WIFI_LINK_SCAN, WIFI_LINK_UP };
+
+WifiLinkState wifiState = WIFI_LINK_SCAN;
+const char* wifiSsid = nullptr;
+const char* wifiPassword = nullptr;
+void (*wifiOnUp)() = nullptr;      // Called on every (re)connection
+
+// Reported by /data and /metrics
+uint32_t wifiAttemptStartMs = 0;
+uint32_t wifiConnectedMs = 0;      // millis() of the first connection since boot, 0 = not yet
+uint32_t wifiLastConnectMs = 0;    // How long the last connection took
+bool wifiLastFast = false;         // ...and whether it came from the cache
+uint32_t wifiConnects = 0;
+uint32_t wifiFastConnects = 0;     // Connections made from the cache
+uint32_t wifiFastMisses = 0;       // Cached joins that timed out
+uint32_t wifiDisconnects = 0;
+
+/**
+ * FNV-1a
+ */
+uint32_t wifiHash(const uint8_t* data, size_t size) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+bool wifiCacheLoad(WifiCache& c) {
+  if (!ESP.rtcUserMemoryRead(wifiCacheRtcBlock, (uint32_t*)&c, sizeof(c))) return false;
+  return c.magic == wifiCacheMagic &&
+         c.ssidHash == wifiHash((const uint8_t*)wifiSsid, strlen(wifiSsid)) &&
+         c.check == wifiHash((const uint8_t*)&c, offsetof(WifiCache, check)) && c.ip != 0;
+}
+
+/**
+ * Remember the current AP and lease for the next boot
+ */
+void wifiCacheSave() {
+  WifiCache c;
+  memset(&c, 0, sizeof(c));
+  c.magic = wifiCacheMagic;
+  c.ssidHash = wifiHash((const uint8_t*)wifiSsid, strlen(wifiSsid));
+  c.ip = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.mask = (uint32_t)WiFi.subnetMask();
+  c.dns = (uint32_t)WiFi.dnsIP();
+  memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+  c.channel = (uint8_t)WiFi.channel();
+  c.check = wifiHash((const uint8_t*)&c, offsetof(WifiCache, check));
+  ESP.rtcUserMemoryWrite(wifiCacheRtcBlock, (uint32_t*)&c, sizeof(c));
+}
+
+void wifiCacheClear() {
+  WifiCache c;
+  memset(&c, 0, sizeof(c));
+  ESP.rtcUserMemoryWrite(wifiCacheRtcBlock, (uint32_t*)&c, sizeof(c));
+}
+
+/**
+ * Start joining the network and return at once
+ */
+void wifiBegin(const char* ssid, const char* password) {
+  wifiSsid = ssid;
+  wifiPassword = password;
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(true);
+  wifiAttemptStartMs = millis();
+
+  WifiCache c;
+  if (wifiCacheLoad(c)) {
+    WiFi.config(IPAddress(c.ip), IPAddress(c.gateway), IPAddress(c.mask), IPAddress(c.dns));
+    WiFi.begin(ssid, password, c.channel, c.bssid, true);
+    wifiState = WIFI_LINK_FAST;
+    return;
+  }
+  WiFi.begin(ssid, password);
+  wifiState = WIFI_LINK_SCAN;
+}
+
+void wifiLinkUp(bool fast) {
+  wifiLastConnectMs = millis() - wifiAttemptStartMs;
+  if (!wifiConnectedMs) wifiConnectedMs = millis();
+  wifiConnects++;
+  if (fast) wifiFastConnects++;
+  wifiLastFast = fast;
+  wifiState = WIFI_LINK_UP;
+  wifiCacheSave();
+  if (wifiOnUp) wifiOnUp();
+}
+
+/**
+ * Follow the link: finish a join, fall back from a stale cache, notice a
+ * drop (the core reconnects on its own). Call every ~100 ms.
+ */
+void wifiService() {
+  bool connected = WiFi.status() == WL_CONNECTED;
+  switch (wifiState) {
+    case WIFI_LINK_FAST:
+      if (connected) {
+        wifiLinkUp(true);
+      } else if (millis() - wifiAttemptStartMs >= WIFI_FAST_TIMEOUT_MS) {
+        wifiFastMisses++;
+        wifiCacheClear();
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // Back to DHCP
+        WiFi.begin(wifiSsid, wifiPassword);
+        wifiState = WIFI_LINK_SCAN;
+      }
+      break;
+    case WIFI_LINK_SCAN:
+      if (connected) wifiLinkUp(false);
+      break;
+    case WIFI_LINK_UP:
+      if (!connected) {
+        wifiDisconnects++;
+        wifiAttemptStartMs = millis();
+        wifiState = WIFI_LINK_SCAN;
+      }
+      break;
+  }
+}
+
+#endif // WIFI_CONNECT_H
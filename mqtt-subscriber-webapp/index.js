@@ -3,6 +3,7 @@ const express = require('express');
 const http = require('http');
 const { Server } = require('socket.io');
 const mqtt = require('mqtt');
+const { decodeTelemetry } = require('./telemetry');
 
 const app = express();
 const server = http.createServer(app);
@@ -14,7 +15,12 @@ const mqttOptions = {
   username: 'Paradox', // <-- Set your HiveMQ Cloud username
   password: 'Paradox1', // <-- Set your HiveMQ Cloud password
 };
-const mqttTopic = 'mrhasan/heart';
+const mqttTopic = 'mrhasan/heart';                  // Legacy one-JSON-per-second payloads
+const telemetryTopic = 'mrhasan/heart/+/telemetry';  // Batched binary frames
+const metaTopic = 'mrhasan/heart/+/meta';            // Retained device description
+
+// Last metadata and frame sequence number per device
+const devices = {};
 
 // Serve static files (for frontend)
 app.use(express.static('public'));
@@ -24,16 +30,59 @@ const mqttClient = mqtt.connect(mqttUrl, mqttOptions);
 
 mqttClient.on('connect', () => {
   console.log('Connected to HiveMQ Cloud MQTT broker');
-  mqttClient.subscribe(mqttTopic, (err) => {
+  mqttClient.subscribe([mqttTopic, telemetryTopic, metaTopic], (err) => {
     if (err) {
       console.error('MQTT subscribe error:', err);
     } else {
-      console.log('Subscribed to topic:', mqttTopic);
+      console.log('Subscribed to topics:', mqttTopic, telemetryTopic, metaTopic);
     }
   });
 });
 
+// Replay a frame's per-second records at their original spacing so the
+// page keeps updating once a second between frames
+function forwardTelemetry(deviceId, frame) {
+  const device = devices[deviceId] || (devices[deviceId] = {});
+  if (device.lastSeq !== undefined && frame.seq !== device.lastSeq + 1) {
+    console.warn(`Telemetry from ${deviceId}: ${frame.seq - device.lastSeq - 1} frame(s) lost`);
+  }
+  device.lastSeq = frame.seq;
+  const meta = device.meta || {};
+  const start = frame.seconds.length ? frame.seconds[0].timeMs : frame.baseMs;
+  frame.seconds.forEach((second) => {
+    setTimeout(() => {
+      io.emit('mqtt-data', {
+        userId: meta.userId,
+        deviceId,
+        dataType: 'heartRate',
+        bpm: second.bpm,
+        signal: second.signal,
+        detected: second.detected,
+        adequate: second.adequate,
+        deviceTimeMs: second.timeMs,
+        timestamp: second.epochMs !== null ? new Date(second.epochMs).toISOString() : undefined,
+      });
+    }, second.timeMs - start);
+  });
+  io.emit('mqtt-beats', { deviceId, beats: frame.beats });
+}
+
 mqttClient.on('message', (topic, message) => {
+  const parts = topic.split('/');
+  if (topic !== mqttTopic && parts.length === 4) {
+    const deviceId = parts[2];
+    try {
+      if (parts[3] === 'meta') {
+        (devices[deviceId] = devices[deviceId] || {}).meta = JSON.parse(message.toString());
+      } else if (parts[3] === 'telemetry') {
+        forwardTelemetry(deviceId, decodeTelemetry(message));
+      }
+    } catch (e) {
+      console.error(`Invalid ${parts[3]} message from ${deviceId}:`, e.message);
+    }
+    return;
+  }
+
   // Forward MQTT message to all connected web clients via Socket.IO
   try {
     const data = JSON.parse(message.toString());
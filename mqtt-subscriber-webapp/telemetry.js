@@ -0,0 +1,93 @@
+// telemetry.js
+// Decoder for the ESP8266's batched binary telemetry frames.
+// The layout is documented in include/telemetry_frame.h.
+
+const VERSION = 2;
+const HEADER_SIZE = 20;
+const V1_HEADER_SIZE = 12;   // Older frames, without baseEpochMs
+
+const SECOND = 0x01;
+const BEAT = 0x02;
+const WAVE = 0x03;
+
+function decodeWave(buf) {
+  const count = buf.readUInt16LE(8);
+  const values = [];
+  if (count === 0) return { firstSeq: buf.readUInt32LE(4), values };
+  let pos = 10;
+  let value = buf.readInt16LE(pos);
+  pos += 2;
+  values.push(value);
+  for (let i = 1; i < count; i++) {
+    let zz = 0, shift = 0, b;
+    do {
+      b = buf[pos++];
+      zz |= (b & 0x7f) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    value += (zz >>> 1) ^ -(zz & 1);
+    values.push(value);
+  }
+  return { firstSeq: buf.readUInt32LE(4), intervalMs: buf.readUInt16LE(2), values };
+}
+
+/**
+ * Decode one frame into { seq, baseMs, baseEpochMs, seconds[], beats[], wave }
+ * Records carry epochMs (UTC, ms since 1970) when the device clock was
+ * synchronised, otherwise null. Throws on a malformed or truncated frame.
+ */
+function decodeTelemetry(buf) {
+  const version = buf[0];
+  const headerSize = version === 1 ? V1_HEADER_SIZE : HEADER_SIZE;
+  if (version < 1 || version > VERSION || buf.length < headerSize) throw new Error('bad telemetry frame');
+  const records = buf.readUInt16LE(2);
+  const baseEpochMs = version === 1 ? 0 : Number(buf.readBigUInt64LE(12));
+  const frame = {
+    seq: buf.readUInt32LE(4),
+    baseMs: buf.readUInt32LE(8),
+    baseEpochMs: baseEpochMs || null,
+    seconds: [],
+    beats: [],
+    wave: null,
+  };
+  let pos = headerSize;
+  for (let i = 0; i < records; i++) {
+    const type = buf[pos];
+    const offsetMs = buf.readUInt16LE(pos + 1);
+    const timeMs = frame.baseMs + offsetMs;
+    const epochMs = baseEpochMs ? baseEpochMs + offsetMs : null;
+    pos += 3;
+    if (type === SECOND) {
+      frame.seconds.push({
+        timeMs,
+        epochMs,
+        bpm: buf[pos],
+        signal: buf.readUInt16LE(pos + 1),
+        detected: (buf[pos + 3] & 1) !== 0,
+        adequate: (buf[pos + 3] & 2) !== 0,
+      });
+      pos += 4;
+    } else if (type === BEAT) {
+      frame.beats.push({
+        timeMs,
+        epochMs,
+        ibiMs: buf.readUInt16LE(pos) / 10,
+        accepted: (buf[pos + 2] & 1) !== 0,
+      });
+      pos += 3;
+    } else if (type === WAVE) {
+      const length = buf.readUInt16LE(pos);
+      frame.wave = decodeWave(buf.subarray(pos + 2, pos + 2 + length));
+      // Sample n (wave sequence number) was taken at firstEpochMs + (n - firstSeq) * intervalMs
+      frame.wave.firstEpochMs = baseEpochMs && frame.wave.intervalMs
+        ? baseEpochMs + frame.wave.firstSeq * frame.wave.intervalMs - frame.baseMs : null;
+      pos += 2 + length;
+    } else {
+      throw new Error('unknown telemetry record ' + type);
+    }
+  }
+  if (pos !== buf.length) throw new Error('truncated telemetry frame');
+  return frame;
+}
+
+module.exports = { decodeTelemetry };
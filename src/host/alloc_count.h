@@ -0,0 +1,78 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <cstdlib>
+#include <new>
+
+/*
+ * Heap allocation counter (host only)
+ * ===================================
+ * Replaces the global operator new/delete, and on glibc malloc/calloc/
+ * realloc as well, with versions that count every call. Diff allocCount
+ * around a stretch of code to see how many allocations it made. Include
+ * from exactly one translation unit.
+ */
+
+uint64_t allocCount = 0;
+uint64_t allocBytes = 0;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void __libc_free(void* p);
+
+extern "C" void* malloc(size_t size) {
+  allocCount++;
+  allocBytes += size;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  allocCount++;
+  allocBytes += count * size;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+  allocCount++;
+  allocBytes += size;
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p) {
+  __libc_free(p);
+}
+
+// new/delete reach the counting malloc through libstdc++
+#else
+void* operator new(size_t size) {
+  allocCount++;
+  allocBytes += size;
+  void* p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  std::free(p);
+}
+#endif
+
+#endif // ALLOC_COUNT_H
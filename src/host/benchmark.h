@@ -0,0 +1,293 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+#include "replay_engine.h"
+
+/*
+ * Detector benchmark (native build only)
+ * ======================================
+ * Runs the detector over a fixed corpus and scores every case the same
+ * way, so two builds of the detector can be compared for accuracy and
+ * speed:
+ *
+ *   sensitivity   true beats detected / true beats
+ *   ppv           detections that are true beats / detections
+ *                 (a detection matches the nearest unclaimed true beat
+ *                 within benchToleranceUs, after removing the filter delay)
+ *   bpm error     mean |reported BPM - reference BPM| over the once-a-second
+ *                 readings, the reference being the mean of the last
+ *                 HR_STATS_WINDOW true intervals; coverage is the share of
+ *                 seconds (after warm-up) with a reading at all. Scored for
+ *                 the fused rate readHeartRate() reports and for the
+ *                 spectral estimate alone
+ *   ibi error     measureIbiError() over consecutive matched beats
+ *   throughput    output samples per second of host time and host cycles
+ *                 per sample, for the detector alone (best of a few runs),
+ *                 and the spectral estimator's cycles per sample on top
+ *
+ * The synthetic cases cover clean, noisy, motion-corrupted, arrhythmic
+ * (ectopic and irregular), drifting, slow, fast, weak and faint (below
+ * the peak detector's amplitude threshold) signals with
+ * fixed seeds, so results are reproducible. Annotated recordings (CSV with
+ * a beat column, see loadCsvTrace()) found in a corpus directory are added
+ * as further cases.
+ *
+ * Results are written as JSON for tools/bench_compare.py.
+ */
+
+const uint32_t benchToleranceUs = 150000;   // Detection to true beat match window
+const uint32_t benchWarmupMs = 10000;       // BPM readings ignored while the window fills
+const int benchSpeedRuns = 5;
+
+struct BenchCase {
+  std::string name;
+  ReplayTrace trace;
+};
+
+struct BenchResult {
+  std::string name;
+  double seconds = 0;
+  uint32_t truthBeats = 0;
+  uint32_t detected = 0;
+  uint32_t truePositives = 0;
+  double sensitivity = 0;
+  double ppv = 0;
+  double bpmMae = 0;
+  double bpmMax = 0;
+  double coverage = 0;
+  double spectralMae = 0;
+  double spectralCoverage = 0;
+  IbiError ibi;
+  double samplesPerSecond = 0;      // Detector only, host wall time
+  double cyclesPerSample = 0;
+  double spectralCyclesPerSample = 0;
+};
+
+/**
+ * Synthetic part of the corpus
+ */
+void benchSyntheticCases(float seconds, std::vector<BenchCase>& cases) {
+  struct Spec {
+    const char* name;
+    SynthParams p;
+  };
+  auto synth = [seconds](float bpm, float noise, float drift, float hrv, float ectopic,
+                         float motion, float amplitude, uint32_t seed) {
+    SynthParams p;
+    p.bpm = bpm;
+    p.seconds = seconds;
+    p.noise = noise;
+    p.drift = drift;
+    p.hrv = hrv;
+    p.ectopic = ectopic;
+    p.motion = motion;
+    p.amplitude = amplitude;
+    p.seed = seed;
+    return p;
+  };
+  const Spec specs[] = {
+    {"clean",      synth(72, 5, 0, 0.03f, 0, 0, 200, 1)},
+    {"noise",      synth(72, 40, 0, 0.03f, 0, 0, 200, 2)},
+    {"motion",     synth(72, 5, 0, 0.03f, 0, 250, 200, 3)},
+    {"ectopic",    synth(72, 5, 0, 0.03f, 0.1f, 0, 200, 4)},
+    {"irregular",  synth(90, 5, 0, 0.25f, 0, 0, 200, 5)},
+    {"drift",      synth(72, 5, 150, 0.03f, 0, 0, 200, 6)},
+    {"brady",      synth(42, 5, 0, 0.03f, 0, 0, 200, 7)},
+    {"tachy",      synth(160, 5, 0, 0.03f, 0, 0, 200, 8)},
+    {"weak",       synth(72, 5, 0, 0.03f, 0, 0, 15, 9)},
+    {"faint",      synth(66, 10, 0, 0.03f, 0, 0, 5, 11)},
+    {"combined",   synth(80, 20, 80, 0.08f, 0.05f, 120, 150, 10)},
+  };
+  for (const Spec& s : specs) {
+    BenchCase c;
+    c.name = s.name;
+    synthesizeTrace(s.p, c.trace);
+    cases.push_back(c);
+  }
+}
+
+/**
+ * Add every annotated *.csv in dir
+ * @return recordings loaded, or -1 if dir can't be read
+ */
+int benchLoadCorpus(const char* dir, uint32_t traceIntervalUs, std::vector<BenchCase>& cases) {
+  DIR* d = opendir(dir);
+  if (!d) return -1;
+  std::vector<std::string> names;
+  while (dirent* e = readdir(d)) {
+    std::string name = e->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0) names.push_back(name);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  int loaded = 0;
+  for (const std::string& name : names) {
+    BenchCase c;
+    c.name = name.substr(0, name.size() - 4);
+    std::string path = std::string(dir) + "/" + name;
+    if (!loadCsvTrace(path.c_str(), traceIntervalUs, c.trace) || c.trace.truthBeatsUs.empty()) {
+      fprintf(stderr, "Skipping %s: no samples or no beat annotations\n", path.c_str());
+      continue;
+    }
+    cases.push_back(c);
+    loaded++;
+  }
+  return loaded;
+}
+
+/**
+ * Match detections to true beats one-to-one within benchToleranceUs
+ * @return true positives
+ */
+uint32_t benchMatchBeats(const std::vector<uint32_t>& detectedUs,
+                         const std::vector<uint32_t>& truthUs, double delayUs) {
+  uint32_t matched = 0;
+  size_t j = 0;
+  for (uint32_t d : detectedUs) {
+    double t = d - delayUs;
+    while (j < truthUs.size() && truthUs[j] + (double)benchToleranceUs < t) j++;
+    if (j < truthUs.size() && fabs(truthUs[j] - t) <= benchToleranceUs) {
+      matched++;
+      j++;   // Each true beat can be claimed once
+    }
+  }
+  return matched;
+}
+
+/**
+ * Mean of the last HR_STATS_WINDOW true intervals ending at or before
+ * atUs, as BPM (0 if there are fewer than two beats)
+ */
+double benchReferenceBpm(const std::vector<uint32_t>& truthUs, double atUs) {
+  size_t end = std::upper_bound(truthUs.begin(), truthUs.end(), atUs) - truthUs.begin();
+  if (end < 2) return 0;
+  size_t first = end > HR_STATS_WINDOW + 1 ? end - 1 - HR_STATS_WINDOW : 0;
+  double meanIbi = (double)(truthUs[end - 1] - truthUs[first]) / (end - 1 - first);
+  return 60e6 / meanIbi;
+}
+
+/**
+ * Mean and worst absolute error of once-a-second BPM readings, and the
+ * share of seconds after warm-up that had one
+ */
+void benchScoreBpm(const std::vector<uint32_t>& timesMs, const std::vector<int>& bpm,
+                   const std::vector<uint32_t>& truthUs, double delayUs, double* mae,
+                   double* maxError, double* coverage) {
+  uint32_t scored = 0, covered = 0;
+  double sumAbs = 0;
+  *maxError = 0;
+  for (size_t i = 0; i < timesMs.size(); i++) {
+    if (timesMs[i] < benchWarmupMs) continue;
+    scored++;
+    if (bpm[i] <= 0) continue;
+    double ref = benchReferenceBpm(truthUs, timesMs[i] * 1000.0 - delayUs);
+    if (ref <= 0) continue;
+    double e = fabs(bpm[i] - ref);
+    sumAbs += e;
+    *maxError = max(*maxError, e);
+    covered++;
+  }
+  *mae = covered ? sumAbs / covered : 0;
+  *coverage = scored ? (double)covered / scored : 0;
+}
+
+/**
+ * Detector-only speed: the trace decimated to the output rate, as the ring
+ * would deliver it, through a fresh PulseDetector; then the detector's
+ * filtered output through a fresh spectral estimator
+ */
+void benchSpeed(const ReplayTrace& trace, BenchResult& r) {
+  static PulseDetector detector;
+  static SpectralEstimator<1000 / sampleIntervalMs> spectral;
+  std::vector<int32_t> samples(trace.samples.size() / HR_OVERSAMPLE);
+  for (size_t f = 0; f < samples.size(); f++) {
+    int32_t sum = 0;
+    for (int k = 0; k < HR_OVERSAMPLE; k++) sum += trace.samples[f * HR_OVERSAMPLE + k];
+    samples[f] = sum * 8 / HR_OVERSAMPLE;
+  }
+  if (samples.empty()) return;
+  std::vector<int32_t> filtered(samples.size());
+  detectorReset(detector);
+  for (size_t f = 0; f < samples.size(); f++) {
+    detectorProcessFrame(detector, f, &samples[f]);
+    filtered[f] = detector.channel[0].filtered;
+  }
+
+  double bestCycles = 0, bestSeconds = 0, bestSpectral = 0;
+  for (int run = 0; run < benchSpeedRuns; run++) {
+    detectorReset(detector);
+    auto wallStart = std::chrono::steady_clock::now();
+    uint32_t start = ESP.getCycleCount();
+    detectorProcessInterleaved(detector, 0, samples.data(), (uint32_t)samples.size());
+    double cycles = (uint32_t)(ESP.getCycleCount() - start);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    if (run == 0 || cycles < bestCycles) bestCycles = cycles;
+    if (run == 0 || wall < bestSeconds) bestSeconds = wall;
+
+    spectralReset(spectral);
+    start = ESP.getCycleCount();
+    for (int32_t x : filtered) spectralPush(spectral, x);
+    cycles = (uint32_t)(ESP.getCycleCount() - start);
+    if (run == 0 || cycles < bestSpectral) bestSpectral = cycles;
+  }
+  r.cyclesPerSample = bestCycles / samples.size();
+  r.samplesPerSecond = bestSeconds > 0 ? samples.size() / bestSeconds : 0;
+  r.spectralCyclesPerSample = bestSpectral / samples.size();
+}
+
+/**
+ * Replay one case through the full acquisition path and score it
+ */
+BenchResult benchRun(const BenchCase& c) {
+  BenchResult r;
+  r.name = c.name;
+  ReplayResult replay = replayTrace(c.trace);
+  const std::vector<uint32_t>& truth = c.trace.truthBeatsUs;
+  r.seconds = (double)replay.samples * replayReadIntervalUs() / 1e6;
+  r.truthBeats = truth.size();
+  r.detected = replay.beatsUs.size();
+
+  double delay = detectorDelayUs(replay.beatsUs, truth);
+  r.truePositives = benchMatchBeats(replay.beatsUs, truth, delay);
+  r.sensitivity = r.truthBeats ? (double)r.truePositives / r.truthBeats : 0;
+  r.ppv = r.detected ? (double)r.truePositives / r.detected : 0;
+  r.ibi = measureIbiError(replay.beatsUs, truth);
+
+  benchScoreBpm(replay.secondsMs, replay.secondsBpm, truth, delay, &r.bpmMae, &r.bpmMax, &r.coverage);
+  double spectralMax = 0;
+  benchScoreBpm(replay.secondsMs, replay.secondsSpectralBpm, truth, delay, &r.spectralMae,
+                &spectralMax, &r.spectralCoverage);
+
+  benchSpeed(c.trace, r);
+  return r;
+}
+
+/**
+ * Write results as one JSON document
+ */
+void benchWriteJson(FILE* f, const std::vector<BenchResult>& results) {
+  fprintf(f, "{\"detector\":{\"sampleHz\":%u,\"oversample\":%d,\"interpolation\":%s,"
+             "\"statsWindow\":%d,\"toleranceMs\":%u},\n \"cases\":[\n",
+          (unsigned)(1000 / sampleIntervalMs), HR_OVERSAMPLE, HR_PEAK_INTERPOLATION ? "true" : "false",
+          HR_STATS_WINDOW, (unsigned)(benchToleranceUs / 1000));
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    fprintf(f, "  {\"name\":\"%s\",\"seconds\":%.1f,\"truthBeats\":%u,\"detected\":%u,"
+               "\"sensitivity\":%.4f,\"ppv\":%.4f,\"bpmMae\":%.2f,\"bpmMax\":%.2f,\"coverage\":%.4f,"
+               "\"spectralMae\":%.2f,\"spectralCoverage\":%.4f,"
+               "\"ibiPairs\":%u,\"ibiMaeMs\":%.2f,\"ibiRmsMs\":%.2f,\"ibiMaxMs\":%.2f,"
+               "\"samplesPerSec\":%.0f,\"cyclesPerSample\":%.1f,\"spectralCyclesPerSample\":%.1f}%s\n",
+            r.name.c_str(), r.seconds, r.truthBeats, r.detected, r.sensitivity, r.ppv, r.bpmMae,
+            r.bpmMax, r.coverage, r.spectralMae, r.spectralCoverage, r.ibi.pairs,
+            r.ibi.meanAbsUs / 1000.0, r.ibi.rmsUs / 1000.0, r.ibi.maxAbsUs / 1000.0,
+            r.samplesPerSecond, r.cyclesPerSample, r.spectralCyclesPerSample,
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(f, " ]}\n");
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,129 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+ * Native Arduino HAL shim
+ * =======================
+ * Just enough of the Arduino/ESP8266 core for the hardware-independent
+ * headers in include/ to build on Linux. Time is virtual: millis()/micros()
+ * only advance when the replay engine moves halClockUs (unless halRealTime
+ * makes them follow the host clock, for the HTTP load test), and analogRead()
+ * returns whatever the engine last put in halAdcValue. timer1 callbacks are
+ * captured and fired by halTimerFire() instead of a hardware interrupt.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define PROGMEM
+#define PGM_P const char*
+
+#define A0 17
+#define INPUT 0
+#define OUTPUT 1
+
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_LOOP 1
+
+// ========================= VIRTUAL HARDWARE =========================
+inline uint64_t halClockUs = 0;               // Virtual time since boot
+inline uint16_t halAdcValue = 0;              // Next analogRead() result
+inline void (*halTimerCallback)() = nullptr;  // Attached timer1 ISR
+inline uint32_t halTimerTicks = 0;            // Last timer1_write() reload
+inline bool halRealTime = false;              // Time follows the host's steady clock
+
+/**
+ * Microseconds since boot: virtual, or host time since the first call in
+ * real-time mode
+ */
+inline uint64_t halNowUs() {
+  if (!halRealTime) return halClockUs;
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() { return (unsigned long)(halNowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)halNowUs(); }
+inline void delayMicroseconds(unsigned int us) {
+  if (!halRealTime) {
+    halClockUs += us;
+    return;
+  }
+  uint64_t until = halNowUs() + us;
+  while (halNowUs() < until) {}
+}
+inline void delay(unsigned long ms) { delayMicroseconds((unsigned int)(ms * 1000)); }
+inline void yield() {}
+
+inline int analogRead(uint8_t) { return halAdcValue; }
+inline void pinMode(uint8_t, uint8_t) {}
+inline long random(long howBig) { return howBig > 0 ? rand() % howBig : 0; }
+inline long random(long howSmall, long howBig) { return howSmall + random(howBig - howSmall); }
+
+inline void timer1_isr_init() {}
+inline void timer1_attachInterrupt(void (*callback)()) { halTimerCallback = callback; }
+inline void timer1_detachInterrupt() { halTimerCallback = nullptr; }
+inline void timer1_enable(uint8_t, uint8_t, uint8_t) {}
+inline void timer1_disable() {}
+inline void timer1_write(uint32_t ticks) { halTimerTicks = ticks; }
+
+/**
+ * Deliver one timer1 interrupt, as the hardware would at the reload period
+ */
+inline void halTimerFire() {
+  if (halTimerCallback) halTimerCallback();
+}
+
+// ========================= ESP / SERIAL =========================
+struct HalEsp {
+  /**
+   * Host cycle counter. Not ESP8266 cycles, but monotonic and cheap enough
+   * to compare hot-path variants against each other.
+   */
+  uint32_t getCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+  uint8_t getCpuFreqMHz() { return 80; }   // Nominal; host cycles are not ESP cycles
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMaxFreeBlockSize() { return 0; }
+};
+inline HalEsp ESP;
+
+struct HalSerial {
+  void begin(unsigned long) {}
+  void print(const char* s) { fputs(s, stdout); }
+  void print(char c) { fputc(c, stdout); }
+  void print(int v) { printf("%d", v); }
+  void print(unsigned int v) { printf("%u", v); }
+  void print(long v) { printf("%ld", v); }
+  void print(unsigned long v) { printf("%lu", v); }
+  void print(double v) { printf("%.2f", v); }
+  template <typename T> void println(T v) { print(v); fputc('\n', stdout); }
+  void println() { fputc('\n', stdout); }
+};
+inline HalSerial Serial;
+
+#endif // HOST_ARDUINO_H
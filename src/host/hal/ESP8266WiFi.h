@@ -0,0 +1,102 @@
+#ifndef HOST_ESP8266WIFI_H
+#define HOST_ESP8266WIFI_H
+
+#include <Arduino.h>
+#include <deque>
+#include <memory>
+
+/*
+ * Native WiFiClient / WiFiServer shim
+ * ===================================
+ * In-memory TCP for driving http_server.h on the host. A load generator
+ * opens a connection with halConnect() and exchanges bytes with the server
+ * through the returned HalSocket; the server side sees an ordinary
+ * WiFiClient from WiFiServer::accept().
+ *
+ * Writes are non-blocking and limited, like lwIP's, to halSendBuffer bytes
+ * the peer has not read yet, so a slow reader pushes back on the server
+ * the way it does on the device.
+ */
+
+const size_t halSendBuffer = 2920;           // TCP_SND_BUF of the ESP8266 core (2 x MSS)
+
+struct HalSocket {
+  std::deque<uint8_t> toServer;
+  std::deque<uint8_t> toClient;
+  bool serverClosed = false;
+  bool clientClosed = false;
+};
+
+inline std::deque<std::shared_ptr<HalSocket>> halPendingConnections;
+
+/**
+ * Open a connection to the (single) WiFiServer
+ */
+inline std::shared_ptr<HalSocket> halConnect() {
+  auto socket = std::make_shared<HalSocket>();
+  halPendingConnections.push_back(socket);
+  return socket;
+}
+
+class WiFiClient {
+ public:
+  WiFiClient() = default;
+  explicit WiFiClient(std::shared_ptr<HalSocket> s) : socket(std::move(s)) {}
+
+  uint8_t connected() {
+    return socket && !socket->serverClosed && (!socket->clientClosed || !socket->toServer.empty());
+  }
+  int available() { return socket ? (int)socket->toServer.size() : 0; }
+  int read() {
+    if (!available()) return -1;
+    uint8_t b = socket->toServer.front();
+    socket->toServer.pop_front();
+    return b;
+  }
+  int read(uint8_t* buf, size_t size) {
+    size_t n = min(size, (size_t)available());
+    for (size_t i = 0; i < n; i++) {
+      buf[i] = socket->toServer.front();
+      socket->toServer.pop_front();
+    }
+    return (int)n;
+  }
+  int availableForWrite() {
+    if (!connected() || socket->clientClosed) return 0;
+    return (int)(halSendBuffer - min(halSendBuffer, socket->toClient.size()));
+  }
+  size_t write(const uint8_t* buf, size_t size) {
+    size_t n = min(size, (size_t)availableForWrite());
+    socket->toClient.insert(socket->toClient.end(), buf, buf + n);
+    return n;
+  }
+  size_t write(uint8_t b) { return write(&b, 1); }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t write_P(const char* buf, size_t size) { return write((const uint8_t*)buf, size); }
+  void setNoDelay(bool) {}
+  // Closes the connection for every copy, as on the device
+  void stop() {
+    if (socket) socket->serverClosed = true;
+    socket.reset();
+  }
+  operator bool() { return connected(); }
+
+ private:
+  std::shared_ptr<HalSocket> socket;
+};
+
+class WiFiServer {
+ public:
+  explicit WiFiServer(uint16_t) {}
+  void begin() {}
+  void setNoDelay(bool) {}
+  WiFiClient accept() {
+    if (halPendingConnections.empty()) return WiFiClient();
+    WiFiClient client(halPendingConnections.front());
+    halPendingConnections.pop_front();
+    return client;
+  }
+  WiFiClient available() { return accept(); }
+};
+
+#endif // HOST_ESP8266WIFI_H
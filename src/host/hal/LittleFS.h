@@ -0,0 +1,79 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+/*
+ * Native LittleFS shim
+ * ====================
+ * The subset of the ESP8266 FS API the firmware uses, backed by ordinary
+ * files under halFsRoot so flash-backed code can be exercised and
+ * benchmarked on the host. Paths are flattened ("/tlog3.seg" becomes
+ * "<root>/tlog3.seg"). A File shares its stdio handle between copies, like
+ * the core's reference-counted File.
+ */
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+
+inline std::string halFsRoot = "/tmp/hal_littlefs";
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+ public:
+  File() {}
+  explicit File(FILE* f) : file_(f, fclose) {}
+
+  size_t write(const uint8_t* data, size_t size) {
+    return file_ ? fwrite(data, 1, size, file_.get()) : 0;
+  }
+  size_t read(uint8_t* data, size_t size) {
+    return file_ ? fread(data, 1, size, file_.get()) : 0;
+  }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+    return file_ && fseek(file_.get(), pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+  }
+  size_t position() const { return file_ ? (size_t)ftell(file_.get()) : 0; }
+  size_t size() const {
+    if (!file_) return 0;
+    long at = ftell(file_.get());
+    fseek(file_.get(), 0, SEEK_END);
+    long end = ftell(file_.get());
+    fseek(file_.get(), at, SEEK_SET);
+    return (size_t)end;
+  }
+  void flush() {
+    if (file_) fflush(file_.get());
+  }
+  void close() { file_.reset(); }
+  explicit operator bool() const { return (bool)file_; }
+
+ private:
+  std::shared_ptr<FILE> file_;
+};
+
+struct HalFS {
+  std::string path(const char* name) { return halFsRoot + "/" + (name[0] == '/' ? name + 1 : name); }
+
+  bool begin() {
+    mkdir(halFsRoot.c_str(), 0755);
+    struct stat st;
+    return stat(halFsRoot.c_str(), &st) == 0;
+  }
+  void end() {}
+  File open(const char* name, const char* mode) {
+    const char* m = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+    FILE* f = fopen(path(name).c_str(), m);
+    return f ? File(f) : File();
+  }
+  bool exists(const char* name) {
+    struct stat st;
+    return stat(path(name).c_str(), &st) == 0;
+  }
+  bool remove(const char* name) { return ::remove(path(name).c_str()) == 0; }
+  bool rename(const char* from, const char* to) { return ::rename(path(from).c_str(), path(to).c_str()) == 0; }
+};
+inline HalFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,344 @@
+#ifndef HTTP_LOAD_H
+#define HTTP_LOAD_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <string>
+#include <vector>
+#include "replay_engine.h"
+#include "http_server.h"
+#include "scheduler.h"
+#include "detector_json.h"
+#include "dashboard_html.h"
+
+/*
+ * HTTP load test (native build only)
+ * ==================================
+ * Runs http_server.h and the detector together in real time, the way
+ * loop() does on the device: a synthetic pulse is sampled by the timer ISR
+ * whenever a read falls due, and the scheduler runs the detect and http
+ * tasks at their firmware periods and priorities. N clients on the
+ * in-memory sockets of the HAL (hal/ESP8266WiFi.h) keep one keep-alive
+ * connection each and request /, /bpm, /signal, /status and /data in turn,
+ * sending the next request as soon as a response is complete. Every fourth
+ * client reads slowly (httpLoadSlowBytes per httpLoadSlowMs), like a phone
+ * on weak WiFi.
+ *
+ * The same run is made with no clients first, and both are reported:
+ *
+ *   requests/s    complete, well-formed responses per second
+ *   latency       request sent to response complete, p50 and p99
+ *   busy          503s (every slot taken); the client retries after 1 s
+ *   errors        malformed responses and connections dropped mid-request
+ *   sample jitter how late timer reads ran behind their due time; the
+ *                 cooperative loop can only fire them between tasks, so
+ *                 this is how long the HTTP work held everything else up
+ *   detect lag    age of the oldest sample each detector run picked up
+ *
+ * Timings are host timings; compare runs against each other, not against
+ * the device. The test fails on errors or ring overruns.
+ */
+
+const int httpLoadSlowEvery = 4;             // Every 4th client is a slow reader
+const size_t httpLoadSlowBytes = 256;
+const uint32_t httpLoadSlowMs = 100;
+const uint32_t httpLoadRetryMs = 1000;       // Retry-After of the 503
+
+static const char* const httpLoadPaths[] = {"/", "/bpm", "/signal", "/status", "/data"};
+const int httpLoadPathCount = sizeof(httpLoadPaths) / sizeof(httpLoadPaths[0]);
+
+struct HttpLoadClient {
+  std::shared_ptr<HalSocket> socket;
+  bool slow = false;
+  int route = 0;
+  bool waiting = false;          // Request sent, response not complete
+  uint32_t sentUs = 0;
+  uint32_t nextReadMs = 0;       // Slow readers: next read
+  uint32_t retryMs = 0;          // After a 503: reconnect at
+  std::string received;          // Response bytes so far
+};
+
+struct HttpLoadResult {
+  int clients = 0;
+  double seconds = 0;
+  uint32_t responses = 0;
+  uint32_t busy = 0;
+  uint32_t errors = 0;
+  uint32_t timeouts = 0;
+  uint32_t overruns = 0;
+  std::vector<uint32_t> latencyUs;
+  std::vector<uint32_t> jitterUs;
+  std::vector<uint32_t> lagUs;
+  uint32_t pollUsMax = 0;
+};
+
+HttpLoadResult* httpLoadResult = nullptr;
+uint32_t httpLoadLastReadUs = 0;   // When the ISR last ran
+
+// ========================= FIRMWARE SIDE =========================
+
+void httpLoadRoot(HttpConn& c) {
+  httpReplyFlash(c, 200, "text/html", dashboardHtmlGz, dashboardHtmlGzLen,
+                 "Content-Encoding: gzip\r\nCache-Control: no-cache\r\n");
+}
+
+void httpLoadBpm(HttpConn& c) {
+  TextBuffer b = httpBody(c);
+  textPrintf(b, "%d", fusedBpm);
+  httpSendText(c, "text/plain", b);
+}
+
+void httpLoadSignal(HttpConn& c) {
+  TextBuffer b = httpBody(c);
+  textPrintf(b, "%d", signalValue);
+  httpSendText(c, "text/plain", b);
+}
+
+void httpLoadStatus(HttpConn& c) {
+  httpReply(c, 200, "text/plain", pulseDetected ? "connected" : "detecting");
+}
+
+void httpLoadData(HttpConn& c) {
+  TextBuffer b = httpBody(c);
+  textPrintf(b, "{\"timestamp\":%lu,", millis());
+  detectorJson(b);
+  textPrintf(b, "\"http\":{\"connections\":%d,\"requests\":%u}}", httpConnections(),
+             (unsigned)httpRequests);
+  httpSendText(c, "application/json", b);
+}
+
+void httpLoadDetect() {
+  uint32_t pending = sampleRingLevel(acqRing);
+  if (pending > 0 && httpLoadResult) {
+    uint32_t oldestUs = httpLoadLastReadUs - (pending - 1) * sampleIntervalUs;
+    httpLoadResult->lagUs.push_back(micros() - oldestUs);
+  }
+  readHeartRate(acqRing);
+}
+
+void httpLoadPoll() {
+  httpServerPoll();
+}
+
+// ========================= CLIENT SIDE =========================
+
+void httpLoadConnect(HttpLoadClient& client) {
+  client.socket = halConnect();
+  client.received.clear();
+  client.waiting = false;
+}
+
+/**
+ * Parse a complete response off the front of client.received
+ * @return status, 0 if incomplete, -1 if malformed; sets keepAlive
+ */
+int httpLoadTakeResponse(HttpLoadClient& client, bool* keepAlive) {
+  size_t end = client.received.find("\r\n\r\n");
+  if (end == std::string::npos) return 0;
+  int status = 0;
+  if (sscanf(client.received.c_str(), "HTTP/1.1 %d", &status) != 1) return -1;
+  std::string head = client.received.substr(0, end);
+  size_t at = head.find("Content-Length: ");
+  size_t length = at == std::string::npos ? 0 : strtoul(head.c_str() + at + 16, nullptr, 10);
+  if (at == std::string::npos && status != 304) return -1;
+  if (client.received.size() < end + 4 + length) return 0;
+  *keepAlive = head.find("Connection: keep-alive") != std::string::npos;
+  client.received.erase(0, end + 4 + length);
+  return status;
+}
+
+/**
+ * Move one client along: send, read what it can, check what it got
+ */
+void httpLoadStep(HttpLoadClient& client, HttpLoadResult& r) {
+  uint32_t nowMs = millis();
+  if (!client.socket) {
+    if ((int32_t)(nowMs - client.retryMs) >= 0) httpLoadConnect(client);
+    return;
+  }
+  HalSocket& s = *client.socket;
+
+  if (!client.waiting) {
+    if (s.serverClosed) {             // Idle connection closed by the server
+      httpLoadConnect(client);
+      return;
+    }
+    char request[128];
+    int n = snprintf(request, sizeof(request),
+                     "GET %s HTTP/1.1\r\nHost: esp8266\r\nUser-Agent: http-load\r\nAccept: */*\r\n\r\n",
+                     httpLoadPaths[client.route]);
+    s.toServer.insert(s.toServer.end(), request, request + n);
+    client.route = (client.route + 1) % httpLoadPathCount;
+    client.waiting = true;
+    client.sentUs = micros();
+    return;
+  }
+
+  size_t take = s.toClient.size();
+  if (client.slow) {
+    if ((int32_t)(nowMs - client.nextReadMs) < 0) return;
+    client.nextReadMs = nowMs + httpLoadSlowMs;
+    take = min(take, httpLoadSlowBytes);
+  }
+  client.received.append(s.toClient.begin(), s.toClient.begin() + take);
+  s.toClient.erase(s.toClient.begin(), s.toClient.begin() + take);
+
+  bool keepAlive = false;
+  int status = httpLoadTakeResponse(client, &keepAlive);
+  if (status == 0) {
+    if (s.serverClosed && s.toClient.empty()) {
+      r.errors++;
+      httpLoadConnect(client);
+    }
+    return;
+  }
+  client.waiting = false;
+  if (status == 503) {
+    r.busy++;
+    client.socket.reset();
+    client.retryMs = nowMs + httpLoadRetryMs;
+    return;
+  }
+  if (status == 200 && client.received.empty()) {
+    r.responses++;
+    r.latencyUs.push_back(micros() - client.sentUs);
+  } else {
+    r.errors++;
+  }
+  if (!keepAlive) {
+    s.clientClosed = true;
+    httpLoadConnect(client);
+  }
+}
+
+// ========================= RUN =========================
+
+uint32_t httpLoadPercentile(std::vector<uint32_t>& v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+/**
+ * Serve clients for the given time while the detector runs
+ */
+HttpLoadResult httpLoadRun(const ReplayTrace& trace, int clients, float seconds) {
+  HttpLoadResult r;
+  r.clients = clients;
+  httpLoadResult = &r;
+
+  heartRateReset();
+  acqRing.head = acqRing.tail = acqRing.overruns = 0;
+  acqTick = acqReads = 0;
+  schedTaskCount = 0;
+  schedulerAdd("detect", httpLoadDetect, sampleIntervalMs, 0, 2000);
+  schedulerAdd("http", httpLoadPoll, 10, 1, 5000);
+  httpPollUsMax = 0;
+  httpTimeouts = 0;
+
+  std::vector<HttpLoadClient> pool(clients);
+  for (int i = 0; i < clients; i++) {
+    pool[i].slow = i % httpLoadSlowEvery == httpLoadSlowEvery - 1;
+    pool[i].route = i % httpLoadPathCount;
+    httpLoadConnect(pool[i]);
+  }
+
+  uint32_t startUs = micros();
+  acquisitionBegin(A0, sampleIntervalMs);
+  uint32_t nextReadUs = micros();
+  size_t sample = 0;
+  uint32_t endUs = startUs + (uint32_t)(seconds * 1e6f);
+  // The timer ISR, as soon as the loop gets back to it. Also fired between
+  // client steps, so the clients' own work isn't counted as jitter.
+  auto fireDueReads = [&]() {
+    uint32_t now = micros();
+    while ((int32_t)(now - nextReadUs) >= 0) {
+      r.jitterUs.push_back(now - nextReadUs);
+      halAdcValue = trace.samples[sample++ % trace.samples.size()];
+      httpLoadLastReadUs = now;
+      halTimerFire();
+      nextReadUs += acqReadIntervalUs;
+    }
+  };
+  while ((int32_t)(micros() - endUs) < 0) {
+    fireDueReads();
+    schedulerRun();
+    for (HttpLoadClient& client : pool) {
+      fireDueReads();
+      httpLoadStep(client, r);
+    }
+  }
+  r.seconds = (micros() - startUs) / 1e6;
+  r.overruns = acqRing.overruns;
+  r.pollUsMax = httpPollUsMax;
+  r.timeouts = httpTimeouts;
+
+  for (HttpLoadClient& client : pool) {
+    if (client.socket) client.socket->clientClosed = true;
+  }
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    if (httpConns[i].state != HTTP_FREE) httpClose(httpConns[i]);
+  }
+  halPendingConnections.clear();
+  httpLoadResult = nullptr;
+  return r;
+}
+
+/**
+ * --http-load: idle run, then the same with N clients
+ */
+int httpLoadTest(int clients, float seconds) {
+  SynthParams synth;
+  synth.seconds = 60;
+  synth.hrv = 0.05f;
+  ReplayTrace trace;
+  synthesizeTrace(synth, trace);
+
+  halRealTime = true;
+  httpRouteCount = 0;
+  httpOn("/", httpLoadRoot);
+  httpOn("/bpm", httpLoadBpm);
+  httpOn("/signal", httpLoadSignal);
+  httpOn("/status", httpLoadStatus);
+  httpOn("/data", httpLoadData);
+  httpServerBegin();
+
+  HttpLoadResult runs[2] = {httpLoadRun(trace, 0, seconds), httpLoadRun(trace, clients, seconds)};
+
+  printf("http load: %d clients (%d slow) for %.0f s, %d slots x %u bytes (%u bytes per slot in all)\n",
+         clients, clients / httpLoadSlowEvery, seconds, HTTP_MAX_CLIENTS, (unsigned)HTTP_CONN_BUFFER,
+         (unsigned)sizeof(HttpConn));
+  printf("%-22s %12s %12s\n", "", "idle", "loaded");
+  printf("%-22s %12.0f %12.0f\n", "requests/s", runs[0].responses / runs[0].seconds,
+         runs[1].responses / runs[1].seconds);
+  for (int p = 0; p < 2; p++) {
+    const char* name = p ? "latency p99 ms" : "latency p50 ms";
+    printf("%-22s %12.2f %12.2f\n", name, httpLoadPercentile(runs[0].latencyUs, p ? 0.99 : 0.5) / 1000.0,
+           httpLoadPercentile(runs[1].latencyUs, p ? 0.99 : 0.5) / 1000.0);
+  }
+  printf("%-22s %12u %12u\n", "busy (503)", (unsigned)runs[0].busy, (unsigned)runs[1].busy);
+  printf("%-22s %12u %12u\n", "errors", (unsigned)runs[0].errors, (unsigned)runs[1].errors);
+  printf("%-22s %12u %12u\n", "timeouts", (unsigned)runs[0].timeouts, (unsigned)runs[1].timeouts);
+  const char* stats[3] = {"p50", "p99", "max"};
+  const double at[3] = {0.5, 0.99, 1.0};
+  for (int k = 0; k < 3; k++) {
+    char name[32];
+    snprintf(name, sizeof(name), "sample jitter %s us", stats[k]);
+    printf("%-22s %12u %12u\n", name, (unsigned)httpLoadPercentile(runs[0].jitterUs, at[k]),
+           (unsigned)httpLoadPercentile(runs[1].jitterUs, at[k]));
+  }
+  for (int k = 0; k < 3; k++) {
+    char name[32];
+    snprintf(name, sizeof(name), "detect lag %s ms", stats[k]);
+    printf("%-22s %12.2f %12.2f\n", name, httpLoadPercentile(runs[0].lagUs, at[k]) / 1000.0,
+           httpLoadPercentile(runs[1].lagUs, at[k]) / 1000.0);
+  }
+  printf("%-22s %12u %12u\n", "poll max us", (unsigned)runs[0].pollUsMax, (unsigned)runs[1].pollUsMax);
+  printf("%-22s %12u %12u\n", "ring overruns", (unsigned)runs[0].overruns, (unsigned)runs[1].overruns);
+
+  bool ok = runs[1].errors == 0 && runs[0].overruns == 0 && runs[1].overruns == 0;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
+
+#endif // HTTP_LOAD_H
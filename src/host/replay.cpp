@@ -0,0 +1,905 @@
+/*
+ * Native PPG Replay Tool
+ * ======================
+ * Runs the firmware's beat detector on the host against a recorded or
+ * synthetic pulse trace, faster than real time.
+ *
+ * Usage:
+ *   replay --synth <bpm> [--seconds S] [--noise N] [--drift D] [--hrv F]
+ *   replay --csv <file>      (one value per line, or time_ms,value)
+ *   replay --bin <file>      (little-endian uint16 samples)
+ *   options: [--trace-us U] [--drain N] [--beats]
+ *   replay --decode <file>   (print a captured MQTT telemetry frame)
+ *   replay --tlog-bench <frames>
+ *   replay --alloc-check <seconds>
+ *   replay --timebase-check <ppm>
+ *   replay --pause-check <seconds>
+ *   replay --channel-check <seconds>
+ *   replay --publish-check <seconds>
+ *   replay --history-check <seconds>
+ *   replay --bench <results.json|-> [--corpus DIR] [--seconds S]
+ *   replay --http-load <clients> [--seconds S]
+ *
+ * --trace-us gives the spacing of single-column CSV and binary recordings
+ * (default: one sample per sampleIntervalMs); traces are resampled to the
+ * ADC read rate of the HR_OVERSAMPLE build.
+ * --drain N drains the ring every N output samples to emulate a busy
+ * loop(); beat times are then sampled once per drain, like the device would.
+ * Every replay also builds 10 s MQTT telemetry frames and checks that each
+ * decodes back to what was put in. --decode reads a frame saved from the
+ * broker, e.g. mosquitto_sub -t 'mrhasan/heart/+/telemetry' -C 1 > frame.bin
+ * --tlog-bench pushes frames through the offline flash log (telemetry_log.h)
+ * on a host directory, reboots it, drains it and reports throughput.
+ * --alloc-check runs the device's steady-state work (sampling, detection,
+ * /wave and MQTT frame encoding, the /data, /bpm, /metrics and Telegram
+ * text formatting) against a synthetic trace and fails if any of it
+ * touches the heap after the first few seconds.
+ * --timebase-check drives timebase.h with a mocked clock: a crystal off by
+ * the given ppm, SNTP readings with +/-5 ms of jitter every
+ * TIMEBASE_SYNC_MS and one 2 s server correction, over a virtual day. It
+ * reports the UTC error after the loop has settled and any timestamp that
+ * went backwards.
+ * --pause-check samples from boot for the given time, stopping acquisition
+ * for flash work (acquisitionPause()) every 700 ms for 1-400 ms, and fails
+ * if any sample's tick strays more than half a period from the instant it
+ * stands for, or if the run did not pass the 32-bit micros() wrap at
+ * 4295 s.
+ * --channel-check runs four synthetic sensors at different rates (the last
+ * one with no pulse) through one interleaved multi-channel detector, and
+ * fails unless every channel matches its own single-channel run.
+ * --publish-check replays a mixed recording (rest, noise, walking, sensor
+ * off, weak pulse) and counts the MQTT messages and frame bytes per hour
+ * with every reading published and with report by exception
+ * (signal_quality.h). It fails if the gated stream strays from an adequate
+ * reading by more than REPORT_DEADBAND_BPM or stays silent for longer than
+ * REPORT_KEEPALIVE_S.
+ * --history-check feeds the given number of seconds of readings, with
+ * gaps and dropouts, into the history store (bpm_history.h) and compares
+ * every stored second, minute and hour with aggregates recomputed from the
+ * full record; it also pages through /history with `next` and reports the
+ * store's size and the mean insert time.
+ * --bench scores the detector over the benchmark corpus (benchmark.h):
+ * sensitivity/PPV, BPM and IBI error, samples/s and cycles/sample per
+ * case, as a table and as JSON. --corpus adds the annotated CSV recordings
+ * in DIR; --seconds sets the length of the synthetic cases (default 300).
+ * Compare two result files with tools/bench_compare.py.
+ * --http-load serves the given number of concurrent keep-alive clients
+ * from http_server.h for S seconds (default 10) in real time while the
+ * detector runs, and reports requests/s, latency and sampling jitter
+ * against an idle run (http_load.h).
+ *
+ * Build and run with PlatformIO:
+ *   pio run -e native && .pio/build/native/program --synth 72
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "replay_engine.h"
+#include "telemetry_log.h"
+#include "detector_json.h"
+#include "timebase.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "http_load.h"
+#include "alloc_count.h"
+
+const int replayChannels = 4;      // Sensors in the --channel-check detector
+
+static void usage() {
+  fprintf(stderr,
+          "usage: replay (--synth BPM | --csv FILE | --bin FILE)\n"
+          "              [--seconds S] [--noise N] [--drift D] [--hrv F]\n"
+          "              [--trace-us U] [--drain N] [--beats]\n"
+          "       replay --decode FILE\n"
+          "       replay --tlog-bench FRAMES\n"
+          "       replay --alloc-check SECONDS\n"
+          "       replay --timebase-check PPM\n"
+          "       replay --pause-check SECONDS\n"
+          "       replay --channel-check SECONDS\n"
+          "       replay --publish-check SECONDS\n"
+          "       replay --history-check SECONDS\n"
+          "       replay --bench OUT.json [--corpus DIR] [--seconds S]\n"
+          "       replay --http-load CLIENTS [--seconds S]\n");
+}
+
+/**
+ * Build a typical 10 s frame (no waveform) with sequence number seq
+ */
+static size_t benchFrame(TelemetryBatch& batch, uint32_t seq) {
+  telemetryBegin(batch, seq, seq * 10000, 0);
+  for (uint32_t s = 0; s < 10; s++) {
+    telemetryAddSecond(batch, seq * 10000 + s * 1000, 70 + (seq + s) % 10, 500 + s, true);
+    telemetryAddBeat(batch, seq * 10000 + s * 1000 + 300, 830000 + s * 1000, true);
+  }
+  return telemetryFinish(batch);
+}
+
+/**
+ * Write, reboot, drain and tear the offline log; print throughput and the
+ * recovery results
+ */
+static int benchTelemetryLog(uint32_t frames) {
+  halFsRoot = "/tmp/replay_tlog";
+  LittleFS.begin();
+  for (uint32_t slot = 0; slot < TLOG_SEGMENTS; slot++) {
+    char path[16];
+    tlogPath(slot, path, sizeof(path));
+    LittleFS.remove(path);
+  }
+  LittleFS.remove(tlogCursorPath);
+
+  static TelemetryBatch batch;
+  const uint8_t batchFrames = 3;
+  static uint8_t drainBuffer[batchFrames * TELEMETRY_FRAME_SIZE];
+  static TelemetryRecord records[64];
+  tlogBegin(telemetryLog);
+  size_t frameSize = benchFrame(batch, 0);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; i++) {
+    size_t size = benchFrame(batch, i);
+    if (!tlogAppend(telemetryLog, batch.data, size)) {
+      fprintf(stderr, "append %u failed\n", i);
+      return 1;
+    }
+  }
+  double writeS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  uint32_t dropped = telemetryLog.dropped;
+
+  // Reboot: everything not dropped must come back
+  tlogBegin(telemetryLog);
+  uint32_t recovered = telemetryLog.pending;
+
+  // Drain half in batches, reboot again, then drain the rest checking order
+  uint32_t expectSeq = dropped;
+  uint32_t bad = 0, drained = 0, resent = 0;
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t limit = pass == 0 ? recovered / 2 : UINT32_MAX;
+    uint16_t lengths[batchFrames];
+    uint8_t count;
+    while (drained < limit &&
+           (count = tlogPeekBatch(telemetryLog, drainBuffer, sizeof(drainBuffer), lengths, batchFrames)) > 0) {
+      size_t offset = 0;
+      for (uint8_t i = 0; i < count && drained < limit; i++) {
+        uint32_t seq = 0, baseMs = 0;
+        if (telemetryDecode(drainBuffer + offset, lengths[i], &seq, &baseMs, records, 64) != 20) bad++;
+        if (seq < expectSeq) {
+          resent++;                       // Delivered before the reboot, cursor not yet saved
+        } else {
+          if (seq != expectSeq) bad++;
+          expectSeq = seq + 1;
+        }
+        tlogConsume(telemetryLog, lengths[i]);
+        offset += lengths[i];
+        drained++;
+      }
+    }
+    if (pass == 0) tlogBegin(telemetryLog);
+  }
+  double readS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Power cut mid-append: a torn record must be skipped, nothing else lost
+  for (uint32_t i = 0; i < 3; i++) {
+    size_t size = benchFrame(batch, frames + i);
+    tlogAppend(telemetryLog, batch.data, size);
+  }
+  char path[16];
+  tlogPath(telemetryLog.lastId, path, sizeof(path));
+  File f = LittleFS.open(path, "a");
+  uint8_t torn[6] = {(uint8_t)frameSize, (uint8_t)(frameSize >> 8), 0x12, 0x34, 1, 2};
+  f.write(torn, sizeof(torn));
+  f.close();
+  tlogBegin(telemetryLog);
+  uint32_t afterTear = telemetryLog.pending;
+  uint32_t tornCorrupt = telemetryLog.corrupt;
+
+  uint64_t capacity = (uint64_t)TLOG_SEGMENTS * TLOG_SEGMENT_BYTES;
+  printf("tlog         %u frames of %zu bytes, %u segments x %u bytes\n",
+         frames, frameSize, TLOG_SEGMENTS, TLOG_SEGMENT_BYTES);
+  printf("append       %.0f frames/s, %.2f MB/s (host)\n",
+         writeS > 0 ? frames / writeS : 0.0, writeS > 0 ? frames * frameSize / writeS / 1e6 : 0.0);
+  printf("bound        %u dropped, %u kept (capacity %llu bytes)\n",
+         dropped, frames - dropped, (unsigned long long)capacity);
+  printf("reboot       %u frames recovered\n", recovered);
+  printf("drain        %.0f frames/s, %u drained, %u resent after reboot, %u out of order or bad\n",
+         readS > 0 ? drained / readS : 0.0, drained, resent, bad);
+  printf("torn write   %u of 3 frames kept, %u corrupt record(s) skipped\n", afterTear, tornCorrupt);
+  return recovered == frames - dropped && bad == 0 && afterTear == 3 ? 0 : 1;
+}
+
+static uint64_t allocSinkBytes = 0;
+
+static void allocSink(const char*, size_t size) {
+  allocSinkBytes += size;
+}
+
+/**
+ * Count heap allocations made by the steady-state loop; 0 is a pass
+ */
+static int checkAllocations(float seconds) {
+  SynthParams synth;
+  synth.seconds = seconds;
+  synth.hrv = 0.05f;
+  ReplayTrace trace;
+  synthesizeTrace(synth, trace);
+
+  heartRateReset();
+  acqRing.head = acqRing.tail = acqRing.overruns = 0;
+  acqTick = acqReads = 0;
+  halClockUs = 0;
+  acquisitionBegin(A0, sampleIntervalMs);
+
+  static uint8_t waveFrame[waveFrameHeaderSize + 2 * WAVE_HISTORY_SIZE];
+  static TelemetryBatch batch;
+  static FixedText<1024> data;
+  static FixedText<16> bpm;
+  static FixedText<3 * 200 + 192> request;
+  static FixedText<512> metrics;
+  static FixedText<2048> history;
+  metrics.sink = allocSink;
+  const uint32_t warmupTicks = 5000 / sampleIntervalMs;
+  uint32_t waveCursor = 0, telemetryCursor = 0, drainedTick = 0;
+  BeatCursor beats = beatCursorAt(beatEvents);
+  uint32_t overflows = 0;
+  uint64_t allocsBefore = 0, bytesBefore = 0;
+  bool counting = false;
+  telemetryBegin(batch, 0, 0, 0);
+
+  for (size_t i = 0; i < trace.samples.size(); i++) {
+    halAdcValue = trace.samples[i];
+    halClockUs += acqReadIntervalUs;
+    halTimerFire();
+    if (acqTick == drainedTick) continue;
+    drainedTick = acqTick;
+    readHeartRate(acqRing);
+
+    if (!counting && acqTick >= warmupTicks) {
+      counting = true;
+      allocsBefore = allocCount;
+      bytesBefore = allocBytes;
+    }
+    uint32_t nowMs = lastSampleTick * sampleIntervalMs;
+    while (const BeatEvent* e = beatEventNext(beatEvents, beats)) {
+      telemetryAddBeat(batch, nowMs, e->ibiUs, true);
+    }
+    if (acqTick % replayWavePollSamples == 0) {
+      waveCursor += waveEncode(waveHistory, waveCursor, sampleIntervalMs, waveFrame, sizeof(waveFrame)) > 0;
+    }
+    if (acqTick % (1000 / sampleIntervalMs) == 0) {
+      telemetryAddSecond(batch, nowMs, beatsPerMinute, signalValue, pulseDetected);
+
+      textClear(data);
+      textPrintf(data, "{\"timestamp\":%u,\"epochMs\":", nowMs);
+      textAppendU64(data, 1760000000000ULL + nowMs);
+      textAppend(data, ",\"utc\":\"");
+      textAppendIso8601(data, 1760000000000000ULL + nowMs * 1000ULL);
+      textAppend(data, "\",");
+      detectorJson(data);
+      textAppend(data, "\"budget\":{}}");
+      textClear(bpm);
+      textPrintf(bpm, "%d", beatsPerMinute);
+      textClear(request);
+      textAppend(request, "GET /bot<token>/sendMessage?chat_id=<chat>&text=");
+      textAppendUrlEncoded(request, "⚠️ bpm-high: 131 BPM (limit 120)\n✅ no-beat cleared (72 BPM)");
+      textPrintf(request, " HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n", "api.telegram.org");
+      metricsFamily(metrics, "hr_samples_total", "counter", "Detector input samples produced");
+      textPrintf(metrics, "hr_samples_total %u\n", (unsigned)acqTick);
+      metricsProbes(metrics);
+      textFlush(metrics);
+      textClear(history);
+      historyJson(history, bpmHistory, (HistoryRes)(acqTick % 3), 0, 0x7FFFFFFF, 1760000000);
+      overflows += data.overflow + bpm.overflow + request.overflow + history.overflow;
+    }
+    if (acqTick % (replayTelemetrySeconds * 1000 / sampleIntervalMs) == 0) {
+      telemetryAddWave(batch, nowMs, waveHistory, &telemetryCursor, sampleIntervalMs);
+      telemetryFinish(batch);
+      telemetryBegin(batch, batch.seq + 1, nowMs, 0);
+    }
+  }
+  timer1_detachInterrupt();
+  uint64_t allocs = allocCount - allocsBefore;
+  uint64_t bytes = allocBytes - bytesBefore;
+
+  printf("alloc check  %.0f s steady state after %u s warm-up, %u beats, %llu metrics bytes\n",
+         seconds - warmupTicks * sampleIntervalMs / 1000.0, (unsigned)(warmupTicks * sampleIntervalMs / 1000),
+         (unsigned)beatCount, (unsigned long long)allocSinkBytes);
+  printf("heap         %llu allocations, %llu bytes\n", (unsigned long long)allocs, (unsigned long long)bytes);
+  printf("buffers      %u overflow(s), /data %zu of %zu bytes\n", overflows, data.length, data.capacity);
+  return allocs == 0 && overflows == 0 ? 0 : 1;
+}
+
+/**
+ * Run the timebase against a simulated drifting crystal and noisy SNTP
+ */
+static int checkTimebase(double ppm) {
+  const uint64_t epochStartUs = 1760000000000000ULL;   // Oct 2025
+  const uint64_t stepUs = 100000;                     // Evaluate every 100 ms
+  const uint64_t dayUs = 86400000000ULL;
+  const uint64_t settleUs = 2 * 3600000000ULL;
+  const uint64_t jumpAtUs = dayUs / 2;
+  const int64_t jumpUs = 2000000;                     // Server-side correction at noon
+  uint32_t rng = 12345;
+
+  timebase = Timebase();
+  halClockUs = 0;
+  timebaseMonoUs();
+  uint64_t nextSyncUs = 5000000;
+  uint64_t lastEstimate = 0;
+  double maxErrorUs = 0, sumSqErrorUs = 0;
+  uint32_t evaluated = 0, backwards = 0;
+
+  for (uint64_t t = 0; t <= dayUs; t += stepUs) {
+    halClockUs = t;
+    double trueUs = epochStartUs + t * (1.0 + ppm * 1e-6) + (t >= jumpAtUs ? jumpUs : 0);
+    if (t >= nextSyncUs) {
+      rng = rng * 1664525 + 1013904223;
+      double jitterUs = ((rng >> 8) / 16777216.0 - 0.5) * 10000.0;
+      timebaseSync(timebase, timebaseMonoUs(), (uint64_t)(trueUs + jitterUs));
+      nextSyncUs = t + TIMEBASE_SYNC_MS * 1000ULL;
+    }
+    if (t % 1000000 == 0) timebaseService();
+    uint64_t estimate = timebaseNowUs();
+    if (!estimate) continue;
+    if (estimate < lastEstimate) backwards++;
+    lastEstimate = estimate;
+    bool settling = t < settleUs || (t >= jumpAtUs && t < jumpAtUs + settleUs);
+    if (settling) continue;
+    double error = (double)estimate - trueUs;
+    if (fabs(error) > maxErrorUs) maxErrorUs = fabs(error);
+    sumSqErrorUs += error * error;
+    evaluated++;
+  }
+
+  double rmsUs = evaluated ? sqrt(sumSqErrorUs / evaluated) : 0;
+  printf("timebase     %.1f ppm crystal, %u syncs every %u s with +/-5 ms jitter, %u step(s)\n",
+         ppm, (unsigned)timebase.syncs, (unsigned)(TIMEBASE_SYNC_MS / 1000), (unsigned)timebase.steps);
+  printf("drift        %.3f ppm estimated\n", timebaseDriftPpb(timebase) / 1000.0);
+  printf("error        %.2f ms rms, %.2f ms max after settling\n", rmsUs / 1000.0, maxErrorUs / 1000.0);
+  printf("monotonic    %u timestamp(s) went backwards\n", backwards);
+  printf("convert      %.1f host cycles per timestamp\n", [] {
+    uint32_t start = ESP.getCycleCount();
+    volatile uint64_t sink = 0;
+    for (uint32_t i = 0; i < 100000; i++) sink = sink + tickEpochUs(i);
+    return (ESP.getCycleCount() - start) / 100000.0;
+  }());
+  return backwards == 0 && timebase.steps == 1 && maxErrorUs < 10000 ? 0 : 1;
+}
+
+/**
+ * Sample across the micros() wrap with frequent acquisition pauses and
+ * check every sample's tick against the time it was taken
+ */
+static int checkPauses(float seconds) {
+  const uint64_t wrapUs = 0x100000000ULL;
+  const uint64_t pauseEveryUs = 700000;
+  const uint32_t outputUs = sampleIntervalUs;
+  const uint32_t centreUs = 3 * (HR_OVERSAMPLE - 1) * (outputUs / HR_OVERSAMPLE) / 2;
+  uint32_t rng = 12345;
+
+  acqRing.head = acqRing.tail = acqRing.overruns = 0;
+  acqTick = acqReads = 0;
+  acqPauses = 0;
+  halClockUs = 0;
+  acquisitionBegin(A0, sampleIntervalMs);
+  uint64_t zeroUs = acqFirstOutputUs();
+  uint64_t endUs = (uint64_t)(seconds * 1e6);
+  uint64_t nextPauseUs = pauseEveryUs;
+  uint64_t pausedUs = 0;
+  uint32_t samples = 0, bad = 0, badAfterWrap = 0;
+  double worstUs = 0;
+
+  while (halClockUs < endUs) {
+    halClockUs += acqReadIntervalUs;
+    uint32_t tick = acqTick;
+    halTimerFire();
+    acqRing.tail = acqRing.head;
+    if (acqTick != tick) {
+      // The sample stands for the centre of the CIC window that produced it
+      double errorUs = (double)(halClockUs - centreUs) - (double)(zeroUs + (uint64_t)tick * outputUs);
+      if (fabs(errorUs) > fabs(worstUs)) worstUs = errorUs;
+      if (fabs(errorUs) > outputUs / 2) {
+        bad++;
+        badAfterWrap += halClockUs >= wrapUs;
+      }
+      samples++;
+    }
+    if (halClockUs >= nextPauseUs) {
+      rng = rng * 1664525 + 1013904223;
+      uint32_t pauseUs = 1000 + (rng >> 8) % 399000;
+      acquisitionPause();
+      halClockUs += pauseUs;
+      acquisitionResume();
+      pausedUs += pauseUs;
+      nextPauseUs = halClockUs + pauseEveryUs;
+    }
+  }
+
+  bool wrapped = halClockUs >= wrapUs;
+  printf("pauses       %u over %.0f s, %.1f s paused, micros() wrap %s\n", (unsigned)acqPauses,
+         halClockUs / 1e6, pausedUs / 1e6, wrapped ? "crossed" : "not reached (needs 4295 s)");
+  printf("ticks        %u samples, %u ticks elapsed, %u of them skipped for pauses\n",
+         samples, (unsigned)acqTick, (unsigned)(acqTick - samples));
+  printf("grid         %.0f us worst offset from the sample's instant, %u beyond half a period"
+         " (%u after the wrap)\n", worstUs, bad, badAfterWrap);
+  return bad == 0 && wrapped ? 0 : 1;
+}
+
+/**
+ * Run replayChannels synthetic sensors, one with no pulse, through one
+ * interleaved HeartRateDetector and check each channel against its own
+ * single-channel run
+ */
+static int checkChannels(float seconds) {
+  const int channels = replayChannels;
+  static HeartRateDetector<1000 / sampleIntervalMs, replayChannels> multi;
+  static PulseDetector single;
+  std::vector<int32_t> interleaved;
+  uint32_t frames = 0;
+  float bpm[channels];
+  for (int ch = 0; ch < channels; ch++) {
+    SynthParams p;
+    p.bpm = bpm[ch] = 50.0f + 25.0f * ch;
+    p.seconds = seconds;
+    p.hrv = 0.03f;
+    p.seed = ch + 1;
+    p.amplitude = ch == channels - 1 ? 0.0f : 200.0f;   // Last channel: sensor off
+    ReplayTrace trace;
+    synthesizeTrace(p, trace);
+    frames = trace.samples.size() / HR_OVERSAMPLE;
+    interleaved.resize((size_t)frames * channels);
+    for (uint32_t f = 0; f < frames; f++) {
+      int32_t sum = 0;
+      for (int k = 0; k < HR_OVERSAMPLE; k++) sum += trace.samples[f * HR_OVERSAMPLE + k];
+      interleaved[(size_t)f * channels + ch] = sum * 8 / HR_OVERSAMPLE;
+    }
+  }
+
+  // Best of a few runs, to keep other host load out of the cycle counts
+  const int runs = 5;
+  double multiCycles = 0;
+  for (int run = 0; run < runs; run++) {
+    detectorReset(multi);
+    uint64_t start = ESP.getCycleCount();
+    detectorProcessInterleaved(multi, 0, interleaved.data(), frames);
+    double cycles = (uint32_t)(ESP.getCycleCount() - start);
+    if (run == 0 || cycles < multiCycles) multiCycles = cycles;
+  }
+
+  int failures = 0;
+  double singleCycles = 0;
+  std::vector<int32_t> column(frames);
+  for (int ch = 0; ch < channels; ch++) {
+    for (uint32_t f = 0; f < frames; f++) column[f] = interleaved[(size_t)f * channels + ch];
+    double best = 0;
+    for (int run = 0; run < runs; run++) {
+      detectorReset(single);
+      uint64_t start = ESP.getCycleCount();
+      detectorProcessInterleaved(single, 0, column.data(), frames);
+      double cycles = (uint32_t)(ESP.getCycleCount() - start);
+      if (run == 0 || cycles < best) best = cycles;
+    }
+    singleCycles += best;
+
+    const DetectorBeats<HR_STATS_WINDOW, HR_MEDIAN_WINDOW>& m = multi.beats[ch];
+    const DetectorBeats<HR_STATS_WINDOW, HR_MEDIAN_WINDOW>& s = single.beats[0];
+    bool same = m.beatCount == s.beatCount && m.lastBeatTimeUs == s.lastBeatTimeUs &&
+                m.stats.sum == s.stats.sum && m.stats.accepted == s.stats.accepted;
+    bool expected = bpm[ch] > 0 && ch < channels - 1
+                        ? abs(detectorBpm(multi, ch) - (int)bpm[ch]) <= 3
+                        : detectorBpm(multi, ch) == 0;
+    if (!same || !expected) failures++;
+    printf("channel %d    %.0f bpm in, %d bpm out, %u beats, sdnn %.1f ms%s\n", ch,
+           ch < channels - 1 ? bpm[ch] : 0.0f, detectorBpm(multi, ch), (unsigned)m.beatCount,
+           beatStatsSdnnMs(m.stats), same ? "" : " (differs from single-channel run)");
+  }
+  printf("state        %zu bytes per-sample, %zu bytes per-beat per channel\n",
+         sizeof(DetectorChannel), sizeof(DetectorBeats<HR_STATS_WINDOW, HR_MEDIAN_WINDOW>));
+  printf("host cycles  %.1f per sample interleaved, %.1f per sample one channel at a time\n",
+         multiCycles / ((double)frames * channels), singleCycles / ((double)frames * channels));
+  return failures == 0 ? 0 : 1;
+}
+
+/**
+ * Reference aggregate of full[from, from + count), as bpm_history.h
+ * defines it
+ */
+static HistoryBucket historyReference(const std::vector<uint8_t>& full, size_t from, size_t count) {
+  HistoryAccum a = HistoryAccum();
+  for (size_t i = from; i < from + count && i < full.size(); i++) historyAccumAdd(a, full[i]);
+  return historyAccumBucket(a);
+}
+
+/**
+ * Check the history tiers against recomputation from the whole record
+ */
+static int checkHistory(uint32_t seconds) {
+  static BpmHistory h;
+  historyReset(h);
+  std::vector<uint8_t> full(seconds, 0);
+  srand(7);
+  int bpm = 70;
+  uint64_t totalNs = 0;
+  uint32_t adds = 0;
+  for (uint32_t t = 0; t < seconds; t++) {
+    bpm = max(40, min(180, bpm + (rand() % 3) - 1));
+    if (rand() % 500 == 0) t += rand() % 120;       // Detector stalled: seconds skipped
+    if (t >= seconds) break;
+    bool dropout = (t / 600) % 7 == 3;               // Sensor off for 10 minutes in 70
+    int reading = dropout ? 0 : bpm;
+    full[t] = (uint8_t)reading;
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < 3; k++) historyAdd(h, t, reading);  // Several calls per second, like readHeartRate()
+    totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    adds += 3;
+  }
+  historyAdd(h, seconds, 0);                         // Close the last second
+
+  uint32_t mismatches = 0;
+  for (uint32_t t = seconds > HISTORY_SECONDS ? seconds - HISTORY_SECONDS : 0; t < seconds; t++) {
+    mismatches += h.second[t % HISTORY_SECONDS] != full[t];
+  }
+  const HistoryRes tiers[2] = {HISTORY_MINUTE, HISTORY_HOUR};
+  for (HistoryRes res : tiers) {
+    uint32_t step = historyStep(res);
+    uint32_t newest = h.now / step;
+    uint32_t oldest = newest >= historySlots(res) ? newest - historySlots(res) + 1 : 0;
+    for (uint32_t i = oldest; i <= newest; i++) {
+      HistoryBucket got = historyBucket(h, res, i);
+      HistoryBucket want = historyReference(full, (size_t)i * step, min<size_t>(step, h.now - i * step));
+      mismatches += memcmp(&got, &want, sizeof(got)) != 0;
+    }
+  }
+
+  // Page through each resolution with `next` as a client would
+  uint32_t pages = 0, entries = 0, pagingErrors = 0;
+  static FixedText<2048> page;
+  for (int r = HISTORY_SECOND; r <= HISTORY_HOUR; r++) {
+    HistoryRes res = (HistoryRes)r;
+    int64_t from = 0;
+    int64_t expectFrom = -1;
+    for (;;) {
+      textClear(page);
+      historyJson(page, h, res, from, seconds, 0);
+      pages++;
+      const char* at = strstr(page.data, "\"from\":");
+      long long pageFrom = at ? atoll(at + 7) : -1;
+      if (page.overflow || (expectFrom >= 0 && pageFrom != expectFrom)) pagingErrors++;
+      const char* end = strrchr(page.data, ']');
+      for (const char* p = strchr(page.data, '[') + 1; p < end; p++) {
+        if (res == HISTORY_SECOND ? (p[-1] == '[' || *p == ',') : *p == '[') entries++;
+      }
+      const char* next = strstr(page.data, "\"next\":");
+      if (!next) break;
+      from = expectFrom = atoll(next + 7);
+    }
+  }
+  uint32_t expected = min(seconds, (uint32_t)HISTORY_SECONDS) +
+                      min(h.now / 60 + 1, (uint32_t)HISTORY_MINUTES) +
+                      min(h.now / 3600 + 1, (uint32_t)HISTORY_HOURS);
+  if (entries != expected) pagingErrors++;
+
+  printf("history      %u s of readings, %u seconds + %u minutes + %u hours kept in %zu bytes\n",
+         seconds, HISTORY_SECONDS, HISTORY_MINUTES, HISTORY_HOURS, sizeof(BpmHistory));
+  printf("insert       %.1f ns mean over %u calls (host)\n", (double)totalNs / adds, adds);
+  printf("tiers        %u mismatch(es) against recomputation\n", mismatches);
+  printf("paging       %u pages, %u of %u entries, %u error(s)\n", pages, entries, expected, pagingErrors);
+  return mismatches == 0 && pagingErrors == 0 ? 0 : 1;
+}
+
+/**
+ * One stretch of the --publish-check day
+ */
+struct PublishSegment {
+  const char* name;
+  float bpm;
+  float amplitude;
+  float noise;
+  float motion;
+};
+
+/**
+ * Count what MQTT would send for a mixed recording with every reading
+ * published versus by exception, and check that the gated stream still
+ * tracks every adequate reading within the deadband and never goes quiet
+ * for longer than the keepalive
+ */
+static int checkPublishing(float seconds) {
+  const PublishSegment segments[] = {
+      {"rest", 62.0f, 200.0f, 5.0f, 0.0f},
+      {"desk", 74.0f, 200.0f, 20.0f, 0.0f},
+      {"walk", 96.0f, 200.0f, 10.0f, 150.0f},
+      {"off finger", 72.0f, 0.0f, 3.0f, 0.0f},
+      {"weak", 68.0f, 20.0f, 10.0f, 0.0f},
+  };
+  const int segmentCount = sizeof(segments) / sizeof(segments[0]);
+  const float segmentSeconds = 300.0f;
+
+  ReplayTrace trace;
+  for (int k = 0; k * segmentSeconds < seconds; k++) {
+    const PublishSegment& seg = segments[k % segmentCount];
+    SynthParams p;
+    p.bpm = seg.bpm;
+    p.seconds = min(segmentSeconds, seconds - k * segmentSeconds);
+    p.amplitude = seg.amplitude;
+    p.noise = seg.noise;
+    p.motion = seg.motion;
+    p.hrv = 0.05f;
+    p.seed = k + 1;
+    ReplayTrace part;
+    synthesizeTrace(p, part);
+    trace.samples.insert(trace.samples.end(), part.samples.begin(), part.samples.end());
+  }
+  ReplayResult result = replayTrace(trace);
+
+  // Frames as mqttBatchTelemetry() builds them, without the waveform; the
+  // beat IBIs don't change the size, so they are left at 0
+  static TelemetryBatch every, gated;
+  uint64_t everyBytes = 0, gatedBytes = 0;
+  uint32_t everyFrames = 0, gatedFrames = 0;
+  ReportGate gate = ReportGate();
+  size_t beat = 0;
+  uint32_t adequateSeconds = 0, lastReportMs = 0, longestGapMs = 0;
+  int worstError = 0;
+  uint64_t qualitySum = 0;
+  for (size_t i = 0; i < result.secondsMs.size(); i++) {
+    uint32_t nowMs = result.secondsMs[i];
+    if (i % replayTelemetrySeconds == 0) {
+      if (i > 0) {
+        everyBytes += telemetryFinish(every);
+        everyFrames++;
+        if (gated.records > 0) {
+          gatedBytes += telemetryFinish(gated);
+          gatedFrames++;
+        }
+      }
+      telemetryBegin(every, everyFrames, nowMs, 0);
+      telemetryBegin(gated, gatedFrames, nowMs, 0);
+    }
+    for (; beat < result.beatsUs.size() && result.beatsUs[beat] / 1000 <= nowMs; beat++) {
+      uint32_t beatMs = result.beatsUs[beat] / 1000;
+      telemetryAddBeat(every, beatMs, 0, true);
+      if (result.beatsAdequate[beat]) telemetryAddBeat(gated, beatMs, 0, true);
+    }
+
+    int bpm = result.secondsBpm[i];
+    int quality = result.secondsQuality[i];
+    bool adequate = bpm > 0 && quality >= SQI_MIN;
+    qualitySum += quality;
+    telemetryAddSecond(every, nowMs, bpm, 512, 0);
+    if (reportGateCheck(gate, nowMs, bpm, quality) != REPORT_NONE) {
+      telemetryAddSecond(gated, nowMs, adequate ? bpm : 0, 512, 0);
+      longestGapMs = max(longestGapMs, nowMs - lastReportMs);
+      lastReportMs = nowMs;
+    }
+    if (adequate) {
+      adequateSeconds++;
+      worstError = max(worstError, abs(bpm - gate.bpm));
+    }
+  }
+
+  double perHour = 3600.0 / max(1.0f, seconds);
+  uint32_t count = result.secondsMs.size();
+  printf("recording    %.0f s in %.0f s stretches:", seconds, segmentSeconds);
+  for (int k = 0; k < segmentCount; k++) printf("%s %s", k ? "," : "", segments[k].name);
+  printf("\n");
+  printf("quality      mean index %.1f, adequate %.1f%% of seconds (SQI_MIN %d)\n",
+         count ? (double)qualitySum / count : 0.0, count ? 100.0 * adequateSeconds / count : 0.0, SQI_MIN);
+  printf("json         %.0f messages/h every second, %.0f by exception (%.1f%% fewer)\n",
+         count * perHour, gate.reports * perHour, count ? 100.0 - 100.0 * gate.reports / count : 0.0);
+  printf("frames       %.0f bytes/h in %.0f frames every second, %.0f bytes/h in %.0f frames by exception "
+         "(%.1f%% fewer bytes)\n",
+         everyBytes * perHour, everyFrames * perHour, gatedBytes * perHour, gatedFrames * perHour,
+         everyBytes ? 100.0 - 100.0 * gatedBytes / everyBytes : 0.0);
+  printf("fidelity     published BPM within %d of every adequate reading (deadband %d), "
+         "longest silence %u s (keepalive %d s)\n",
+         worstError, REPORT_DEADBAND_BPM, (unsigned)(longestGapMs / 1000), REPORT_KEEPALIVE_S);
+  bool ok = worstError <= REPORT_DEADBAND_BPM && longestGapMs <= REPORT_KEEPALIVE_S * 1000UL + 1000;
+  return ok ? 0 : 1;
+}
+
+/**
+ * Score the detector over the benchmark corpus
+ * @param outPath JSON results file, or "-" for stdout (table on stderr)
+ */
+static int runBenchmark(const char* outPath, const char* corpusDir, float seconds,
+                        uint32_t traceIntervalUs) {
+  std::vector<BenchCase> cases;
+  benchSyntheticCases(seconds, cases);
+  if (corpusDir && benchLoadCorpus(corpusDir, traceIntervalUs, cases) < 0) {
+    fprintf(stderr, "Cannot read corpus directory %s\n", corpusDir);
+    return 1;
+  }
+  bool toStdout = !strcmp(outPath, "-");
+  FILE* table = toStdout ? stderr : stdout;
+  fprintf(table, "%-12s %6s %6s %6s %7s %6s %7s %6s %7s %7s %10s %7s %7s\n", "case", "beats",
+          "sens", "ppv", "bpm err", "cover", "sdft er", "cover", "ibi rms", "ibi max", "samples/s",
+          "cyc/smp", "sdft cs");
+  std::vector<BenchResult> results;
+  for (const BenchCase& c : cases) {
+    BenchResult r = benchRun(c);
+    fprintf(table, "%-12s %6u %6.3f %6.3f %7.2f %6.2f %7.2f %6.2f %7.2f %7.2f %10.0f %7.1f %7.1f\n",
+            r.name.c_str(), r.truthBeats, r.sensitivity, r.ppv, r.bpmMae, r.coverage,
+            r.spectralMae, r.spectralCoverage, r.ibi.rmsUs / 1000.0, r.ibi.maxAbsUs / 1000.0,
+            r.samplesPerSecond, r.cyclesPerSample, r.spectralCyclesPerSample);
+    results.push_back(r);
+  }
+  FILE* out = toStdout ? stdout : fopen(outPath, "w");
+  if (!out) {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  benchWriteJson(out, results);
+  if (!toStdout) fclose(out);
+  return 0;
+}
+
+/**
+ * Print every record of a binary telemetry frame
+ */
+static int decodeTelemetryFile(const char* path) {
+  static uint8_t frame[65536];
+  static TelemetryRecord records[sizeof(frame) / 3];
+  static uint16_t samples[65536];
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot read telemetry frame %s\n", path);
+    return 1;
+  }
+  size_t size = fread(frame, 1, sizeof(frame), f);
+  fclose(f);
+
+  uint32_t seq = 0, baseMs = 0;
+  int count = telemetryDecode(frame, size, &seq, &baseMs, records, sizeof(records) / sizeof(records[0]));
+  if (count < 0) {
+    fprintf(stderr, "Malformed telemetry frame (%zu bytes)\n", size);
+    return 1;
+  }
+  printf("frame        seq %u, base %u ms, %d records, %zu bytes\n", seq, baseMs, count, size);
+  if (count > 0 && records[0].epochMs) {
+    printf("utc          base %llu ms since 1970\n",
+           (unsigned long long)(records[0].epochMs - (records[0].timeMs - baseMs)));
+  }
+  for (int i = 0; i < count; i++) {
+    const TelemetryRecord& r = records[i];
+    if (r.type == telemetrySecond) {
+      printf("%10u ms  second  bpm %u, signal %u%s%s\n", r.timeMs, r.bpm, r.signal,
+             r.flags & telemetrySecondDetected ? ", pulse" : "",
+             r.flags & telemetrySecondAdequate ? ", adequate" : "");
+    } else if (r.type == telemetryBeat) {
+      printf("%10u ms  beat    ibi %.1f ms%s\n", r.timeMs, r.ibiUs / 1000.0,
+             r.flags & telemetryBeatAccepted ? "" : " (rejected)");
+    } else if (r.type == telemetryWave) {
+      uint32_t firstSeq = 0;
+      int n = waveDecode(r.wave, r.waveLength, &firstSeq, samples, sizeof(samples) / sizeof(samples[0]));
+      printf("%10u ms  wave    %d samples from seq %u, %u bytes\n", r.timeMs, n, firstSeq, r.waveLength);
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  ReplayTrace trace;
+  SynthParams synth;
+  const char* csvPath = nullptr;
+  const char* binPath = nullptr;
+  bool useSynth = false;
+  bool printBeats = false;
+  uint32_t drainEvery = 1;
+  uint32_t traceIntervalUs = sampleIntervalUs;
+  const char* benchPath = nullptr;
+  const char* corpusDir = nullptr;
+  float benchSeconds = 300.0f;
+  int httpClients = -1;
+  float loadSeconds = 10.0f;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(arg, "--beats")) {
+      printBeats = true;
+      continue;
+    }
+    if (!next) {
+      usage();
+      return 2;
+    }
+    if (!strcmp(arg, "--synth")) { useSynth = true; synth.bpm = atof(next); }
+    else if (!strcmp(arg, "--csv")) csvPath = next;
+    else if (!strcmp(arg, "--bin")) binPath = next;
+    else if (!strcmp(arg, "--decode")) return decodeTelemetryFile(next);
+    else if (!strcmp(arg, "--tlog-bench")) return benchTelemetryLog((uint32_t)atoi(next));
+    else if (!strcmp(arg, "--alloc-check")) return checkAllocations(atof(next));
+    else if (!strcmp(arg, "--timebase-check")) return checkTimebase(atof(next));
+    else if (!strcmp(arg, "--pause-check")) return checkPauses(atof(next));
+    else if (!strcmp(arg, "--channel-check")) return checkChannels(atof(next));
+    else if (!strcmp(arg, "--publish-check")) return checkPublishing(atof(next));
+    else if (!strcmp(arg, "--history-check")) return checkHistory((uint32_t)atoi(next));
+    else if (!strcmp(arg, "--bench")) benchPath = next;
+    else if (!strcmp(arg, "--corpus")) corpusDir = next;
+    else if (!strcmp(arg, "--http-load")) httpClients = atoi(next);
+    else if (!strcmp(arg, "--seconds")) synth.seconds = benchSeconds = loadSeconds = atof(next);
+    else if (!strcmp(arg, "--noise")) synth.noise = atof(next);
+    else if (!strcmp(arg, "--drift")) synth.drift = atof(next);
+    else if (!strcmp(arg, "--hrv")) synth.hrv = atof(next);
+    else if (!strcmp(arg, "--drain")) drainEvery = (uint32_t)atoi(next);
+    else if (!strcmp(arg, "--trace-us")) traceIntervalUs = (uint32_t)atoi(next);
+    else {
+      usage();
+      return 2;
+    }
+    i++;
+  }
+
+  if (benchPath) return runBenchmark(benchPath, corpusDir, benchSeconds, traceIntervalUs);
+  if (httpClients >= 0) return httpLoadTest(httpClients, loadSeconds);
+
+  if (csvPath) {
+    if (!loadCsvTrace(csvPath, traceIntervalUs, trace)) {
+      fprintf(stderr, "Cannot read CSV trace %s\n", csvPath);
+      return 1;
+    }
+  } else if (binPath) {
+    if (!loadBinaryTrace(binPath, traceIntervalUs, trace)) {
+      fprintf(stderr, "Cannot read binary trace %s\n", binPath);
+      return 1;
+    }
+  } else if (useSynth) {
+    synthesizeTrace(synth, trace);
+  } else {
+    usage();
+    return 2;
+  }
+
+  ReplayResult result = replayTrace(trace, drainEvery);
+
+  double traceSeconds = (double)result.samples * replayReadIntervalUs() / 1e6;
+  printf("samples      %u ADC reads (%.1f s, %u us apart, %dx oversampled)\n",
+         result.samples, traceSeconds, replayReadIntervalUs(), HR_OVERSAMPLE);
+  printf("beats        %u detected", result.beatCount);
+  if (!trace.truthBeatsUs.empty()) printf(", %zu in trace", trace.truthBeatsUs.size());
+  if (result.beatsMissed) printf(", %u beat events overwritten unread", result.beatsMissed);
+  printf("\n");
+  printf("bpm          %d\n", result.finalBpm);
+  printf("overruns     %u\n", result.overruns);
+  printf("hrv          sdnn %.1f ms, rmssd %.1f ms, pnn50 %.1f%% (%u accepted, %u rejected)\n",
+         beatStatsSdnnMs(beatStats), beatStatsRmssdMs(beatStats), beatStatsPnn50(beatStats),
+         beatStats.accepted, beatStats.rejected);
+  uint32_t adequateSeconds = 0;
+  for (size_t i = 0; i < result.secondsQuality.size(); i++) {
+    adequateSeconds += result.secondsBpm[i] > 0 && result.secondsQuality[i] >= SQI_MIN;
+  }
+  printf("quality      index %d, adequate %u of %zu seconds\n", signalQualityIndex,
+         (unsigned)adequateSeconds, result.secondsQuality.size());
+  printf("resolution   %u us sample period, %s\n", sampleIntervalUs,
+         HR_PEAK_INTERPOLATION ? "parabolic peak interpolation" : "no interpolation");
+  if (!trace.truthBeatsUs.empty()) {
+    IbiError err = measureIbiError(result.beatsUs, trace.truthBeatsUs);
+    printf("ibi error    %.2f ms mean abs, %.2f ms rms, %.2f ms max (%u intervals)\n",
+           err.meanAbsUs / 1000.0, err.rmsUs / 1000.0, err.maxAbsUs / 1000.0, err.pairs);
+  }
+  printf("wave         %u frames, %.2f bytes/sample, %.1f host cycles/sample encode, %u bad\n",
+         result.waveFrames,
+         result.waveSamples ? (double)result.waveBytes / result.waveSamples : 0.0,
+         result.waveSamples ? (double)result.waveCycles / result.waveSamples : 0.0,
+         result.waveErrors);
+  printf("telemetry    %u frames, %.1f bytes/frame, %.1f bytes/s, %u bad\n",
+         result.telemetryFrames,
+         result.telemetryFrames ? (double)result.telemetryBytes / result.telemetryFrames : 0.0,
+         traceSeconds > 0 ? result.telemetryBytes / traceSeconds : 0.0,
+         result.telemetryErrors);
+  printf("wall time    %.3f ms (%.0fx real time)\n", result.wallSeconds * 1000.0,
+         result.wallSeconds > 0 ? traceSeconds / result.wallSeconds : 0.0);
+  printf("host cycles  %.1f per ADC read (ISR), %.1f per output sample (detector)\n",
+         result.samples ? (double)result.isrCycles / result.samples : 0.0,
+         result.samples ? (double)result.cycles * HR_OVERSAMPLE / result.samples : 0.0);
+  printf("cpu budget   %.0f host cycles per second of signal\n",
+         traceSeconds > 0 ? (double)(result.isrCycles + result.cycles) / traceSeconds : 0.0);
+
+  if (printBeats) {
+    for (size_t i = 0; i < result.beatsUs.size(); i++) {
+      printf("beat %zu %.3f ms\n", i, result.beatsUs[i] / 1000.0);
+    }
+  }
+  return 0;
+}
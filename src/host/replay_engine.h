@@ -0,0 +1,437 @@
+#ifndef REPLAY_ENGINE_H
+#define REPLAY_ENGINE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "acquisition.h"
+#include "heart_rate.h"
+
+#ifndef TELEMETRY_FRAME_SIZE
+#define TELEMETRY_FRAME_SIZE 1536  // A 10 s MQTT frame with the waveform included
+#endif
+#include "telemetry_frame.h"
+
+/*
+ * PPG replay engine (native build only)
+ * =====================================
+ * Feeds a recorded or synthetic pulse trace through the real acquisition
+ * path: every trace sample is presented on the shimmed ADC, the timer1 ISR
+ * from acquisition.h decimates it into acqRing, and readHeartRate() drains
+ * the ring exactly as loop() does on the device. Virtual time means a trace
+ * runs as fast as the host can process it.
+ *
+ * Traces are held at the ADC read rate (sampleIntervalMs / HR_OVERSAMPLE);
+ * loaders resample whatever rate the recording was made at.
+ */
+
+struct ReplayTrace {
+  std::vector<uint16_t> samples;       // ADC values at replayReadIntervalUs() spacing
+  std::vector<uint32_t> truthBeatsUs;  // Known systolic peak times (synthetic traces only)
+};
+
+struct SynthParams {
+  float bpm = 72.0f;          // Mean heart rate
+  float seconds = 60.0f;      // Trace length
+  float amplitude = 200.0f;   // Pulse height in ADC counts
+  float noise = 5.0f;         // Uniform noise, +/- ADC counts
+  float drift = 0.0f;         // Baseline wander amplitude in ADC counts
+  float hrv = 0.0f;           // Beat-to-beat interval jitter (fraction of IBI)
+  float ectopic = 0.0f;       // Fraction of beats that come early (0.65 IBI, smaller) then pause
+  float motion = 0.0f;        // Motion artefact amplitude in ADC counts
+  float motionPerMin = 4.0f;  // Mean artefact rate; each lasts 1-3 s at 0.8-2.5 Hz
+  uint32_t seed = 1;
+};
+
+struct ReplayResult {
+  uint32_t samples = 0;            // ADC reads replayed
+  uint32_t overruns = 0;
+  uint32_t beatCount = 0;          // Beats accepted by the detector
+  int finalBpm = 0;
+  std::vector<uint32_t> beatsUs;   // Detector beat times, from the beat event queue
+  std::vector<uint32_t> secondsMs; // Detector time of each once-a-second BPM reading
+  std::vector<int> secondsBpm;     // That reading (0 while no pulse is detected)
+  std::vector<int> secondsSpectralBpm;  // Spectral estimate at the same time (0 if not confident)
+  std::vector<int> secondsQuality;     // Quality index at the same time (signal_quality.h)
+  std::vector<bool> beatsAdequate; // Quality was adequate when each beat was found
+  uint32_t beatsMissed = 0;        // Events overwritten before the replay read them
+  double wallSeconds = 0;          // Host time spent replaying
+  uint64_t isrCycles = 0;          // Host cycles in the timer ISR
+  uint64_t cycles = 0;             // Host cycles spent in readHeartRate()
+  uint32_t waveFrames = 0;         // /wave frames encoded by the emulated poller
+  uint64_t waveSamples = 0;
+  uint64_t waveBytes = 0;
+  uint64_t waveCycles = 0;         // Host cycles in waveEncode()
+  uint32_t waveErrors = 0;         // Frames that didn't decode to the stored samples
+  uint32_t telemetryFrames = 0;    // MQTT frames built by the emulated publisher
+  uint32_t telemetryRecords = 0;
+  uint64_t telemetryBytes = 0;
+  uint32_t telemetryErrors = 0;    // Frames that didn't decode to what was added
+};
+
+const uint32_t replayWavePollSamples = 25;  // Emulated /wave client polls every 0.5 s
+const uint32_t replayTelemetrySeconds = 10; // Emulated MQTT batch interval (waveform included)
+
+/**
+ * ADC read period the trace must be supplied at
+ */
+uint32_t replayReadIntervalUs() {
+  return sampleIntervalUs / HR_OVERSAMPLE;
+}
+
+// ========================= TRACE LOADING =========================
+
+/**
+ * Linearly resample (time_us, value) points onto the ADC read grid
+ */
+void resampleTrace(const std::vector<double>& timesUs, const std::vector<double>& values,
+                   ReplayTrace& trace) {
+  trace.samples.clear();
+  trace.truthBeatsUs.clear();
+  if (values.empty()) return;
+  size_t src = 0;
+  for (double t = timesUs.front(); t <= timesUs.back(); t += replayReadIntervalUs()) {
+    while (src + 1 < timesUs.size() && timesUs[src + 1] <= t) src++;
+    double v = values[src];
+    if (src + 1 < timesUs.size()) {
+      double span = timesUs[src + 1] - timesUs[src];
+      if (span > 0) v += (values[src + 1] - values[src]) * (t - timesUs[src]) / span;
+    }
+    trace.samples.push_back((uint16_t)max(0.0, min(1023.0, v)));
+  }
+}
+
+/**
+ * Load a CSV trace. Accepts "time_ms,value" pairs, or one value per line
+ * recorded every traceIntervalUs. An annotated recording adds a third
+ * column, non-zero on the samples where a reference beat (e.g. the ECG R
+ * peak or a marked systolic peak) falls; those become truthBeatsUs.
+ * Blank lines and lines starting with '#' are skipped.
+ */
+bool loadCsvTrace(const char* path, uint32_t traceIntervalUs, ReplayTrace& trace) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  std::vector<double> times;
+  std::vector<double> values;
+  std::vector<double> beats;
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+    double a, b;
+    int beat = 0;
+    int fields = sscanf(line, "%lf , %lf , %d", &a, &b, &beat);
+    if (fields >= 2) {
+      times.push_back(a * 1000.0);
+      values.push_back(b);
+      if (beat) beats.push_back(times.back());
+    } else if (fields == 1) {
+      times.push_back((double)values.size() * traceIntervalUs);
+      values.push_back(a);
+    }
+  }
+  fclose(f);
+  resampleTrace(times, values, trace);
+  for (double t : beats) trace.truthBeatsUs.push_back((uint32_t)(t - times.front()));
+  return !trace.samples.empty();
+}
+
+/**
+ * Load a binary trace of little-endian uint16 ADC values recorded every
+ * traceIntervalUs
+ */
+bool loadBinaryTrace(const char* path, uint32_t traceIntervalUs, ReplayTrace& trace) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  std::vector<double> times;
+  std::vector<double> values;
+  uint8_t raw[2];
+  while (fread(raw, 1, 2, f) == 2) {
+    times.push_back((double)values.size() * traceIntervalUs);
+    values.push_back(raw[0] | (raw[1] << 8));
+  }
+  fclose(f);
+  resampleTrace(times, values, trace);
+  return !trace.samples.empty();
+}
+
+/**
+ * Generate a PPG-like trace at the ADC read rate: a systolic peak plus a
+ * smaller dicrotic wave per beat, with optional noise, baseline wander,
+ * interval jitter, ectopic beats and motion artefacts. Systolic peak times
+ * are recorded in truthBeatsUs.
+ */
+void synthesizeTrace(const SynthParams& p, ReplayTrace& trace) {
+  trace.samples.clear();
+  trace.truthBeatsUs.clear();
+  srand(p.seed);
+  auto uniform = []() { return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f; };
+  auto unit = []() { return (float)rand() / (float)RAND_MAX; };
+
+  double stepUs = replayReadIntervalUs();
+  double meanIbi = 60e6 / p.bpm;
+  double beatStart = 0;
+  double ibi = meanIbi;
+  double beatAmplitude = p.amplitude;
+  bool compensate = false;             // Pause after an ectopic beat
+  double artefactStart = 0, artefactLength = 0, artefactHz = 0, artefactPhase = 0;
+  double nextArtefact = p.motion > 0 ? -log(1.0 - unit()) * 60e6 / p.motionPerMin : 0;
+  trace.truthBeatsUs.push_back((uint32_t)(beatStart + 0.15 * ibi));
+  uint32_t count = (uint32_t)(p.seconds * 1e6 / stepUs);
+  for (uint32_t i = 0; i < count; i++) {
+    double t = i * stepUs;
+    while (t >= beatStart + ibi) {
+      beatStart += ibi;
+      ibi = meanIbi * (1.0 + p.hrv * uniform());
+      beatAmplitude = p.amplitude;
+      if (compensate) {
+        ibi += meanIbi * 0.35;
+        compensate = false;
+      } else if (p.ectopic > 0 && unit() < p.ectopic) {
+        ibi -= meanIbi * 0.35;
+        beatAmplitude *= 0.6;
+        compensate = true;
+      }
+      trace.truthBeatsUs.push_back((uint32_t)(beatStart + 0.15 * ibi));
+    }
+    double phase = (t - beatStart) / ibi;
+    double systolic = exp(-pow((phase - 0.15) / 0.06, 2));
+    double dicrotic = 0.4 * exp(-pow((phase - 0.45) / 0.08, 2));
+    double wander = p.drift * sin(2.0 * M_PI * t / 7e6);
+    double v = 400.0 + beatAmplitude * (systolic + dicrotic) + wander + p.noise * uniform();
+    if (p.motion > 0) {
+      if (t >= nextArtefact) {
+        artefactStart = t;
+        artefactLength = 1e6 + 2e6 * unit();
+        artefactHz = 0.8 + 1.7 * unit();
+        artefactPhase = 2.0 * M_PI * unit();
+        nextArtefact = t + artefactLength - log(1.0 - unit()) * 60e6 / p.motionPerMin;
+      }
+      double into = t - artefactStart;
+      if (into < artefactLength) {
+        double window = sin(M_PI * into / artefactLength);
+        v += p.motion * window * sin(2.0 * M_PI * artefactHz * into / 1e6 + artefactPhase);
+      }
+    }
+    trace.samples.push_back((uint16_t)max(0.0, min(1023.0, v)));
+  }
+  while (!trace.truthBeatsUs.empty() && trace.truthBeatsUs.back() >= count * stepUs) {
+    trace.truthBeatsUs.pop_back();
+  }
+}
+
+// ========================= REPLAY =========================
+
+/**
+ * Decode a finished telemetry frame and compare it with the records that
+ * were added, including the samples of any embedded waveform
+ */
+bool replayCheckTelemetry(const uint8_t* frame, size_t size, uint32_t expectSeq,
+                          const std::vector<TelemetryRecord>& expected) {
+  static TelemetryRecord decoded[TELEMETRY_FRAME_SIZE / 6];
+  static uint16_t samples[WAVE_HISTORY_SIZE];
+  uint32_t seq = 0, baseMs = 0;
+  int count = telemetryDecode(frame, size, &seq, &baseMs, decoded, TELEMETRY_FRAME_SIZE / 6);
+  if (count != (int)expected.size() || seq != expectSeq) return false;
+  for (int i = 0; i < count; i++) {
+    const TelemetryRecord& got = decoded[i];
+    const TelemetryRecord& want = expected[i];
+    uint32_t wantMs = (int32_t)(want.timeMs - baseMs) < 0 ? baseMs : want.timeMs;
+    if (got.type != want.type || got.timeMs != wantMs) return false;
+    if (got.type == telemetrySecond &&
+        (got.bpm != want.bpm || got.signal != want.signal || got.flags != want.flags)) return false;
+    if (got.type == telemetryBeat &&
+        (got.ibiUs / 100 != (want.ibiUs + 50) / 100 || got.flags != want.flags)) return false;
+    if (got.type == telemetryWave) {
+      uint32_t firstSeq = 0;
+      int n = waveDecode(got.wave, got.waveLength, &firstSeq, samples, WAVE_HISTORY_SIZE);
+      if (n < 0) return false;
+      for (int k = 0; k < n; k++) {
+        if (samples[k] != waveHistory.samples[(firstSeq + k) & (WAVE_HISTORY_SIZE - 1)]) return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Run a trace through timer ISR -> acqRing -> readHeartRate()
+ * @param drainEvery Output samples between drains; 1 reproduces an idle
+ *                   loop(), larger values emulate a loop() held up by
+ *                   web/MQTT work
+ */
+ReplayResult replayTrace(const ReplayTrace& trace, uint32_t drainEvery = 1) {
+  ReplayResult result;
+  heartRateReset();
+  acqRing.head = acqRing.tail = acqRing.overruns = 0;
+  acqTick = acqReads = 0;
+  acqIsrCyclesMax = acqIsrCyclesTotal = 0;
+  halClockUs = 0;
+  acquisitionBegin(A0, sampleIntervalMs);
+
+  if (drainEvery == 0) drainEvery = 1;
+  BeatCursor beats = beatCursorAt(beatEvents);
+  uint32_t drainedTick = 0;
+  uint32_t waveCursor = 0;
+  static uint8_t frame[waveFrameHeaderSize + 3 * WAVE_HISTORY_SIZE];
+  static uint16_t decoded[WAVE_HISTORY_SIZE];
+  static TelemetryBatch batch;
+  std::vector<TelemetryRecord> batchRecords;
+  uint32_t telemetryCursor = 0;
+  uint32_t secondTick = 0;
+  uint32_t batchTick = 0;
+  batch.length = 0;
+  auto wallStart = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < trace.samples.size(); i++) {
+    halAdcValue = trace.samples[i];
+    halClockUs += acqReadIntervalUs;
+    uint32_t isrStart = ESP.getCycleCount();
+    halTimerFire();
+    result.isrCycles += (uint32_t)(ESP.getCycleCount() - isrStart);
+
+    bool last = i + 1 == trace.samples.size();
+    if (acqTick - drainedTick >= drainEvery || last) {
+      drainedTick = acqTick;
+      uint32_t start = ESP.getCycleCount();
+      result.finalBpm = readHeartRate(acqRing);
+      result.cycles += (uint32_t)(ESP.getCycleCount() - start);
+
+      // Emulated /wave?since= poller: encode, then check the round trip
+      if (waveHistory.nextSeq - waveCursor >= replayWavePollSamples || last) {
+        uint32_t encodeStart = ESP.getCycleCount();
+        size_t size = waveEncode(waveHistory, waveCursor, sampleIntervalMs, frame, sizeof(frame));
+        result.waveCycles += (uint32_t)(ESP.getCycleCount() - encodeStart);
+        uint32_t firstSeq = 0;
+        int count = waveDecode(frame, size, &firstSeq, decoded, WAVE_HISTORY_SIZE);
+        bool ok = count >= 0;
+        for (int k = 0; ok && k < count; k++) {
+          ok = decoded[k] == waveHistory.samples[(firstSeq + k) & (WAVE_HISTORY_SIZE - 1)];
+        }
+        if (!ok) result.waveErrors++;
+        if (count > 0) {
+          waveCursor = firstSeq + count;
+          result.waveSamples += count;
+        }
+        result.waveBytes += size;
+        result.waveFrames++;
+      }
+
+      // Emulated MQTT publisher: the records mqttBatchTelemetry() adds with
+      // MQTT_REPORT_BY_EXCEPTION 0
+      uint32_t nowMs = lastSampleTick * sampleIntervalMs;
+      if (batch.length == 0) telemetryBegin(batch, result.telemetryFrames, nowMs, 0);
+      while (const BeatEvent* e = beatEventNext(beatEvents, beats)) {
+        result.beatsUs.push_back(e->timeUs);
+        result.beatsAdequate.push_back(e->flags & beatEventQuality);
+        TelemetryRecord rec = TelemetryRecord();
+        rec.type = telemetryBeat;
+        rec.timeMs = nowMs - (lastSampleTick * sampleIntervalUs - e->timeUs) / 1000;
+        rec.ibiUs = e->ibiUs;
+        rec.flags = e->flags & beatEventAccepted ? telemetryBeatAccepted : 0;
+        if (telemetryAddBeat(batch, rec.timeMs, rec.ibiUs, rec.flags)) batchRecords.push_back(rec);
+      }
+      TelemetryRecord rec = TelemetryRecord();
+      if (acqTick - secondTick >= 1000 / sampleIntervalMs) {
+        secondTick = acqTick;
+        result.secondsMs.push_back(nowMs);
+        result.secondsBpm.push_back(result.finalBpm);
+        result.secondsSpectralBpm.push_back(spectralBpm());
+        result.secondsQuality.push_back(signalQualityIndex);
+        rec.type = telemetrySecond;
+        rec.timeMs = nowMs;
+        rec.bpm = (uint8_t)min(255, max(0, result.finalBpm));
+        rec.signal = (uint16_t)signalValue;
+        rec.flags = pulseDetected ? telemetrySecondDetected : 0;
+        if (telemetryAddSecond(batch, nowMs, result.finalBpm, signalValue, pulseDetected)) {
+          batchRecords.push_back(rec);
+        }
+      }
+      if (acqTick - batchTick >= replayTelemetrySeconds * 1000 / sampleIntervalMs || last) {
+        batchTick = acqTick;
+        rec.type = telemetryWave;
+        rec.timeMs = nowMs;
+        if (telemetryAddWave(batch, nowMs, waveHistory, &telemetryCursor, sampleIntervalMs)) {
+          batchRecords.push_back(rec);
+        }
+        size_t size = telemetryFinish(batch);
+        if (!replayCheckTelemetry(batch.data, size, result.telemetryFrames, batchRecords)) {
+          result.telemetryErrors++;
+        }
+        result.telemetryRecords += batch.records;
+        result.telemetryBytes += size;
+        result.telemetryFrames++;
+        batchRecords.clear();
+        batch.length = 0;
+      }
+    }
+  }
+  result.wallSeconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - wallStart).count();
+  result.samples = (uint32_t)trace.samples.size();
+  result.overruns = acqRing.overruns;
+  result.beatCount = beatCount;
+  result.beatsMissed = beats.missed;
+  timer1_detachInterrupt();
+  return result;
+}
+
+// ========================= TIMING ACCURACY =========================
+
+struct IbiError {
+  uint32_t pairs = 0;      // Consecutive detections matched to consecutive true beats
+  double meanAbsUs = 0;
+  double rmsUs = 0;
+  double maxAbsUs = 0;
+};
+
+/**
+ * The detector's (constant) filter delay: the median offset from each
+ * detection to the true beat before it
+ */
+double detectorDelayUs(const std::vector<uint32_t>& detectedUs,
+                       const std::vector<uint32_t>& truthUs) {
+  std::vector<double> offsets;
+  size_t j = 0;
+  for (uint32_t d : detectedUs) {
+    while (j + 1 < truthUs.size() && truthUs[j + 1] <= d) j++;
+    if (j < truthUs.size() && truthUs[j] <= d) offsets.push_back((double)d - truthUs[j]);
+  }
+  if (offsets.empty()) return 0;
+  std::sort(offsets.begin(), offsets.end());
+  return offsets[offsets.size() / 2];
+}
+
+/**
+ * Compare detected inter-beat intervals with the true ones. Each detection
+ * is matched to the nearest true beat after removing the detector delay;
+ * only intervals whose both ends matched consecutive true beats are scored.
+ */
+IbiError measureIbiError(const std::vector<uint32_t>& detectedUs,
+                         const std::vector<uint32_t>& truthUs) {
+  IbiError err;
+  if (detectedUs.size() < 2 || truthUs.size() < 2) return err;
+  double delay = detectorDelayUs(detectedUs, truthUs);
+
+  double sumAbs = 0, sumSq = 0;
+  long prevMatch = -1;
+  double prevDet = 0;
+  size_t j = 0;
+  for (uint32_t d : detectedUs) {
+    double t = d - delay;
+    while (j + 1 < truthUs.size() && fabs(truthUs[j + 1] - t) < fabs(truthUs[j] - t)) j++;
+    if (prevMatch >= 0 && (long)j == prevMatch + 1) {
+      double e = (t - prevDet) - ((double)truthUs[j] - truthUs[prevMatch]);
+      sumAbs += fabs(e);
+      sumSq += e * e;
+      err.maxAbsUs = max(err.maxAbsUs, fabs(e));
+      err.pairs++;
+    }
+    prevMatch = (long)j;
+    prevDet = t;
+  }
+  if (err.pairs) {
+    err.meanAbsUs = sumAbs / err.pairs;
+    err.rmsUs = sqrt(sumSq / err.pairs);
+  }
+  return err;
+}
+
+#endif // REPLAY_ENGINE_H
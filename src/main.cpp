@@ -1,8 +1,22 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WebServer.h>
+#include <coredecls.h>
+#include <sys/time.h>
+#include <time.h>
 #include "telegram_notify.h"
 #include "mqtt_publish.h"
+#include "acquisition.h"
+#include "heart_rate.h"
+#include "dashboard_html.h"
+#include "live_stream.h"
+#include "alert_rules.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "text_buffer.h"
+#include "detector_json.h"
+#include "timebase.h"
+#include "http_server.h"
+#include "wifi_connect.h"
 
 /*
  * ESP8266 Heart Rate Monitor
@@ -18,9 +32,15 @@
  * 
  * Features:
  * - Real-time heart rate detection
+ * - Timer-interrupt sampling into a lock-free ring buffer
+ * - Optional ADC oversampling with CIC decimation, sub-sample beat timing
+ * - Cooperative task scheduler with per-task timing at /tasks
+ * - Prometheus metrics and cycle-counting probes at /metrics
+ * - SNTP-disciplined UTC timestamps on samples, beats and telemetry
  * - Beautiful responsive web UI with animations
  * - Serial Monitor output
- * - WiFi connectivity for remote monitoring
+ * - WiFi connectivity for remote monitoring, joined in the background
+ *   (sampling starts before the network is up)
  */
 
 // ========================= CONFIGURATION =========================
@@ -31,424 +51,604 @@ const char* password = "gragra12345";
 // Pulse sensor configuration
 const int pulsePin = A0;           // Analog pin for pulse sensor
 const int threshold = 512;         // Threshold for beat detection
-const int sampleIntervalMs = 20;   // Sample every 20ms (50Hz)
-const int beatWindow = 10;         // Number of beats to average
 
 // ========================= GLOBAL VARIABLES =========================
-ESP8266WebServer server(80);
-
-// Heart rate calculation variables
+// Heart rate calculation variables (detector state lives in heart_rate.h)
 int heartRate = 0;
-unsigned long lastBeatTime = 0;
-unsigned long beatInterval = 0;
-int beatsPerMinute = 0;
-bool beatDetected = false;
-int signalValue = 0;
-int peakValue = 0;
-int troughValue = 1024;
-bool pulseDetected = false;
-
-// Moving average for smoother readings
-int beatIntervals[beatWindow];
-int beatIndex = 0;
-bool beatArrayFilled = false;
-
-// ========================= HEART RATE FUNCTIONS =========================
+
+// Acquisition + detection CPU cost over the last second
+uint32_t isrCyclesPerSecond = 0;
+uint32_t detectorCyclesPerSecond = 0;
+
+// Where the /events stream and the serial log are in the beat event queue
+BeatCursor liveBeats = {1, 0};
+BeatCursor serialBeats = {1, 0};
+
+// Boot timing, millis() since reset (0 = not reached yet)
+uint32_t bootSetupMs = 0;          // setup() returned
+uint32_t bootFirstSampleMs = 0;    // Detector consumed its first sample
+
+// Hot-path probes (compiled out with -D HR_PROFILE=0), served on /metrics
+PROFILE_PROBE(detectProbe, "detect");
+PROFILE_PROBE(httpClientProbe, "http_client");
+PROFILE_PROBE(dashboardProbe, "dashboard");
+PROFILE_PROBE(waveEncodeProbe, "wave_encode");
+
+// ========================= WEB UI FUNCTIONS =========================
+
+/*
+ * The dashboard lives in web/index.html. At build time tools/embed_web.py
+ * gzips it into dashboard_html.h, so serving it is a straight copy from
+ * flash: no String building, no heap, and a 304 on every reload.
+ */
+
+// Extra headers of the dashboard and its 304
+static const char dashboardHeaders[] =
+  "Content-Encoding: gzip\r\n"
+  "Cache-Control: no-cache\r\n"
+  "ETag: " DASHBOARD_ETAG "\r\n";
+
+static const char dashboardNotModified[] =
+  "Cache-Control: no-cache\r\n"
+  "ETag: " DASHBOARD_ETAG "\r\n";
+
+// ========================= SERVER HANDLERS =========================
 
 /**
- * Advanced heart rate detection using peak detection algorithm
- * This function analyzes the pulse sensor signal to detect actual heartbeats
+ * Handle root URL - serve the main web interface
+ * Revalidations with a matching ETag get a bare 304; otherwise the gzipped
+ * page is sent to the socket directly from flash.
  */
-int readHeartRate() {
-  static unsigned long lastSampleTime = 0;
-  static int lastSignalValue = 0;
-  static bool rising = false;
-  
-  unsigned long currentTime = millis();
-  
-  // Sample at regular intervals
-  if (currentTime - lastSampleTime >= sampleIntervalMs) {
-    lastSampleTime = currentTime;
-    
-    signalValue = analogRead(pulsePin);
-    
-    // Adaptive threshold based on signal range
-    if (signalValue > peakValue) peakValue = signalValue;
-    if (signalValue < troughValue) troughValue = signalValue;
-    
-    // Calculate dynamic threshold
-    int dynamicThreshold = troughValue + ((peakValue - troughValue) * 0.6);
-    
-    // Detect rising edge (beat detection)
-    if (signalValue > dynamicThreshold && lastSignalValue <= dynamicThreshold && !rising) {
-      rising = true;
-      beatDetected = true;
-      
-      // Calculate time between beats
-      if (lastBeatTime > 0) {
-        beatInterval = currentTime - lastBeatTime;
-        
-        // Valid beat interval (30-200 BPM range)
-        if (beatInterval > 300 && beatInterval < 2000) {
-          // Store in circular buffer for averaging
-          beatIntervals[beatIndex] = beatInterval;
-          beatIndex = (beatIndex + 1) % beatWindow;
-          if (beatIndex == 0) beatArrayFilled = true;
-          
-          // Calculate average BPM
-          int sum = 0;
-          int count = beatArrayFilled ? beatWindow : beatIndex;
-          for (int i = 0; i < count; i++) {
-            sum += beatIntervals[i];
-          }
-          
-          if (count > 0) {
-            int avgInterval = sum / count;
-            beatsPerMinute = 60000 / avgInterval; // Convert to BPM
-            pulseDetected = true;
-          }
-        }
-      }
-      lastBeatTime = currentTime;
-    }
-    
-    // Reset rising flag when signal falls
-    if (signalValue <= dynamicThreshold) {
-      rising = false;
-    }
-    
-    lastSignalValue = signalValue;
-    
-    // Reset peaks periodically to adapt to changes
-    static unsigned long lastResetTime = 0;
-    if (currentTime - lastResetTime > 5000) { // Reset every 5 seconds
-      peakValue = max(signalValue, 512);
-      troughValue = min(signalValue, 512);
-      lastResetTime = currentTime;
-    }
+void handleRoot(HttpConn& c) {
+  PROFILE_SCOPE(dashboardProbe);
+  if (c.ifNoneMatch && !strcmp(c.ifNoneMatch, DASHBOARD_ETAG)) {
+    httpReplyFlash(c, 304, nullptr, nullptr, 0, dashboardNotModified);
+    return;
   }
-  
-  // Return current BPM or 0 if no valid reading
-  return pulseDetected ? beatsPerMinute : 0;
+  httpReplyFlash(c, 200, "text/html", dashboardHtmlGz, dashboardHtmlGzLen, dashboardHeaders);
 }
 
-// ========================= WEB UI FUNCTIONS =========================
-
 /**
- * Generate beautiful HTML UI with real-time heart rate display
- * Features: Animated heart, live BPM updates, pulse waveform, status indicators
+ * Append a dotted-quad address (IPAddress::toString() would allocate)
  */
-String getHTML() {
-  String html = R"(
-<!DOCTYPE html>
-<html lang="en">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>❤️ Heart Rate Monitor</title>
-    <style>
-        * { margin: 0; padding: 0; box-sizing: border-box; }
-        
-        body { 
-            font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif; 
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
-            color: #333; 
-            min-height: 100vh;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-        }
-        
-        .container { 
-            background: rgba(255, 255, 255, 0.95);
-            border-radius: 20px; 
-            box-shadow: 0 20px 40px rgba(0,0,0,0.1);
-            padding: 40px;
-            max-width: 450px;
-            width: 90%;
-            text-align: center;
-            backdrop-filter: blur(10px);
-        }
-        
-        .header { margin-bottom: 30px; }
-        .title { font-size: 28px; font-weight: 700; color: #2c3e50; margin-bottom: 10px; }
-        .subtitle { color: #7f8c8d; font-size: 16px; }
-        
-        .heart-section { margin: 30px 0; }
-        .heart { 
-            font-size: 80px; 
-            animation: heartbeat 1.2s ease-in-out infinite;
-            display: inline-block;
-            filter: drop-shadow(0 4px 8px rgba(231, 76, 60, 0.3));
-        }
-        
-        @keyframes heartbeat { 
-            0%, 100% { transform: scale(1); }
-            14% { transform: scale(1.1); }
-            28% { transform: scale(1); }
-            42% { transform: scale(1.1); }
-            70% { transform: scale(1); }
-        }
-        
-        .bpm-section { margin: 30px 0; }
-        .bpm-value { 
-            font-size: 56px; 
-            font-weight: 800; 
-            color: #e74c3c; 
-            margin: 10px 0;
-            text-shadow: 0 2px 4px rgba(231, 76, 60, 0.2);
-        }
-        .bpm-label { 
-            font-size: 18px; 
-            color: #7f8c8d; 
-            font-weight: 600;
-            letter-spacing: 2px;
-        }
-        
-        .status { 
-            display: inline-block;
-            padding: 8px 16px;
-            border-radius: 20px;
-            font-size: 14px;
-            font-weight: 600;
-            margin: 15px 0;
-        }
-        .status.detecting { background: #3498db; color: white; }
-        .status.connected { background: #27ae60; color: white; }
-        .status.error { background: #e74c3c; color: white; }
-        
-        .pulse-wave { 
-            margin: 20px 0;
-            height: 60px;
-            background: #ecf0f1;
-            border-radius: 10px;
-            position: relative;
-            overflow: hidden;
-        }
-        
-        .wave-line {
-            position: absolute;
-            top: 50%;
-            left: 0;
-            right: 0;
-            height: 2px;
-            background: #e74c3c;
-            transform: translateY(-50%);
-        }
-        
-        .pulse-dot {
-            position: absolute;
-            width: 8px;
-            height: 8px;
-            background: #e74c3c;
-            border-radius: 50%;
-            top: 50%;
-            transform: translateY(-50%);
-            animation: pulse-move 2s linear infinite;
-        }
-        
-        @keyframes pulse-move {
-            0% { left: -10px; }
-            100% { left: 100%; }
-        }
-        
-        .stats { 
-            display: grid;
-            grid-template-columns: 1fr 1fr;
-            gap: 15px;
-            margin-top: 30px;
-        }
-        
-        .stat-item {
-            background: #f8f9fa;
-            padding: 15px;
-            border-radius: 10px;
-            border-left: 4px solid #e74c3c;
-        }
-        
-        .stat-value { font-size: 24px; font-weight: 700; color: #2c3e50; }
-        .stat-label { font-size: 12px; color: #7f8c8d; text-transform: uppercase; }
-        
-        .footer { 
-            margin-top: 30px; 
-            color: #bdc3c7; 
-            font-size: 14px; 
-        }
-        
-        .connection-info {
-            background: #f1f2f6;
-            padding: 10px;
-            border-radius: 8px;
-            margin-top: 20px;
-            font-size: 12px;
-            color: #57606f;
-        }
-        
-        @media (max-width: 480px) {
-            .container { padding: 20px; }
-            .heart { font-size: 60px; }
-            .bpm-value { font-size: 48px; }
-            .stats { grid-template-columns: 1fr; }
-        }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <div class="header">
-            <div class="title">❤️ Heart Rate Monitor</div>
-            <div class="subtitle">Real-time pulse monitoring</div>
-        </div>
-        
-        <div class="heart-section">
-            <div class="heart" id="heartIcon">❤️</div>
-        </div>
-        
-        <div class="bpm-section">
-            <div class="bpm-value" id="bpmValue">--</div>
-            <div class="bpm-label">BPM</div>
-        </div>
-        
-        <div class="status detecting" id="status">Detecting pulse...</div>
-        
-        <div class="pulse-wave">
-            <div class="wave-line"></div>
-            <div class="pulse-dot" id="pulseDot"></div>
-        </div>
-        
-        <div class="stats">
-            <div class="stat-item">
-                <div class="stat-value" id="signalStrength">--</div>
-                <div class="stat-label">Signal</div>
-            </div>
-            <div class="stat-item">
-                <div class="stat-value" id="lastUpdate">--</div>
-                <div class="stat-label">Updated</div>
-            </div>
-        </div>
-        
-        <div class="connection-info">
-            <div>📡 Connected to: <strong>)" + String(ssid) + R"(</strong></div>
-            <div>🌐 Device IP: <strong id="deviceIP">)" + WiFi.localIP().toString() + R"(</strong></div>
-        </div>
-        
-        <div class="footer">
-            <p>ESP8266 Heart Rate Monitor</p>
-        </div>
-    </div>
-
-    <script>
-        let lastBPM = 0;
-        let isConnected = true;
-        
-        function updateTime() {
-            const now = new Date();
-            const timeStr = now.toLocaleTimeString();
-            document.getElementById('lastUpdate').textContent = timeStr.split(' ')[0];
-        }
-        
-        function fetchData() {
-            const startTime = Date.now();
-            
-            Promise.all([
-                fetch('/bpm').then(r => r.text()),
-                fetch('/signal').then(r => r.text()),
-                fetch('/status').then(r => r.text())
-            ])
-            .then(([bpm, signal, status]) => {
-                const bpmValue = parseInt(bpm);
-                const signalValue = parseInt(signal);
-                const statusElement = document.getElementById('status');
-                // Update BPM display
-                document.getElementById('bpmValue').textContent = bpmValue > 0 ? bpmValue : '--';
-                document.getElementById('signalStrength').textContent = signalValue;
-                // Show 'Detecting pulse...' only when beat detected, else 'No beat found'
-                if (status === 'connected') {
-                    statusElement.textContent = 'Detecting pulse...';
-                    statusElement.className = 'status connected';
-                } else {
-                    statusElement.textContent = 'No beat found';
-                    statusElement.className = 'status error';
-                }
-                // Animate heart on beat change
-                if (bpmValue !== lastBPM && bpmValue > 0) {
-                    const heart = document.getElementById('heartIcon');
-                    heart.style.animation = 'none';
-                    setTimeout(() => {
-                        heart.style.animation = 'heartbeat 1.2s ease-in-out infinite';
-                    }, 10);
-                }
-                lastBPM = bpmValue;
-                isConnected = true;
-                updateTime();
-            })
-            .catch(error => {
-                console.error('Connection error:', error);
-                isConnected = false;
-                document.getElementById('status').textContent = 'Connection lost ⚠️';
-                document.getElementById('status').className = 'status error';
-            });
-        }
-        
-        // Update every second
-        setInterval(fetchData, 1000);
-        setInterval(updateTime, 1000);
-        
-        // Initial load
-        fetchData();
-        updateTime();
-    </script>
-</body>
-</html>
-  )";
-  return html;
+void textAppendIp(TextBuffer& b, const IPAddress& ip) {
+  textPrintf(b, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
 }
 
-// ========================= SERVER HANDLERS =========================
-
 /**
- * Handle root URL - serve the main web interface
+ * Handle /info endpoint - connection details shown on the dashboard
  */
-void handleRoot() {
-  server.send(200, "text/html", getHTML());
+void handleInfo(HttpConn& c) {
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "{\"ssid\":\"%s\",\"ip\":\"", ssid);
+  textAppendIp(response, WiFi.localIP());
+  textAppend(response, "\"}");
+  httpSendText(c, "application/json", response);
 }
 
 /**
  * Handle /bpm endpoint - return current heart rate
  */
-void handleBPM() {
-  server.send(200, "text/plain", String(heartRate));
+void handleBPM(HttpConn& c) {
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "%d", heartRate);
+  httpSendText(c, "text/plain", response);
 }
 
 /**
  * Handle /signal endpoint - return raw signal strength
  */
-void handleSignal() {
-  server.send(200, "text/plain", String(signalValue));
+void handleSignal(HttpConn& c) {
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "%d", signalValue);
+  httpSendText(c, "text/plain", response);
 }
 
 /**
  * Handle /status endpoint - return sensor status
  */
-void handleStatus() {
-  String status = pulseDetected ? "connected" : "detecting";
-  server.send(200, "text/plain", status);
+void handleStatus(HttpConn& c) {
+  httpReply(c, 200, "text/plain", pulseDetected ? "connected" : "detecting");
 }
 
 /**
  * Handle /data endpoint - return JSON with all data
  */
-void handleData() {
-  String json = "{";
-  json += "\"bpm\":" + String(heartRate) + ",";
-  json += "\"signal\":" + String(signalValue) + ",";
-  json += "\"detected\":" + String(pulseDetected ? "true" : "false") + ",";
-  json += "\"timestamp\":" + String(millis());
-  json += "}";
-  server.send(200, "application/json", json);
+void handleData(HttpConn& c) {
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "{\"timestamp\":%lu,\"epochMs\":", millis());
+  textAppendU64(response, timebaseNowUs() / 1000);
+  textAppend(response, ",");
+  detectorJson(response);
+  textPrintf(response, "\"clock\":{\"synced\":%s,\"offsetUs\":%d,\"driftPpb\":%d,\"syncs\":%u,\"steps\":%u},",
+             timebase.synced ? "true" : "false", (int)timebase.lastOffsetUs,
+             (int)timebaseDriftPpb(timebase), (unsigned)timebase.syncs, (unsigned)timebase.steps);
+  textPrintf(response, "\"log\":{\"pending\":%u,\"appended\":%u,\"delivered\":%u,\"dropped\":%u,"
+             "\"corrupt\":%u,\"segments\":%u,\"appendUs\":%u,\"appendUsMax\":%u,\"readUs\":%u},",
+             (unsigned)telemetryLog.pending, (unsigned)telemetryLog.appended,
+             (unsigned)telemetryLog.delivered, (unsigned)telemetryLog.dropped,
+             (unsigned)telemetryLog.corrupt, (unsigned)(telemetryLog.lastId - telemetryLog.firstId + 1),
+             (unsigned)telemetryLog.appendUsLast, (unsigned)telemetryLog.appendUsMax,
+             (unsigned)telemetryLog.readUsLast);
+  textPrintf(response, "\"telegram\":{\"queued\":%u,\"sent\":%u,\"failed\":%u,\"dropped\":%u,"
+             "\"coalesced\":%u,\"connects\":%u,\"connectMs\":%u,\"connectMsMax\":%u},",
+             (unsigned)telegramCount, (unsigned)telegramSent, (unsigned)telegramFailed,
+             (unsigned)telegramDropped, (unsigned)telegramCoalesced, (unsigned)telegramTls.handshakes,
+             (unsigned)telegramTls.handshakeMsLast, (unsigned)telegramTls.handshakeMsMax);
+  textPrintf(response, "\"alerts\":{\"bpmHigh\":%s,\"bpmLow\":%s,\"noBeat\":%s,\"signalLost\":%s},",
+             alertBpmHigh.active ? "true" : "false", alertBpmLow.active ? "true" : "false",
+             alertNoBeat.active ? "true" : "false", alertSignalLost.active ? "true" : "false");
+  textPrintf(response, "\"live\":{\"clients\":%u,\"published\":%u,\"dropped\":%u},",
+             (unsigned)liveStreamClients(), (unsigned)liveEventsPublished, (unsigned)liveEventsDropped);
+  textPrintf(response, "\"http\":{\"connections\":%d,\"requests\":%u,\"busy\":%u,\"rejected\":%u,"
+             "\"timeouts\":%u,\"pollUs\":%u,\"pollUsMax\":%u},",
+             httpConnections(), (unsigned)httpRequests, (unsigned)httpRejectedBusy,
+             (unsigned)httpRejectedBad, (unsigned)httpTimeouts, (unsigned)httpPollUsLast,
+             (unsigned)httpPollUsMax);
+  textPrintf(response, "\"mqtt\":{\"connected\":%s,\"attempts\":%u,\"failures\":%u,\"disconnects\":%u,"
+             "\"lastError\":%d,\"backoffMs\":%u,\"connectMs\":%u,\"maxConnectMs\":%u,\"uptimeS\":%u,",
+             mqttState == MQTT_LINK_UP ? "true" : "false", (unsigned)mqttConnectAttempts,
+             (unsigned)mqttConnectFailures, (unsigned)mqttDisconnects, (int)mqttLastError,
+             (unsigned)mqttBackoffMs, (unsigned)mqttLastConnectMs, (unsigned)mqttMaxConnectMs,
+             (unsigned)(mqttState == MQTT_LINK_UP ? (millis() - mqttConnectedSinceMs) / 1000 : 0));
+  textPrintf(response, "\"frames\":%u,\"stored\":%u,\"replayed\":%u,\"failed\":%u,\"bytes\":%u,"
+             "\"reports\":%u,\"suppressed\":%u,\"beatsSkipped\":%u},",
+             (unsigned)telemetryFramesPublished, (unsigned)telemetryFramesStored,
+             (unsigned)telemetryFramesReplayed, (unsigned)telemetryFramesFailed,
+             (unsigned)telemetryBytesPublished, (unsigned)mqttReportGate.reports,
+             (unsigned)mqttReportGate.suppressed, (unsigned)telemetryBeatsSkipped);
+  textPrintf(response, "\"boot\":{\"setupMs\":%u,\"firstSampleMs\":%u,\"wifiMs\":%u,\"firstPublishMs\":%u,"
+             "\"wifiConnectMs\":%u,\"wifiCached\":%s},",
+             (unsigned)bootSetupMs, (unsigned)bootFirstSampleMs, (unsigned)wifiConnectedMs,
+             (unsigned)mqttFirstPublishMs, (unsigned)wifiLastConnectMs, wifiLastFast ? "true" : "false");
+  textPrintf(response, "\"budget\":{\"isrCyclesPerSec\":%u,\"detectorCyclesPerSec\":%u,\"cpuPermille\":%u}}",
+             (unsigned)isrCyclesPerSecond, (unsigned)detectorCyclesPerSecond,
+             (unsigned)((isrCyclesPerSecond + detectorCyclesPerSecond) / (ESP.getCpuFreqMHz() * 1000)));
+  httpSendText(c, "application/json", response);
+}
+
+/**
+ * Handle /tasks endpoint - scheduler statistics per task. hist[i] counts
+ * runs shorter than edgesUs[i]; the last bucket is everything longer.
+ */
+void handleTasks(HttpConn& c) {
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "{\"idle\":%u,\"edgesUs\":[", (unsigned)schedIdlePasses);
+  for (int b = 0; b < schedHistogramBuckets - 1; b++) {
+    textPrintf(response, "%s%u", b ? "," : "", (unsigned)schedBucketEdgeUs(b));
+  }
+  textAppend(response, "],\"tasks\":[");
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    const SchedTask& t = schedTasks[i];
+    textPrintf(response,
+               "%s{\"name\":\"%s\",\"periodUs\":%u,\"priority\":%u,\"budgetUs\":%u,"
+               "\"runs\":%u,\"misses\":%u,\"overBudget\":%u,\"skipped\":%u,"
+               "\"lastUs\":%u,\"maxUs\":%u,\"totalMs\":%u,\"hist\":[",
+               i ? "," : "", t.name, (unsigned)t.periodUs, t.priority, (unsigned)t.budgetUs,
+               (unsigned)t.runs, (unsigned)t.misses, (unsigned)t.overBudget, (unsigned)t.skipped,
+               (unsigned)t.lastUs, (unsigned)t.maxUs, (unsigned)(t.totalUs / 1000));
+    for (int b = 0; b < schedHistogramBuckets; b++) {
+      textPrintf(response, "%s%u", b ? "," : "", (unsigned)t.histogram[b]);
+    }
+    textAppend(response, "]}");
+  }
+  textAppend(response, "]}");
+  httpSendText(c, "application/json", response);
+}
+
+/**
+ * Handle /metrics endpoint - counters, gauges, scheduler and probe
+ * histograms in the Prometheus text format, streamed in chunks
+ */
+void handleMetrics(HttpConn& c) {
+  httpStreamBegin(c, 200, "text/plain; version=0.0.4");
+  FixedText<512> w;
+  w.sink = httpStreamSink;
+
+  metricsFamily(w, "hr_samples_total", "counter", "Detector input samples produced");
+  textPrintf(w, "hr_samples_total %u\n", (unsigned)acqTick);
+  metricsFamily(w, "hr_adc_reads_total", "counter", "ADC reads taken by the sampling interrupt");
+  textPrintf(w, "hr_adc_reads_total %u\n", (unsigned)acqReads);
+  metricsFamily(w, "hr_ring_overruns_total", "counter", "Samples dropped because the ring was full");
+  textPrintf(w, "hr_ring_overruns_total %u\n", (unsigned)acqRing.overruns);
+  metricsFamily(w, "hr_wave_filled_samples_total", "counter", "Waveform samples filled in for dropped ones");
+  textPrintf(w, "hr_wave_filled_samples_total %u\n", (unsigned)waveHistory.filled);
+  metricsFamily(w, "hr_sampling_pauses_total", "counter", "Times sampling was stopped for flash work");
+  textPrintf(w, "hr_sampling_pauses_total %u\n", (unsigned)acqPauses);
+  metricsFamily(w, "hr_beats_total", "counter", "Inter-beat intervals by outlier check result");
+  textPrintf(w, "hr_beats_total{result=\"accepted\"} %u\n", (unsigned)beatStats.accepted);
+  textPrintf(w, "hr_beats_total{result=\"rejected\"} %u\n", (unsigned)beatStats.rejected);
+  metricsFamily(w, "hr_http_requests_total", "counter", "HTTP requests routed");
+  textPrintf(w, "hr_http_requests_total %u\n", (unsigned)httpRequests);
+  metricsFamily(w, "hr_http_rejected_total", "counter", "HTTP connections and requests turned away");
+  textPrintf(w, "hr_http_rejected_total{reason=\"busy\"} %u\n", (unsigned)httpRejectedBusy);
+  textPrintf(w, "hr_http_rejected_total{reason=\"bad_request\"} %u\n", (unsigned)httpRejectedBad);
+  textPrintf(w, "hr_http_rejected_total{reason=\"timeout\"} %u\n", (unsigned)httpTimeouts);
+  metricsFamily(w, "hr_beat_events_missed_total", "counter", "Beats overwritten before a consumer read them");
+  textPrintf(w, "hr_beat_events_missed_total{consumer=\"mqtt\"} %u\n", (unsigned)telemetryBeats.missed);
+  textPrintf(w, "hr_beat_events_missed_total{consumer=\"live\"} %u\n", (unsigned)liveBeats.missed);
+  textPrintf(w, "hr_beat_events_missed_total{consumer=\"serial\"} %u\n", (unsigned)serialBeats.missed);
+  metricsFamily(w, "hr_mqtt_frames_total", "counter", "Telemetry frames by outcome");
+  textPrintf(w, "hr_mqtt_frames_total{result=\"published\"} %u\n", (unsigned)telemetryFramesPublished);
+  textPrintf(w, "hr_mqtt_frames_total{result=\"stored\"} %u\n", (unsigned)telemetryFramesStored);
+  textPrintf(w, "hr_mqtt_frames_total{result=\"replayed\"} %u\n", (unsigned)telemetryFramesReplayed);
+  textPrintf(w, "hr_mqtt_frames_total{result=\"failed\"} %u\n", (unsigned)telemetryFramesFailed);
+  metricsFamily(w, "hr_mqtt_reports_total", "counter", "Once-a-second readings by report-by-exception decision");
+  textPrintf(w, "hr_mqtt_reports_total{result=\"sent\"} %u\n", (unsigned)mqttReportGate.reports);
+  textPrintf(w, "hr_mqtt_reports_total{result=\"suppressed\"} %u\n", (unsigned)mqttReportGate.suppressed);
+  metricsFamily(w, "hr_mqtt_connect_attempts_total", "counter", "MQTT connection attempts");
+  textPrintf(w, "hr_mqtt_connect_attempts_total %u\n", (unsigned)mqttConnectAttempts);
+  metricsFamily(w, "hr_mqtt_connect_failures_total", "counter", "MQTT connection attempts that failed");
+  textPrintf(w, "hr_mqtt_connect_failures_total %u\n", (unsigned)mqttConnectFailures);
+  const TlsTransport* const tlsPeers[] = {&mqttTls, &telegramTls};
+  metricsFamily(w, "hr_tls_handshakes_total", "counter", "TLS handshakes completed, full or resuming a session");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_handshakes_total{peer=\"%s\",mode=\"full\"} %u\n", t->name, (unsigned)(t->handshakes - t->resumed));
+    textPrintf(w, "hr_tls_handshakes_total{peer=\"%s\",mode=\"resumed\"} %u\n", t->name, (unsigned)t->resumed);
+  }
+  metricsFamily(w, "hr_tls_failures_total", "counter", "TLS connects that failed");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_failures_total{peer=\"%s\"} %u\n", t->name, (unsigned)t->failures);
+  }
+  metricsFamily(w, "hr_tls_deferred_total", "counter", "TLS connects put off for lack of heap or of a loaded root CA");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_deferred_total{peer=\"%s\"} %u\n", t->name, (unsigned)t->deferred);
+  }
+  metricsFamily(w, "hr_wifi_connects_total", "counter", "WiFi connections by how they were made");
+  textPrintf(w, "hr_wifi_connects_total{path=\"cached\"} %u\n", (unsigned)wifiFastConnects);
+  textPrintf(w, "hr_wifi_connects_total{path=\"scan\"} %u\n", (unsigned)(wifiConnects - wifiFastConnects));
+  metricsFamily(w, "hr_wifi_cache_misses_total", "counter", "Cached WiFi joins that timed out");
+  textPrintf(w, "hr_wifi_cache_misses_total %u\n", (unsigned)wifiFastMisses);
+  metricsFamily(w, "hr_wifi_disconnects_total", "counter", "WiFi link drops");
+  textPrintf(w, "hr_wifi_disconnects_total %u\n", (unsigned)wifiDisconnects);
+  metricsFamily(w, "hr_telegram_messages_total", "counter", "Telegram messages by outcome");
+  textPrintf(w, "hr_telegram_messages_total{result=\"sent\"} %u\n", (unsigned)telegramSent);
+  textPrintf(w, "hr_telegram_messages_total{result=\"failed\"} %u\n", (unsigned)telegramFailed);
+  textPrintf(w, "hr_telegram_messages_total{result=\"dropped\"} %u\n", (unsigned)telegramDropped);
+
+  metricsFamily(w, "hr_http_connections", "gauge", "Open HTTP connections");
+  textPrintf(w, "hr_http_connections %d\n", httpConnections());
+  metricsFamily(w, "hr_http_poll_seconds_max", "gauge", "Longest HTTP server poll");
+  textPrintf(w, "hr_http_poll_seconds_max %.6f\n", httpPollUsMax * 1e-6);
+  metricsFamily(w, "hr_mqtt_connected", "gauge", "1 while the MQTT session is up");
+  textPrintf(w, "hr_mqtt_connected %d\n", mqttState == MQTT_LINK_UP ? 1 : 0);
+  metricsFamily(w, "hr_heap_free_bytes", "gauge", "Free heap");
+  textPrintf(w, "hr_heap_free_bytes %u\n", (unsigned)ESP.getFreeHeap());
+  metricsFamily(w, "hr_heap_max_block_bytes", "gauge", "Largest allocatable heap block");
+  textPrintf(w, "hr_heap_max_block_bytes %u\n", (unsigned)ESP.getMaxFreeBlockSize());
+  metricsFamily(w, "hr_heap_fragmentation_percent", "gauge", "Heap fragmentation");
+  textPrintf(w, "hr_heap_fragmentation_percent %u\n", (unsigned)ESP.getHeapFragmentation());
+  metricsFamily(w, "hr_tls_handshake_seconds", "gauge", "Duration of the last TLS handshake, with TCP connect");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_handshake_seconds{peer=\"%s\"} %.3f\n", t->name, t->handshakeMsLast * 1e-3);
+  }
+  metricsFamily(w, "hr_tls_heap_peak_bytes", "gauge", "Most heap a TLS handshake has taken");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_heap_peak_bytes{peer=\"%s\"} %u\n", t->name, (unsigned)t->heapPeakMax);
+  }
+  metricsFamily(w, "hr_tls_heap_held_bytes", "gauge", "Heap held by the open TLS connection after its handshake");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_heap_held_bytes{peer=\"%s\"} %u\n", t->name, (unsigned)t->heapHeld);
+  }
+  metricsFamily(w, "hr_tls_lookup_seconds", "gauge", "Duration of the last host lookup before a TLS connect");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_lookup_seconds{peer=\"%s\"} %.3f\n", t->name, t->lookupMs * 1e-3);
+  }
+  metricsFamily(w, "hr_tls_lookup_failures_total", "counter", "Host lookups that failed or timed out");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_lookup_failures_total{peer=\"%s\"} %u\n", t->name, (unsigned)t->lookupFailures);
+  }
+  metricsFamily(w, "hr_tls_record_bytes", "gauge", "TLS receive buffer in use (negotiated max fragment length)");
+  for (const TlsTransport* t : tlsPeers) {
+    textPrintf(w, "hr_tls_record_bytes{peer=\"%s\"} %u\n", t->name, (unsigned)t->recvBuffer);
+  }
+  metricsFamily(w, "hr_bpm", "gauge", "Current heart rate");
+  textPrintf(w, "hr_bpm %d\n", beatsPerMinute);
+  metricsFamily(w, "hr_spectral_bpm", "gauge", "Dominant pulse frequency of the last window");
+  textPrintf(w, "hr_spectral_bpm %.1f\n", spectralEstimator.bpmX10 / 10.0f);
+  metricsFamily(w, "hr_spectral_confidence_ratio", "gauge", "Share of band power in the spectral peak above the noise floor");
+  textPrintf(w, "hr_spectral_confidence_ratio %.3f\n", spectralEstimator.confidence / 1000.0f);
+  metricsFamily(w, "hr_reported_bpm", "gauge", "Heart rate being reported, by estimator");
+  textPrintf(w, "hr_reported_bpm{source=\"%s\"} %d\n", hrSourceName(hrSource), fusedBpm);
+  metricsFamily(w, "hr_signal_quality", "gauge", "Quality index of the reported heart rate, 0-100");
+  textPrintf(w, "hr_signal_quality %d\n", signalQualityIndex);
+  metricsFamily(w, "hr_signal_quality_score", "gauge", "Signal quality measures, 0-1");
+  textPrintf(w, "hr_signal_quality_score{measure=\"perfusion\"} %.3f\n", signalQuality.perfusion / 1000.0f);
+  textPrintf(w, "hr_signal_quality_score{measure=\"correlation\"} %.3f\n", signalQuality.correlation / 1000.0f);
+  textPrintf(w, "hr_signal_quality_score{measure=\"clipping\"} %.3f\n", signalQuality.clipping / 1000.0f);
+  textPrintf(w, "hr_signal_quality_score{measure=\"consistency\"} %.3f\n", signalQuality.consistency / 1000.0f);
+  metricsFamily(w, "hr_boot_seconds", "gauge", "Time from reset to each boot stage, absent until reached");
+  const uint32_t bootStages[] = {bootSetupMs, bootFirstSampleMs, wifiConnectedMs, mqttFirstPublishMs};
+  const char* const bootStageNames[] = {"setup", "first_sample", "wifi", "first_publish"};
+  for (uint8_t i = 0; i < 4; i++) {
+    if (bootStages[i]) textPrintf(w, "hr_boot_seconds{stage=\"%s\"} %.3f\n", bootStageNames[i], bootStages[i] * 1e-3);
+  }
+  metricsFamily(w, "hr_wifi_connect_seconds", "gauge", "Duration of the last WiFi join");
+  textPrintf(w, "hr_wifi_connect_seconds %.3f\n", wifiLastConnectMs * 1e-3);
+  metricsFamily(w, "hr_uptime_seconds", "gauge", "Time since boot");
+  textPrintf(w, "hr_uptime_seconds %lu\n", millis() / 1000);
+  metricsFamily(w, "hr_clock_synced", "gauge", "1 once SNTP has set the timebase");
+  textPrintf(w, "hr_clock_synced %d\n", timebase.synced ? 1 : 0);
+  metricsFamily(w, "hr_clock_offset_seconds", "gauge", "UTC minus the timebase estimate at the last SNTP sync");
+  textPrintf(w, "hr_clock_offset_seconds %.6f\n", timebase.lastOffsetUs * 1e-6);
+  metricsFamily(w, "hr_clock_drift_ppm", "gauge", "Estimated crystal frequency error");
+  textPrintf(w, "hr_clock_drift_ppm %.3f\n", timebaseDriftPpb(timebase) * 1e-3);
+  metricsFamily(w, "hr_sampling_pause_seconds_max", "gauge", "Longest stop of sampling for flash work");
+  textPrintf(w, "hr_sampling_pause_seconds_max %.6f\n", acqPausedUsMax * 1e-6);
+  metricsFamily(w, "hr_isr_cycles_max", "gauge", "Worst-case sampling interrupt cost in CPU cycles");
+  textPrintf(w, "hr_isr_cycles_max %u\n", (unsigned)acqIsrCyclesMax);
+
+  metricsFamily(w, "hr_task_seconds", "histogram", "Run time of each scheduled task");
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    const SchedTask& t = schedTasks[i];
+    char labels[32];
+    snprintf(labels, sizeof(labels), "task=\"%s\"", t.name);
+    metricsHistogram(w, "hr_task_seconds", labels, t.histogram, schedHistogramBuckets,
+                     (1UL << schedHistogramShift) * 1e-6, t.totalUs * 1e-6, t.runs);
+  }
+  metricsFamily(w, "hr_task_misses_total", "counter", "Task runs that finished after their deadline");
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    textPrintf(w, "hr_task_misses_total{task=\"%s\"} %u\n", schedTasks[i].name, (unsigned)schedTasks[i].misses);
+  }
+  metricsFamily(w, "hr_task_over_budget_total", "counter", "Task runs longer than their budget");
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    textPrintf(w, "hr_task_over_budget_total{task=\"%s\"} %u\n", schedTasks[i].name,
+                  (unsigned)schedTasks[i].overBudget);
+  }
+
+  metricsProbes(w);
+  textFlush(w);
+  httpStreamEnd(c);
+}
+
+/**
+ * Handle /wave?since=<seq> endpoint - the stored samples after the cursor
+ * that fit the connection's buffer, as a delta-encoded binary frame
+ * (format in wave_history.h); the rest come with the next request
+ */
+void handleWave(HttpConn& c) {
+  PROFILE_SCOPE(waveEncodeProbe);
+  char arg[12];
+  uint32_t since = httpArg(c, "since", arg, sizeof(arg)) ? strtoul(arg, nullptr, 10) : 0;
+  uint8_t* frame = httpBodyData(c);
+  size_t size = waveEncode(waveHistory, since, sampleIntervalMs, frame, httpBodyCapacity);
+  FixedText<64> headers;
+  textAppend(headers, "Cache-Control: no-store\r\n");
+  if (timebase.synced) {
+    // UTC of the first sample; each next one is `interval` ms later
+    uint32_t firstSeq = frame[4] | (frame[5] << 8) | (frame[6] << 16) | ((uint32_t)frame[7] << 24);
+    textAppend(headers, "X-Epoch-Us: ");
+    textAppendU64(headers, tickEpochUs(firstSeq));
+    textAppend(headers, "\r\n");
+  }
+  httpSend(c, 200, "application/octet-stream", size, headers.data);
+}
+
+/**
+ * Handle /history?res=second|minute|hour&from=<t>&to=<t> endpoint - the
+ * stored heart rate at one resolution (format in bpm_history.h). Times are
+ * Unix seconds once SNTP has synced, seconds since boot before; the
+ * defaults are the whole span of the resolution up to now.
+ */
+void handleHistory(HttpConn& c) {
+  char arg[24] = "second";
+  HistoryRes res = HISTORY_SECOND;
+  if (httpArg(c, "res", arg, sizeof(arg)) && !historyParseRes(arg, &res)) {
+    httpReply(c, 400, "text/plain", "res must be second, minute or hour");
+    return;
+  }
+  // Unix time of detector second 0
+  int64_t offset = 0;
+  if (timebase.synced) {
+    offset = (int64_t)(tickEpochUs(lastSampleTick) / 1000000) - lastSampleTick / (1000 / sampleIntervalMs);
+  }
+  int64_t to = httpArg(c, "to", arg, sizeof(arg)) ? strtoll(arg, nullptr, 10) : (int64_t)bpmHistory.now + offset;
+  int64_t from = httpArg(c, "from", arg, sizeof(arg))
+                     ? strtoll(arg, nullptr, 10)
+                     : to - (int64_t)historyStep(res) * historySlots(res) + 1;
+  TextBuffer response = httpBody(c);
+  historyJson(response, bpmHistory, res, from, to, offset);
+  httpSendText(c, "application/json", response);
+}
+
+/**
+ * Handle /beats?since=<seq> endpoint - the stored beats from seq on (from
+ * the oldest without it), as rows of [seq, epochMs, ibiUs, amplitude,
+ * flags] (flags: beat_events.h). Continue with since = next; `missed`
+ * counts beats after `since` that were overwritten before this request.
+ */
+void handleBeats(HttpConn& c) {
+  const size_t rowMax = 48;      // [4294967295,1760000000000,4294967295,-32768,3],
+  const size_t tailMax = 40;     // ],"next":4294967295,"missed":4294967295}
+  char arg[12];
+  BeatCursor cursor = {beatEventOldest(beatEvents), 0};
+  if (httpArg(c, "since", arg, sizeof(arg))) cursor.next = strtoul(arg, nullptr, 10);
+  TextBuffer response = httpBody(c);
+  textPrintf(response, "{\"oldest\":%u,\"beats\":[", (unsigned)beatEventOldest(beatEvents));
+  bool first = true;
+  while (response.capacity - response.length >= rowMax + tailMax) {
+    const BeatEvent* e = beatEventNext(beatEvents, cursor);
+    if (!e) break;
+    textPrintf(response, "%s[%u,", first ? "" : ",", (unsigned)e->seq);
+    textAppendU64(response, detectorEpochUs(e->timeUs) / 1000);
+    textPrintf(response, ",%u,%d,%u]", (unsigned)e->ibiUs, e->amplitude, e->flags);
+    first = false;
+  }
+  textPrintf(response, "],\"next\":%u,\"missed\":%u}", (unsigned)cursor.next, (unsigned)cursor.missed);
+  httpSendText(c, "application/json", response);
+}
+
+/**
+ * Handle /events endpoint - hand the connection over to the SSE stream
+ */
+void handleEvents(HttpConn& c) {
+  if (!liveStreamAccept(c.client)) {
+    httpReply(c, 503, "text/plain", "Too many live streams");
+    return;
+  }
+  httpDetach(c);
+}
+
+// ========================= LIVE STREAM =========================
+
+const unsigned long liveStateIntervalMs = 250;  // Signal refresh rate for /events
+
+/**
+ * Push beats as they happen, and BPM/signal/status on change or at
+ * liveStateIntervalMs, to every /events subscriber
+ */
+void publishLiveEvents() {
+  static int lastBpmSent = -1;
+  static bool lastDetectedSent = false;
+  static unsigned long lastStateSent = 0;
+  char data[96];
+
+  while (const BeatEvent* e = beatEventNext(beatEvents, liveBeats)) {
+    FixedText<128> beat;
+    textPrintf(beat, "{\"n\":%u,\"ibi\":%.1f,\"amp\":%d,\"accepted\":%s,\"adequate\":%s,\"epochMs\":",
+               (unsigned)e->seq, e->ibiUs / 1000.0f, e->amplitude,
+               e->flags & beatEventAccepted ? "true" : "false", e->flags & beatEventQuality ? "true" : "false");
+    textAppendU64(beat, detectorEpochUs(e->timeUs) / 1000);
+    textAppend(beat, "}");
+    liveStreamPublish("beat", beat.data);
+  }
+
+  unsigned long now = millis();
+  if (heartRate != lastBpmSent || pulseDetected != lastDetectedSent ||
+      now - lastStateSent >= liveStateIntervalMs) {
+    lastBpmSent = heartRate;
+    lastDetectedSent = pulseDetected;
+    lastStateSent = now;
+    snprintf(data, sizeof(data), "{\"bpm\":%d,\"signal\":%d,\"quality\":%d,\"status\":\"%s\"}",
+             heartRate, signalValue, signalQualityIndex, pulseDetected ? "connected" : "detecting");
+    liveStreamPublish("state", data);
+  }
+
+  liveStreamPump();
+}
+
+// ========================= CLOCK =========================
+
+/**
+ * The core's SNTP client set the system clock: discipline the timebase
+ * with that reading (runs outside loop(), from the network stack)
+ */
+void onTimeSet(bool fromSntp) {
+  if (!fromSntp) return;
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  timebaseSync(timebase, timebaseMonoUs(), (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+  Serial.printf("[Clock] SNTP sync %u: offset %d us, drift %d ppb\n", (unsigned)timebase.syncs,
+                (int)timebase.lastOffsetUs, (int)timebaseDriftPpb(timebase));
+}
+
+/**
+ * SNTP poll interval; overrides the core's weak default of one hour
+ */
+uint32_t sntp_update_delay_MS_rfc_not_less_than_15000() {
+  return TIMEBASE_SYNC_MS;
+}
+
+// ========================= TASKS =========================
+
+/*
+ * loop() only calls schedulerRun(). Sampling itself stays in the timer1
+ * ISR; the tasks below drain and use what it produced. Periods are upper
+ * bounds on latency: the sample ring holds 10 s, so the detector could run
+ * far less often, but beats reach /events within one sample this way.
+ */
+
+void taskDetect() {
+  PROFILE_SCOPE(detectProbe);
+  heartRate = readHeartRate(acqRing);
+  if (!bootFirstSampleMs && acqTick) {
+    bootFirstSampleMs = millis();
+    Serial.printf("[Boot] First sample at %u ms\n", (unsigned)bootFirstSampleMs);
+  }
+}
+
+void taskHttp() {
+  PROFILE_SCOPE(httpClientProbe);
+  httpServerPoll();
+}
+
+/**
+ * Acquisition health: CPU cycles spent sampling and detecting per second
+ */
+void taskAcquisition() {
+  static uint32_t lastIsrCycles = 0;
+  static uint32_t lastDetectorCycles = 0;
+  isrCyclesPerSecond = acqIsrCyclesTotal - lastIsrCycles;
+  detectorCyclesPerSecond = detectorCyclesTotal - lastDetectorCycles;
+  lastIsrCycles = acqIsrCyclesTotal;
+  lastDetectorCycles = detectorCyclesTotal;
+  timebaseService();
+}
+
+/**
+ * Print to Serial Monitor once a second
+ */
+void taskSerialLog() {
+  // Format output for better readability
+  char buffer[50];
+  sprintf(buffer, "%3d | %4d   | %s", 
+          heartRate > 0 ? heartRate : 0, 
+          signalValue,
+          pulseDetected ? "DETECTED" : "SEARCHING");
+  Serial.println(buffer);
+  
+  // One line per beat since the last print
+  while (const BeatEvent* e = beatEventNext(beatEvents, serialBeats)) {
+    Serial.printf("    ❤️ BEAT #%u  IBI %u ms\n", (unsigned)e->seq, (unsigned)((e->ibiUs + 500) / 1000));
+  }
+}
+
+/**
+ * Register every task: name, function, period (ms), priority, budget (us)
+ */
+void schedulerSetup() {
+  schedulerAdd("detect", taskDetect, sampleIntervalMs, 0, 2000);
+  schedulerAdd("http", taskHttp, 10, 1, 5000);
+  schedulerAdd("live", publishLiveEvents, sampleIntervalMs, 1, 1000);
+  schedulerAdd("mqtt", mqttLoopAndPublish, 20, 2, 5000);
+  schedulerAdd("telegram", telegramService, 10, 2, 3000);
+  schedulerAdd("alerts", alertsCheck, alertCheckIntervalMs, 3, 500);
+  schedulerAdd("wifi", wifiService, 100, 3, 500);
+  schedulerAdd("acq", taskAcquisition, 1000, 3, 100);
+  schedulerAdd("serial", taskSerialLog, 1000, 4, 2000);
 }
 
 // ========================= MAIN PROGRAM =========================
 
+/**
+ * WiFi (re)connected: print the address; after the first connection since
+ * boot, also send it to Telegram (queued; sent from the telegram task)
+ */
+void onWifiUp() {
+  Serial.printf("\n✓ WiFi connected in %u ms (%s)\n", (unsigned)wifiLastConnectMs,
+                wifiLastFast ? "cached AP" : "scan");
+  Serial.print("IP Address: ");
+  Serial.println(WiFi.localIP());
+  Serial.print("Subnet Mask: ");
+  Serial.println(WiFi.subnetMask());
+  Serial.print("Gateway: ");
+  Serial.println(WiFi.gatewayIP());
+  if (wifiConnects > 1) return;
+
+  FixedText<TELEGRAM_MESSAGE_MAX> ipMsg;
+  textAppend(ipMsg, "ESP8266 connected! IP: ");
+  textAppendIp(ipMsg, WiFi.localIP());
+  textAppend(ipMsg, "\nLocal: http://");
+  textAppendIp(ipMsg, WiFi.localIP());
+  textAppend(ipMsg, "\nLive: https://heart-rates.onrender.com");
+  bool queued = sendTelegramNotification(ipMsg.data);
+  Serial.print("Telegram notification queued: ");
+  Serial.println(queued ? "YES" : "NO");
+  Serial.println("\nAccess the heart rate monitor at:");
+  Serial.print("http://");
+  Serial.println(WiFi.localIP());
+}
+
 void setup() {
   Serial.begin(115200);
   delay(10);
@@ -459,97 +659,61 @@ void setup() {
   // Initialize pulse sensor pin
   pinMode(pulsePin, INPUT);
   
-  // Initialize beat interval array
-  for (int i = 0; i < beatWindow; i++) {
-    beatIntervals[i] = 0;
-  }
+  // Initialize beat detector state
+  heartRateReset();
   
-  // Connect to WiFi
-  Serial.println();
+  // Sample first: the ring holds 10 s, more than the rest of setup() takes,
+  // and nothing below waits on the network
+  acquisitionBegin(pulsePin, sampleIntervalMs);
+  timebaseBegin();
+  Serial.print("✓ Sampling A0 every ");
+  Serial.print(acqReadIntervalUs);
+  Serial.print(" us from timer1, decimated to ");
+  Serial.print(sampleIntervalMs);
+  Serial.println(" ms");
+
+  // Join WiFi in the background; onWifiUp() reports the address
   Serial.print("Connecting to WiFi network: ");
   Serial.println(ssid);
-  
-  WiFi.begin(ssid, password);
-  
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
-  }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\n✓ WiFi connected successfully!");
-    Serial.print("IP Address: ");
-    Serial.println(WiFi.localIP());
-    Serial.print("Subnet Mask: ");
-    Serial.println(WiFi.subnetMask());
-    Serial.print("Gateway: ");
-    Serial.println(WiFi.gatewayIP());
-
-    // Send IP address and live link to Telegram
-    delay(2000); // Wait 2 seconds to ensure network is ready
-    String ipMsg = "ESP8266 connected! IP: " + WiFi.localIP().toString() + "\n";
-    ipMsg += "Local: http://" + WiFi.localIP().toString() + "\n";
-    ipMsg += "Live: https://heart-rates.onrender.com";
-    bool sent = sendTelegramNotification(ipMsg);
-    Serial.print("Telegram notification sent: ");
-    Serial.println(sent ? "YES" : "NO");
-
-    mqttSetup(); // Initialize MQTT after WiFi connects
-  } else {
-    Serial.println("\n✗ WiFi connection failed!");
-    Serial.println("Please check your credentials and try again.");
-  }
+  wifiOnUp = onWifiUp;
+  wifiBegin(ssid, password);
+  Serial.println(wifiState == WIFI_LINK_FAST ? "Rejoining cached access point" : "Scanning");
+
+  // Connects in the background from loop() once WiFi is up
+  mqttSetup();
+
+  // UTC timestamps: SNTP polls in the background once WiFi is up
+  settimeofday_cb(onTimeSet);
+  configTime(0, 0, "pool.ntp.org", "time.google.com");
   
   // Setup web server routes
-  server.on("/", handleRoot);
-  server.on("/bpm", handleBPM);
-  server.on("/signal", handleSignal);
-  server.on("/status", handleStatus);
-  server.on("/data", handleData);
+  httpOn("/", handleRoot);
+  httpOn("/info", handleInfo);
+  httpOn("/bpm", handleBPM);
+  httpOn("/signal", handleSignal);
+  httpOn("/status", handleStatus);
+  httpOn("/data", handleData);
+  httpOn("/events", handleEvents);
+  httpOn("/wave", handleWave);
+  httpOn("/history", handleHistory);
+  httpOn("/beats", handleBeats);
+  httpOn("/tasks", handleTasks);
+  httpOn("/metrics", handleMetrics);
   
-  // Start web server
-  server.begin();
+  // Start web server (listens on every interface, so before WiFi is up too)
+  httpServerBegin();
   Serial.println("✓ HTTP server started on port 80");
-  Serial.println("\nAccess the heart rate monitor at:");
-  Serial.print("http://");
-  Serial.println(WiFi.localIP());
+
   Serial.println("\n=== Monitoring Started ===");
   Serial.println("BPM | Signal | Status");
   Serial.println("----+--------+--------");
+
+  schedulerSetup();
+  bootSetupMs = millis();
+  Serial.printf("[Boot] setup() done in %u ms\n", (unsigned)bootSetupMs);
 }
 
 void loop() {
-  // Read heart rate from sensor
-  heartRate = readHeartRate();
-  
-  // Handle web server requests
-  server.handleClient();
-  
-  // Print to Serial Monitor (every second to avoid spam)
-  static unsigned long lastSerialPrint = 0;
-  if (millis() - lastSerialPrint >= 1000) {
-    lastSerialPrint = millis();
-    
-    // Format output for better readability
-    char buffer[50];
-    sprintf(buffer, "%3d | %4d   | %s", 
-            heartRate > 0 ? heartRate : 0, 
-            signalValue,
-            pulseDetected ? "DETECTED" : "SEARCHING");
-    Serial.println(buffer);
-    
-    // Show beat detection indicator
-    if (beatDetected) {
-      Serial.println("    ❤️ BEAT!");
-      beatDetected = false; // Reset flag
-    }
-  }
-
-  // Publish to MQTT every second
-  mqttLoopAndPublish();
-
-  // Small delay to prevent overwhelming the system
-  delay(10);
-}
\ No newline at end of file
+  // Everything runs as a scheduler task (see TASKS above)
+  schedulerRun();
+}
@@ -0,0 +1,71 @@
+"""
+Compare two detector benchmark results.
+
+Takes the JSON written by the native replay tool's --bench mode for a
+baseline and a candidate build and prints, per case, each metric with the
+change from the baseline:
+
+    .pio/build/native/program --bench base.json     # before the change
+    .pio/build/native/program --bench new.json      # after
+    python tools/bench_compare.py base.json new.json
+
+Exits with status 1 if any case lost more than --max-drop of sensitivity or
+PPV, so the comparison can gate a detector change.
+"""
+
+import argparse
+import json
+import sys
+
+# (key, column heading, format)
+METRICS = [
+    ("sensitivity", "sens", "{:.3f}"),
+    ("ppv", "ppv", "{:.3f}"),
+    ("bpmMae", "bpm err", "{:.2f}"),
+    ("ibiRmsMs", "ibi rms", "{:.2f}"),
+    ("cyclesPerSample", "cyc/smp", "{:.1f}"),
+]
+GATED = ("sensitivity", "ppv")
+
+
+def load(path):
+    with open(path) as f:
+        return {case["name"]: case for case in json.load(f)["cases"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip())
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--max-drop", type=float, default=0.005,
+                        help="largest allowed loss of sensitivity or PPV (default 0.005)")
+    args = parser.parse_args()
+
+    base = load(args.baseline)
+    new = load(args.candidate)
+
+    print("{:<12}".format("case") + "".join("{:>18}".format(m[1]) for m in METRICS))
+    regressions = []
+    for name, case in new.items():
+        cells = []
+        for key, _, fmt in METRICS:
+            value = fmt.format(case[key])
+            if name in base:
+                delta = case[key] - base[name][key]
+                value += " (" + ("+" if delta >= 0 else "") + fmt.format(delta) + ")"
+                if key in GATED and -delta > args.max_drop:
+                    regressions.append("{} {}".format(name, key))
+            cells.append("{:>18}".format(value))
+        print("{:<12}".format(name) + "".join(cells))
+
+    missing = sorted(set(base) - set(new))
+    if missing:
+        print("not in candidate: " + ", ".join(missing))
+    if regressions:
+        print("regressed: " + ", ".join(regressions))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,73 @@
+"""
+Embed the dashboard as a gzipped PROGMEM blob.
+
+Compresses web/index.html and writes include/dashboard_html.h with the
+bytes, their length and a strong ETag derived from the content. Runs as a
+PlatformIO pre-build script (see platformio.ini) and can also be run by
+hand:
+
+    python tools/embed_web.py
+
+The header is only rewritten when the page changes, so unchanged builds
+stay incremental.
+"""
+
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SOURCE = os.path.join(PROJECT_DIR, "web", "index.html")
+TARGET = os.path.join(PROJECT_DIR, "include", "dashboard_html.h")
+
+
+def render(html):
+    # mtime=0 keeps the output (and the ETag) identical across builds
+    blob = gzip.compress(html, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(blob).hexdigest()[:16]
+
+    lines = [
+        "// Generated by tools/embed_web.py from web/index.html - do not edit.",
+        "#ifndef DASHBOARD_HTML_H",
+        "#define DASHBOARD_HTML_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "// Strong validator for If-None-Match; changes whenever the page does",
+        '#define DASHBOARD_ETAG "\\"%s\\""' % etag,
+        "",
+        "#define DASHBOARD_GZ_LENGTH %d  // %d bytes uncompressed" % (len(blob), len(html)),
+        "",
+        "const size_t dashboardHtmlGzLen = DASHBOARD_GZ_LENGTH;",
+        "const uint8_t dashboardHtmlGz[] PROGMEM = {",
+    ]
+    for i in range(0, len(blob), 16):
+        chunk = blob[i:i + 16]
+        lines.append("  " + ", ".join("0x%02x" % b for b in chunk) + ",")
+    lines += [
+        "};",
+        "",
+        "#endif // DASHBOARD_HTML_H",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def main():
+    with open(SOURCE, "rb") as f:
+        header = render(f.read())
+    if os.path.exists(TARGET):
+        with open(TARGET, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    with open(TARGET, "w", encoding="utf-8", newline="\n") as f:
+        f.write(header)
+    print("embed_web: regenerated %s" % os.path.relpath(TARGET, PROJECT_DIR))
+
+
+main()